@@ -0,0 +1,334 @@
+#include "AllocationTracker.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+#ifdef _WIN32
+#define NOMINMAX // keeps std::max usable
+#include <Windows.h>
+#include <DbgHelp.h>
+#pragma comment(lib, "dbghelp.lib")
+#else
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr unsigned int MAX_TRACKED_THREADS = 128; // later threads share one set of counters
+	constexpr int MAX_STACK_DEPTH = 24;
+
+	// everything here is constant initialized, operator new can run before any constructor does
+	// a cache line each, so threads counting at once never share one
+	struct alignas(64) ThreadCounters
+	{
+		std::atomic<uint64_t> allocations;
+		std::atomic<uint64_t> frees;
+		std::atomic<uint64_t> bytes;
+	};
+
+	ThreadCounters threadCounters[MAX_TRACKED_THREADS + 1];
+	std::atomic<unsigned int> threadCount(0);
+	thread_local int threadSlot = -1;
+
+	struct CapturedStack
+	{
+		void* frames[MAX_STACK_DEPTH];
+		int depth;
+		size_t size;
+		unsigned int thread;
+	};
+
+	CapturedStack capturedStacks[MAX_CAPTURED_STACKS];
+	std::atomic<unsigned int> capturedCount(0); // keeps counting past the last slot
+	std::atomic<bool> captureEnabled(false);
+
+	unsigned int ThreadSlot()
+	{
+		if (threadSlot < 0)
+		{
+			unsigned int slot = threadCount.fetch_add(1, std::memory_order_relaxed);
+			threadSlot = (int) (slot < MAX_TRACKED_THREADS ? slot : MAX_TRACKED_THREADS);
+		}
+		return (unsigned int) threadSlot;
+	}
+
+	AllocationCounts ReadCounters(const ThreadCounters& counters)
+	{
+		return AllocationCounts{ counters.allocations.load(std::memory_order_relaxed), counters.frees.load(std::memory_order_relaxed),
+		                         counters.bytes.load(std::memory_order_relaxed) };
+	}
+}
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+
+namespace
+{
+	thread_local bool capturing = false; // the first backtrace may allocate while loading the unwinder
+
+	void CaptureStack(unsigned int thread, size_t size)
+	{
+		unsigned int index = capturedCount.fetch_add(1, std::memory_order_relaxed);
+		if (index >= MAX_CAPTURED_STACKS)
+		{
+			return;
+		}
+
+		capturing = true;
+		CapturedStack& stack = capturedStacks[index];
+#ifdef _WIN32
+		stack.depth = CaptureStackBackTrace(0, MAX_STACK_DEPTH, stack.frames, nullptr);
+#else
+		stack.depth = backtrace(stack.frames, MAX_STACK_DEPTH);
+#endif
+		stack.size = size;
+		stack.thread = thread;
+		capturing = false;
+	}
+
+	void RecordAllocation(size_t size)
+	{
+		unsigned int thread = ThreadSlot();
+		ThreadCounters& counters = threadCounters[thread];
+		counters.allocations.fetch_add(1, std::memory_order_relaxed);
+		counters.bytes.fetch_add(size, std::memory_order_relaxed);
+
+		if (captureEnabled.load(std::memory_order_relaxed) && !capturing)
+		{
+			CaptureStack(thread, size);
+		}
+	}
+
+	void RecordFree()
+	{
+		threadCounters[ThreadSlot()].frees.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void* operator new(size_t size)
+{
+	RecordAllocation(size);
+
+	while (true)
+	{
+		void* memory = malloc(size > 0 ? size : 1);
+		if (memory)
+		{
+			return memory;
+		}
+
+		std::new_handler handler = std::get_new_handler();
+		if (!handler)
+		{
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	RecordAllocation(size);
+	return malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void* memory) noexcept
+{
+	if (memory)
+	{
+		RecordFree();
+		free(memory);
+	}
+}
+
+void operator delete[](void* memory) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+	operator delete(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+	operator delete(memory);
+}
+
+#endif
+
+bool IsAllocationTrackingEnabled()
+{
+#ifdef ENABLE_ALLOCATION_TRACKING
+	return true;
+#else
+	return false;
+#endif
+}
+
+AllocationCounts GetThreadAllocationCounts()
+{
+	return ReadCounters(threadCounters[ThreadSlot()]);
+}
+
+AllocationCounts GetTotalAllocationCounts()
+{
+	AllocationCounts total{};
+	unsigned int threads = std::min(threadCount.load(std::memory_order_relaxed), MAX_TRACKED_THREADS + 1);
+	for (unsigned int thread = 0; thread < threads; thread++)
+	{
+		AllocationCounts counts = ReadCounters(threadCounters[thread]);
+		total.allocations += counts.allocations;
+		total.frees += counts.frees;
+		total.bytes += counts.bytes;
+	}
+	return total;
+}
+
+void SetAllocationStackCapture(bool enabled)
+{
+	captureEnabled = enabled;
+}
+
+void ClearCapturedAllocationStacks()
+{
+	capturedCount = 0;
+}
+
+void PrintCapturedAllocationStacks()
+{
+	unsigned int captured = capturedCount.load();
+	unsigned int stored = std::min(captured, MAX_CAPTURED_STACKS);
+
+#ifdef _WIN32
+	HANDLE process = GetCurrentProcess();
+	bool symbols = stored > 0 && SymInitialize(process, nullptr, TRUE);
+#endif
+
+	for (unsigned int i = 0; i < stored; i++)
+	{
+		const CapturedStack& stack = capturedStacks[i];
+		printf("Allocation of %zu bytes on thread %u:\n", stack.size, stack.thread);
+
+#ifdef _WIN32
+		alignas(SYMBOL_INFO) char symbolBuffer[sizeof(SYMBOL_INFO) + 256];
+		SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(symbolBuffer);
+		for (int frame = 0; frame < stack.depth; frame++)
+		{
+			symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+			symbol->MaxNameLen = 255;
+			DWORD64 displacement = 0;
+			if (symbols && SymFromAddr(process, (DWORD64) stack.frames[frame], &displacement, symbol))
+			{
+				printf("    %s+0x%llx\n", symbol->Name, (unsigned long long) displacement);
+			}
+			else
+			{
+				printf("    %p\n", stack.frames[frame]);
+			}
+		}
+#else
+		// writes straight to the descriptor, unlike backtrace_symbols it does not allocate
+		fflush(stdout);
+		backtrace_symbols_fd(stack.frames, stack.depth, STDOUT_FILENO);
+#endif
+	}
+
+	if (captured > stored)
+	{
+		printf("%u more allocations, their stacks were not kept\n", captured - stored);
+	}
+
+#ifdef _WIN32
+	if (symbols)
+	{
+		SymCleanup(process);
+	}
+#endif
+}
+
+void PrintAllocationCounts()
+{
+	unsigned int threads = std::min(threadCount.load(std::memory_order_relaxed), MAX_TRACKED_THREADS + 1);
+	for (unsigned int thread = 0; thread < threads; thread++)
+	{
+		AllocationCounts counts = ReadCounters(threadCounters[thread]);
+		if (counts.allocations > 0)
+		{
+			printf("Heap, thread %u%s: %llu allocations, %llu frees, %.1f KB allocated\n", thread, thread == MAX_TRACKED_THREADS ? " and later" : "",
+			       (unsigned long long) counts.allocations, (unsigned long long) counts.frees, counts.bytes / 1024.0);
+		}
+	}
+}
+
+ZeroAllocationScope::ZeroAllocationScope(const char* name) :
+	name(name), open(false), captureStacks(false), scopeCount(0), failedCount(0), start{}
+{
+}
+
+void ZeroAllocationScope::Begin(bool captureStacks)
+{
+	this->captureStacks = captureStacks;
+	if (captureStacks)
+	{
+		SetAllocationStackCapture(true);
+	}
+
+	open = true;
+	start = GetTotalAllocationCounts();
+}
+
+bool ZeroAllocationScope::End()
+{
+	AllocationCounts end = GetTotalAllocationCounts();
+	if (captureStacks)
+	{
+		SetAllocationStackCapture(false);
+	}
+
+	open = false;
+	scopeCount++;
+
+	uint64_t allocations = end.allocations - start.allocations;
+	if (allocations == 0)
+	{
+		return true;
+	}
+
+	failedCount++;
+	printf("%s %zu: %llu heap allocations, %llu bytes\n", name, scopeCount - 1, (unsigned long long) allocations,
+	       (unsigned long long) (end.bytes - start.bytes));
+	return false;
+}
+
+ZeroAllocationScope::~ZeroAllocationScope()
+{
+	if (open)
+	{
+		End();
+	}
+}
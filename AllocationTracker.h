@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Counts every operator new and delete per thread, to hold steady state frames to zero heap allocations.
+// The replacement operators are only compiled with ENABLE_ALLOCATION_TRACKING; without it the counts stay
+// zero and IsAllocationTrackingEnabled says so. Counting is an uncontended atomic add on the thread's own
+// counters. While stack capture is on, the first MAX_CAPTURED_STACKS allocations also record their call
+// stacks, into static storage so capturing never allocates itself. Allocations through malloc, like a
+// driver's, are not seen.
+
+static constexpr unsigned int MAX_CAPTURED_STACKS = 32;
+
+struct AllocationCounts
+{
+	uint64_t allocations;
+	uint64_t frees;
+	uint64_t bytes; // allocated, not live
+};
+
+bool IsAllocationTrackingEnabled();
+
+AllocationCounts GetThreadAllocationCounts(); // the calling thread's
+AllocationCounts GetTotalAllocationCounts();  // every thread's
+
+void SetAllocationStackCapture(bool enabled);
+void ClearCapturedAllocationStacks();
+void PrintCapturedAllocationStacks(); // with symbols where the platform can resolve them
+
+// per thread totals, for threads that allocated at all
+void PrintAllocationCounts();
+
+// Stretches of work, usually frames, that must not touch the heap on any thread. End reports what was
+// allocated since Begin and returns false if anything was; stacks are captured in between when asked.
+class ZeroAllocationScope
+{
+public:
+	explicit ZeroAllocationScope(const char* name);
+
+	void Begin(bool captureStacks);
+	bool End();
+	bool IsOpen() const { return open; }
+
+	size_t GetFailedCount() const { return failedCount; } // scopes that allocated
+
+	~ZeroAllocationScope(); // ends an open scope
+
+private:
+	const char* name;
+	bool open;
+	bool captureStacks;
+	size_t scopeCount;
+	size_t failedCount;
+	AllocationCounts start;
+};
@@ -0,0 +1,416 @@
+#include "BVH.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <cfloat>
+#include <future>
+#include <thread>
+
+#include "JobSystem.h"
+
+BVH::BVH()
+{
+}
+
+void BVH::Build(const std::vector<AABB>& objectBounds)
+{
+	Clear();
+
+	if (objectBounds.empty())
+	{
+		return;
+	}
+
+	objectBoxes = objectBounds;
+	objectIndices.resize(objectBoxes.size());
+	centroids.resize(objectBoxes.size());
+
+	for (size_t i = 0; i < objectBoxes.size(); i++)
+	{
+		objectIndices[i] = (unsigned int) i;
+		centroids[i] = (objectBoxes[i].min + objectBoxes[i].max) * 0.5f;
+	}
+
+	// each parallel level doubles the number of subtrees being built at once
+	unsigned int threads = IsJobSystemRunning() ? GetJobThreadCount() : std::max(1u, std::thread::hardware_concurrency());
+	int parallelDepth = 0;
+	while ((1u << parallelDepth) < threads)
+	{
+		parallelDepth++;
+	}
+
+	nodes.reserve(objectBoxes.size() * 2 / MAX_LEAF_OBJECTS + 1);
+	BuildRecursive(nodes, 0, (unsigned int) objectBoxes.size(), 0, parallelDepth);
+}
+
+void BVH::BuildRecursive(std::vector<Node>& out, unsigned int first, unsigned int count, int depth, int parallelDepth)
+{
+	unsigned int nodeIndex = (unsigned int) out.size();
+	out.push_back(Node{});
+
+	AABB bounds{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+	AABB centroidBounds{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+	for (unsigned int i = first; i < first + count; i++)
+	{
+		unsigned int object = objectIndices[i];
+		bounds = UnionAABB(bounds, objectBoxes[object]);
+		centroidBounds.min = glm::min(centroidBounds.min, centroids[object]);
+		centroidBounds.max = glm::max(centroidBounds.max, centroids[object]);
+	}
+
+	out[nodeIndex].bounds = bounds;
+
+	bool makeLeaf = count <= MAX_LEAF_OBJECTS || depth >= MAX_TREE_DEPTH;
+	unsigned int leftCount = makeLeaf ? 0 : PartitionSAH(first, count, centroidBounds);
+
+	if (leftCount == 0 || leftCount == count)
+	{
+		out[nodeIndex].first = first;
+		out[nodeIndex].count = count;
+		return;
+	}
+
+	unsigned int rightCount = count - leftCount;
+
+	if (parallelDepth > 0 && count >= PARALLEL_THRESHOLD)
+	{
+		// the two halves touch disjoint ranges of objectIndices, so they can be partitioned concurrently
+		std::vector<Node> leftNodes;
+		std::vector<Node> rightNodes;
+		auto buildHalf = [&](size_t half) {
+			if (half == 0)
+			{
+				BuildRecursive(leftNodes, first, leftCount, depth + 1, parallelDepth - 1);
+			}
+			else
+			{
+				BuildRecursive(rightNodes, first + leftCount, rightCount, depth + 1, parallelDepth - 1);
+			}
+		};
+
+		// with the job system an idle thread steals the other half, otherwise it gets a thread of its own
+		if (IsJobSystemRunning())
+		{
+			ParallelFor(2, [&](size_t begin, size_t end) {
+				for (size_t half = begin; half < end; half++)
+				{
+					buildHalf(half);
+				}
+			}, 1);
+		}
+		else
+		{
+			std::future<void> leftTask = std::async(std::launch::async, [&]() { buildHalf(0); });
+			buildHalf(1);
+			leftTask.get();
+		}
+
+		out[nodeIndex].left = (unsigned int) out.size();
+		AppendSubtree(out, leftNodes);
+		out[nodeIndex].right = (unsigned int) out.size();
+		AppendSubtree(out, rightNodes);
+	}
+	else
+	{
+		out[nodeIndex].left = (unsigned int) out.size();
+		BuildRecursive(out, first, leftCount, depth + 1, 0);
+		out[nodeIndex].right = (unsigned int) out.size();
+		BuildRecursive(out, first + leftCount, rightCount, depth + 1, 0);
+	}
+
+	out[nodeIndex].count = 0;
+}
+
+unsigned int BVH::PartitionSAH(unsigned int first, unsigned int count, const AABB& centroidBounds)
+{
+	struct Bin
+	{
+		AABB bounds;
+		unsigned int count;
+	};
+
+	const AABB emptyBox{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+	glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+
+	float bestCost = FLT_MAX;
+	int bestAxis = -1;
+	int bestSplit = 0;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (extent[axis] <= 0.0f)
+		{
+			continue;
+		}
+
+		Bin bins[NUM_BINS];
+		for (int b = 0; b < NUM_BINS; b++)
+		{
+			bins[b] = Bin{ emptyBox, 0 };
+		}
+
+		float scale = NUM_BINS / extent[axis];
+		for (unsigned int i = first; i < first + count; i++)
+		{
+			unsigned int object = objectIndices[i];
+			int b = std::min(NUM_BINS - 1, (int) ((centroids[object][axis] - centroidBounds.min[axis]) * scale));
+			bins[b].bounds = UnionAABB(bins[b].bounds, objectBoxes[object]);
+			bins[b].count++;
+		}
+
+		// sweep from the right to get the area and count of every right partition
+		float rightArea[NUM_BINS - 1];
+		unsigned int rightCount[NUM_BINS - 1];
+		AABB accumulated = emptyBox;
+		unsigned int accumulatedCount = 0;
+		for (int b = NUM_BINS - 1; b > 0; b--)
+		{
+			accumulated = UnionAABB(accumulated, bins[b].bounds);
+			accumulatedCount += bins[b].count;
+			rightArea[b - 1] = accumulatedCount ? SurfaceArea(accumulated) : 0.0f;
+			rightCount[b - 1] = accumulatedCount;
+		}
+
+		accumulated = emptyBox;
+		accumulatedCount = 0;
+		for (int split = 0; split < NUM_BINS - 1; split++)
+		{
+			accumulated = UnionAABB(accumulated, bins[split].bounds);
+			accumulatedCount += bins[split].count;
+
+			if (accumulatedCount == 0 || rightCount[split] == 0)
+			{
+				continue;
+			}
+
+			float cost = SurfaceArea(accumulated) * accumulatedCount + rightArea[split] * rightCount[split];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = split;
+			}
+		}
+	}
+
+	if (bestAxis < 0)
+	{
+		// every centroid is in the same spot, split down the middle so large clusters still subdivide
+		return count / 2;
+	}
+
+	float scale = NUM_BINS / extent[bestAxis];
+	float minimum = centroidBounds.min[bestAxis];
+	unsigned int* begin = objectIndices.data() + first;
+	unsigned int* middle = std::partition(begin, begin + count, [&](unsigned int object) {
+		int b = std::min(NUM_BINS - 1, (int) ((centroids[object][bestAxis] - minimum) * scale));
+		return b <= bestSplit;
+	});
+
+	return (unsigned int) (middle - begin);
+}
+
+void BVH::AppendSubtree(std::vector<Node>& out, const std::vector<Node>& subtree)
+{
+	unsigned int offset = (unsigned int) out.size();
+
+	for (const Node& node : subtree)
+	{
+		Node moved = node;
+		if (moved.count == 0)
+		{
+			moved.left += offset;
+			moved.right += offset;
+		}
+		out.push_back(moved);
+	}
+}
+
+void BVH::Refit(const std::vector<AABB>& objectBounds)
+{
+	if (objectBounds.size() != objectBoxes.size())
+	{
+		printf("BVH refit object count changed (%zu -> %zu), rebuilding\n", objectBoxes.size(), objectBounds.size());
+		Build(objectBounds);
+		return;
+	}
+
+	objectBoxes = objectBounds;
+
+	// children are always stored after their parent, so a reverse sweep is bottom up
+	for (size_t i = nodes.size(); i-- > 0; )
+	{
+		Node& node = nodes[i];
+
+		if (node.count > 0)
+		{
+			AABB bounds = objectBoxes[objectIndices[node.first]];
+			for (unsigned int j = node.first + 1; j < node.first + node.count; j++)
+			{
+				bounds = UnionAABB(bounds, objectBoxes[objectIndices[j]]);
+			}
+			node.bounds = bounds;
+		}
+		else
+		{
+			node.bounds = UnionAABB(nodes[node.left].bounds, nodes[node.right].bounds);
+		}
+	}
+}
+
+void BVH::Clear()
+{
+	nodes.clear();
+	objectIndices.clear();
+	objectBoxes.clear();
+	centroids.clear();
+}
+
+void BVH::QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& results) const
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	unsigned int stack[MAX_STACK_DEPTH];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const Node& node = nodes[stack[--stackSize]];
+
+		if (!AABBInFrustum(frustum, node.bounds))
+		{
+			continue;
+		}
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				if (AABBInFrustum(frustum, objectBoxes[objectIndices[i]]))
+				{
+					results.push_back(objectIndices[i]);
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.right;
+			stack[stackSize++] = node.left;
+		}
+	}
+}
+
+void BVH::QuerySphere(const BoundingSphere& sphere, std::vector<unsigned int>& results) const
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	unsigned int stack[MAX_STACK_DEPTH];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const Node& node = nodes[stack[--stackSize]];
+
+		if (!SphereIntersectsAABB(sphere, node.bounds))
+		{
+			continue;
+		}
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				if (SphereIntersectsAABB(sphere, objectBoxes[objectIndices[i]]))
+				{
+					results.push_back(objectIndices[i]);
+				}
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.right;
+			stack[stackSize++] = node.left;
+		}
+	}
+}
+
+int BVH::Raycast(const Ray& ray, float maxDistance, float* hitDistance) const
+{
+	if (nodes.empty())
+	{
+		return -1;
+	}
+
+	glm::vec3 inverseDirection = 1.0f / ray.direction;
+
+	int closestObject = -1;
+	float closestDistance = maxDistance;
+
+	unsigned int stack[MAX_STACK_DEPTH];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const Node& node = nodes[stack[--stackSize]];
+
+		if (!RayIntersectsAABB(ray, inverseDirection, node.bounds, closestDistance, nullptr))
+		{
+			continue;
+		}
+
+		if (node.count > 0)
+		{
+			for (unsigned int i = node.first; i < node.first + node.count; i++)
+			{
+				float distance = 0.0f;
+				if (RayIntersectsAABB(ray, inverseDirection, objectBoxes[objectIndices[i]], closestDistance, &distance))
+				{
+					closestDistance = distance;
+					closestObject = (int) objectIndices[i];
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first so the far one is more likely to be rejected by closestDistance
+		float leftDistance = FLT_MAX;
+		float rightDistance = FLT_MAX;
+		bool hitLeft = RayIntersectsAABB(ray, inverseDirection, nodes[node.left].bounds, closestDistance, &leftDistance);
+		bool hitRight = RayIntersectsAABB(ray, inverseDirection, nodes[node.right].bounds, closestDistance, &rightDistance);
+
+		if (hitLeft && hitRight)
+		{
+			bool leftFirst = leftDistance <= rightDistance;
+			stack[stackSize++] = leftFirst ? node.right : node.left;
+			stack[stackSize++] = leftFirst ? node.left : node.right;
+		}
+		else if (hitLeft)
+		{
+			stack[stackSize++] = node.left;
+		}
+		else if (hitRight)
+		{
+			stack[stackSize++] = node.right;
+		}
+	}
+
+	if (closestObject >= 0 && hitDistance)
+	{
+		*hitDistance = closestDistance;
+	}
+
+	return closestObject;
+}
+
+BVH::~BVH()
+{
+}
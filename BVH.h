@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "Bounds.h"
+
+// Bounding volume hierarchy over world space object boxes, built with binned SAH.
+// Query results are object indices into the array passed to Build.
+class BVH
+{
+public:
+	BVH();
+
+	void Build(const std::vector<AABB>& objectBounds);
+	void Refit(const std::vector<AABB>& objectBounds); // objects moved but the count is unchanged
+	void Clear();
+
+	void QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& results) const;
+	void QuerySphere(const BoundingSphere& sphere, std::vector<unsigned int>& results) const;
+
+	// nearest object box hit by the ray, -1 if nothing is hit
+	int Raycast(const Ray& ray, float maxDistance, float* hitDistance) const;
+
+	size_t GetNodeCount() const { return nodes.size(); }
+	size_t GetObjectCount() const { return objectBoxes.size(); }
+
+	~BVH();
+
+private:
+	struct Node
+	{
+		AABB bounds;
+		unsigned int left;   // child node indices, only valid when count == 0
+		unsigned int right;
+		unsigned int first;  // range in objectIndices, only valid for leaves
+		unsigned int count;
+	};
+
+	static constexpr unsigned int MAX_LEAF_OBJECTS = 4;
+	static constexpr int NUM_BINS = 16;
+	static constexpr unsigned int PARALLEL_THRESHOLD = 4096; // below this a subtree is cheaper to build inline
+	static constexpr int MAX_STACK_DEPTH = 64;
+	static constexpr int MAX_TREE_DEPTH = MAX_STACK_DEPTH - 2; // deeper subtrees become one large leaf so traversal stacks never overflow
+
+	std::vector<Node> nodes;
+	std::vector<unsigned int> objectIndices;
+	std::vector<AABB> objectBoxes;
+	std::vector<glm::vec3> centroids;
+
+	void BuildRecursive(std::vector<Node>& out, unsigned int first, unsigned int count, int depth, int parallelDepth);
+	unsigned int PartitionSAH(unsigned int first, unsigned int count, const AABB& centroidBounds);
+	static void AppendSubtree(std::vector<Node>& out, const std::vector<Node>& subtree);
+};
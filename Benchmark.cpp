@@ -0,0 +1,235 @@
+#include "Benchmark.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <random>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Bounds.h"
+#include "FrustumCuller.h"
+#include "BVH.h"
+#include "OcclusionCuller.h"
+
+void RunCullingBenchmark(size_t objectCount)
+{
+	constexpr int WARMUP_ITERATIONS = 3;
+	constexpr int ITERATIONS = 50;
+	constexpr unsigned int SEED = 1234;
+	const float WORLD_EXTENT = 500.0f;
+
+	std::mt19937 rng{ SEED };
+	std::uniform_real_distribution<float> position{ -WORLD_EXTENT, WORLD_EXTENT };
+	std::uniform_real_distribution<float> size{ 0.5f, 4.0f };
+
+	FrustumCuller culler;
+	culler.Reserve(objectCount);
+	for (size_t i = 0; i < objectCount; i++)
+	{
+		culler.AddObject(BoundingSphere{ glm::vec3(position(rng), position(rng), position(rng)), size(rng) });
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum = ExtractFrustum(projection * view);
+
+	for (int i = 0; i < WARMUP_ITERATIONS; i++)
+	{
+		culler.Cull(frustum);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < ITERATIONS; i++)
+	{
+		culler.Cull(frustum);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+	double perCullMs = totalMs / ITERATIONS;
+
+	printf("Frustum culling: %zu objects, %.3f ms per cull, %.1f M objects/s\n",
+	       objectCount, perCullMs, objectCount / (perCullMs * 1000.0));
+	printf("  visible: %zu culled: %zu\n", culler.GetVisibleCount(), culler.GetCulledCount());
+}
+
+void RunBVHBenchmark(size_t objectCount)
+{
+	constexpr int BUILD_ITERATIONS = 5;
+	constexpr int QUERY_ITERATIONS = 20;
+	constexpr int RAY_COUNT = 100000;
+	constexpr unsigned int SEED = 4321;
+	const float WORLD_EXTENT = 500.0f;
+	const float MAX_RAY_DISTANCE = 2000.0f;
+
+	std::mt19937 rng{ SEED };
+	std::uniform_real_distribution<float> position{ -WORLD_EXTENT, WORLD_EXTENT };
+	std::uniform_real_distribution<float> size{ 0.5f, 4.0f };
+	std::uniform_real_distribution<float> direction{ -1.0f, 1.0f };
+
+	std::vector<AABB> bounds(objectCount);
+	for (AABB& box : bounds)
+	{
+		glm::vec3 center{ position(rng), position(rng), position(rng) };
+		glm::vec3 halfSize{ size(rng) };
+		box = AABB{ center - halfSize, center + halfSize };
+	}
+
+	BVH bvh;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BUILD_ITERATIONS; i++)
+	{
+		bvh.Build(bounds);
+	}
+	auto end = std::chrono::steady_clock::now();
+	double buildMs = std::chrono::duration<double, std::milli>(end - start).count() / BUILD_ITERATIONS;
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BUILD_ITERATIONS; i++)
+	{
+		bvh.Refit(bounds);
+	}
+	end = std::chrono::steady_clock::now();
+	double refitMs = std::chrono::duration<double, std::milli>(end - start).count() / BUILD_ITERATIONS;
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	Frustum frustum = ExtractFrustum(projection * view);
+
+	std::vector<unsigned int> results;
+	results.reserve(objectCount);
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < QUERY_ITERATIONS; i++)
+	{
+		results.clear();
+		bvh.QueryFrustum(frustum, results);
+	}
+	end = std::chrono::steady_clock::now();
+	double frustumMs = std::chrono::duration<double, std::milli>(end - start).count() / QUERY_ITERATIONS;
+	size_t frustumHits = results.size();
+
+	std::vector<Ray> rays(RAY_COUNT);
+	for (Ray& ray : rays)
+	{
+		glm::vec3 rayDirection{ direction(rng), direction(rng), direction(rng) };
+		ray = Ray{ glm::vec3(position(rng), position(rng), position(rng)), glm::normalize(rayDirection + glm::vec3(1e-4f)) };
+	}
+
+	int rayHits = 0;
+	start = std::chrono::steady_clock::now();
+	for (const Ray& ray : rays)
+	{
+		float distance = 0.0f;
+		rayHits += bvh.Raycast(ray, MAX_RAY_DISTANCE, &distance) >= 0 ? 1 : 0;
+	}
+	end = std::chrono::steady_clock::now();
+	double rayMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+	printf("BVH: %zu objects, %zu nodes\n", objectCount, bvh.GetNodeCount());
+	printf("  build: %.2f ms refit: %.2f ms\n", buildMs, refitMs);
+	printf("  frustum query: %.3f ms (%zu visible)\n", frustumMs, frustumHits);
+	printf("  raycast: %.2f M rays/s (%d hits)\n", RAY_COUNT / (rayMs * 1000.0), rayHits);
+}
+
+void RunOcclusionBenchmark(size_t objectCount)
+{
+	constexpr int ITERATIONS = 20;
+	constexpr int WALL_COUNT = 8;
+	constexpr unsigned int SEED = 2468;
+	const float WALL_HALF_WIDTH = 6.0f;
+	const float WALL_HALF_HEIGHT = 20.0f;
+
+	// a row of walls in front of the camera with objects scattered on both sides of it
+	const float wallVertices[] = {
+		-WALL_HALF_WIDTH, -WALL_HALF_HEIGHT, 0.0f,
+		 WALL_HALF_WIDTH, -WALL_HALF_HEIGHT, 0.0f,
+		 WALL_HALF_WIDTH,  WALL_HALF_HEIGHT, 0.0f,
+		-WALL_HALF_WIDTH,  WALL_HALF_HEIGHT, 0.0f
+	};
+	const unsigned int wallIndices[] = { 0, 1, 2, 0, 2, 3 };
+	const unsigned int wallVertexLength = 3;
+
+	OcclusionCuller occlusion;
+	for (int i = 0; i < WALL_COUNT; i++)
+	{
+		float x = (i - WALL_COUNT / 2) * WALL_HALF_WIDTH * 2.0f + WALL_HALF_WIDTH;
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, -20.0f));
+		occlusion.AddOccluder(wallVertices, wallVertexLength, wallIndices, 6, model);
+	}
+
+	std::mt19937 rng{ SEED };
+	std::uniform_real_distribution<float> positionX{ -40.0f, 40.0f };
+	std::uniform_real_distribution<float> positionY{ -15.0f, 15.0f };
+	std::uniform_real_distribution<float> positionZ{ -80.0f, -5.0f };
+
+	std::vector<AABB> bounds(objectCount);
+	for (AABB& box : bounds)
+	{
+		glm::vec3 center{ positionX(rng), positionY(rng), positionZ(rng) };
+		box = AABB{ center - glm::vec3(0.5f), center + glm::vec3(0.5f) };
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 viewProjection = projection * view;
+
+	double rasterMs = 0.0;
+	double testMs = 0.0;
+	for (int i = 0; i < ITERATIONS; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		occlusion.RenderOccluders(viewProjection);
+		auto middle = std::chrono::steady_clock::now();
+		for (const AABB& box : bounds)
+		{
+			occlusion.TestAABB(box);
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		rasterMs += std::chrono::duration<double, std::milli>(middle - start).count();
+		testMs += std::chrono::duration<double, std::milli>(end - middle).count();
+	}
+
+	printf("Occlusion culling: %zu objects, %dx%d depth buffer\n", objectCount, occlusion.GetWidth(), occlusion.GetHeight());
+	printf("  occluder raster + hierarchy: %.3f ms, tests: %.3f ms\n", rasterMs / ITERATIONS, testMs / ITERATIONS);
+	printf("  culled: %.1f%% (%u of %u)\n", occlusion.GetCulledPercentage(), occlusion.GetOccludedCount(), occlusion.GetTestedCount());
+}
+
+double NearestRankPercentile(const std::vector<double>& sorted, double percentile)
+{
+	if (sorted.empty())
+	{
+		return 0.0;
+	}
+
+	size_t rank = (size_t) std::ceil(percentile / 100.0 * sorted.size());
+	return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+void PrintFrameTimes(std::vector<double> frameTimes)
+{
+	if (frameTimes.empty())
+	{
+		printf("No frames rendered\n");
+		return;
+	}
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	double total = 0.0;
+	for (double frameTime : frameTimes)
+	{
+		total += frameTime;
+	}
+	double mean = total / frameTimes.size();
+
+	printf("Frames: %zu, mean %.3f ms (%.1f fps)\n", frameTimes.size(), mean, 1000.0 / mean);
+	printf("  p50: %.3f ms p95: %.3f ms p99: %.3f ms max: %.3f ms\n",
+	       NearestRankPercentile(frameTimes, 50.0), NearestRankPercentile(frameTimes, 95.0),
+	       NearestRankPercentile(frameTimes, 99.0), frameTimes.back());
+}
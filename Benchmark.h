@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// Standalone CPU benchmarks, run with --benchmark before any window or GL context exists
+void RunCullingBenchmark(size_t objectCount);
+void RunBVHBenchmark(size_t objectCount);
+void RunOcclusionBenchmark(size_t objectCount);
+
+// Nearest rank percentile of already sorted values, 0 when there are none
+double NearestRankPercentile(const std::vector<double>& sorted, double percentile);
+
+// Prints mean, p50, p95, p99 and max of per frame times in milliseconds
+void PrintFrameTimes(std::vector<double> frameTimes);
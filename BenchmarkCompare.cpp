@@ -0,0 +1,497 @@
+#include "BenchmarkCompare.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "JSONReader.h"
+
+namespace
+{
+	constexpr int BOOTSTRAP_RESAMPLES = 2000;
+	constexpr double CONFIDENCE_LOW = 2.5;   // percentiles of the bootstrap distribution bounding the 95% interval
+	constexpr double CONFIDENCE_HIGH = 97.5;
+	constexpr double SIGNIFICANCE_LEVEL = 0.05; // Mann-Whitney level the runs must also pass
+	constexpr unsigned int BOOTSTRAP_SEED = 1; // fixed so the same files always print the same table
+
+	struct Metric
+	{
+		bool perFrame;      // one value per frame, otherwise one per run or benchmark repetition
+		bool higherIsBetter;
+		std::vector<double> values[2]; // baseline, candidate
+		std::vector<size_t> runEnds[2]; // per frame metrics: where the frames of each run end in values
+	};
+
+	enum Statistic
+	{
+		MEAN,
+		P50,
+		P95,
+		P99,
+		STATISTIC_COUNT
+	};
+
+	const char* statisticNames[STATISTIC_COUNT] = { "mean", "p50", "p95", "p99" };
+
+	bool EndsWith(const std::string& text, const char* suffix)
+	{
+		size_t length = strlen(suffix);
+		return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+	}
+
+	// times that were not measured, like the GPU time without timer queries or the first frame interval, are stored as 0
+	void AddValue(Metric& metric, const std::string& name, int side, double value)
+	{
+		if (metric.perFrame && EndsWith(name, "_ms") && value <= 0.0)
+		{
+			return;
+		}
+		metric.values[side].push_back(value);
+	}
+
+	Metric& GetMetric(std::map<std::string, Metric>& metrics, const std::string& name, bool perFrame, bool higherIsBetter)
+	{
+		auto inserted = metrics.insert(std::make_pair(name, Metric{ perFrame, higherIsBetter, {} }));
+		return inserted.first->second;
+	}
+
+	int LoadCSV(const char* fileName, int side, std::map<std::string, Metric>& metrics)
+	{
+		FILE* file = fopen(fileName, "r");
+		if (!file)
+		{
+			printf("Failed to open %s\n", fileName);
+			return 1;
+		}
+
+		std::vector<std::string> columns;
+		char line[4096];
+		while (fgets(line, sizeof(line), file))
+		{
+			line[strcspn(line, "\r\n")] = '\0';
+
+			// empty fields are kept so the later columns stay in place
+			std::vector<std::string> fields;
+			for (char* field = line;;)
+			{
+				char* separator = strchr(field, ',');
+				if (!separator)
+				{
+					fields.push_back(field);
+					break;
+				}
+				fields.push_back(std::string(field, separator));
+				field = separator + 1;
+			}
+
+			if (columns.empty())
+			{
+				columns = fields;
+				continue;
+			}
+
+			for (size_t i = 0; i < fields.size() && i < columns.size(); i++)
+			{
+				if (columns[i] != "frame" && !fields[i].empty())
+				{
+					AddValue(GetMetric(metrics, columns[i], true, false), columns[i], side, atof(fields[i].c_str()));
+				}
+			}
+		}
+
+		fclose(file);
+		return 0;
+	}
+
+	int LoadJSON(const char* fileName, int side, std::map<std::string, Metric>& metrics)
+	{
+		JSONValue root;
+		if (ReadJSONFile(fileName, root) != 0)
+		{
+			return 1;
+		}
+
+		// telemetry exports and stress reports: per frame samples
+		const JSONValue* samples = root.Find("samples");
+		for (size_t i = 0; samples && i < samples->keys.size(); i++)
+		{
+			const std::string& name = samples->keys[i];
+			Metric& metric = GetMetric(metrics, name, true, false);
+			for (const JSONValue& value : samples->elements[i].elements)
+			{
+				AddValue(metric, name, side, value.number);
+			}
+		}
+
+		// stress reports: scene load time, one value per run
+		const JSONValue* run = root.Find("run");
+		const JSONValue* generateTime = run ? run->Find("generate_ms") : nullptr;
+		if (generateTime && generateTime->type == JSONValue::NUMBER)
+		{
+			AddValue(GetMetric(metrics, "generate_ms", false, false), "generate_ms", side, generateTime->number);
+		}
+
+		// microbenchmarks: every repetition of a benchmark is one value, aggregates are recomputed here
+		const JSONValue* benchmarks = root.Find("benchmarks");
+		for (size_t i = 0; benchmarks && i < benchmarks->elements.size(); i++)
+		{
+			const JSONValue& benchmark = benchmarks->elements[i];
+			const JSONValue* name = benchmark.Find("name");
+			const JSONValue* runType = benchmark.Find("run_type");
+			if (!name || (runType && runType->string == "aggregate"))
+			{
+				continue;
+			}
+
+			const JSONValue* realTime = benchmark.Find("real_time");
+			const JSONValue* throughput = benchmark.Find("items_per_second");
+			if (realTime)
+			{
+				std::string metricName = name->string + " real_time";
+				AddValue(GetMetric(metrics, metricName, false, false), metricName, side, realTime->number);
+			}
+			if (throughput)
+			{
+				std::string metricName = name->string + " items_per_second";
+				AddValue(GetMetric(metrics, metricName, false, true), metricName, side, throughput->number);
+			}
+		}
+
+		return 0;
+	}
+
+	int LoadResults(const char* fileList, int side, std::map<std::string, Metric>& metrics, size_t& fileCount)
+	{
+		std::string files = fileList;
+		size_t start = 0;
+		while (start <= files.size())
+		{
+			size_t end = files.find(',', start);
+			std::string fileName = files.substr(start, end == std::string::npos ? std::string::npos : end - start);
+			start = end == std::string::npos ? files.size() + 1 : end + 1;
+
+			if (fileName.empty())
+			{
+				continue;
+			}
+
+			int result = EndsWith(fileName, ".csv") ? LoadCSV(fileName.c_str(), side, metrics) : LoadJSON(fileName.c_str(), side, metrics);
+			if (result != 0)
+			{
+				return 1;
+			}
+
+			// every file is one run, remember where its frames end
+			for (auto& entry : metrics)
+			{
+				Metric& metric = entry.second;
+				std::vector<size_t>& runEnds = metric.runEnds[side];
+				if (metric.perFrame && metric.values[side].size() > (runEnds.empty() ? 0 : runEnds.back()))
+				{
+					runEnds.push_back(metric.values[side].size());
+				}
+			}
+			fileCount++;
+		}
+		return 0;
+	}
+
+	// all statistics of one sample set, the values are sorted in place
+	void ComputeStatistics(std::vector<double>& values, double* statistics)
+	{
+		std::sort(values.begin(), values.end());
+
+		double total = 0.0;
+		for (double value : values)
+		{
+			total += value;
+		}
+
+		statistics[MEAN] = total / values.size();
+		statistics[P50] = NearestRankPercentile(values, 50.0);
+		statistics[P95] = NearestRankPercentile(values, 95.0);
+		statistics[P99] = NearestRankPercentile(values, 99.0);
+	}
+
+	// Frames of one run share its machine state, so they say little about the next run. Whole runs are drawn
+	// with replacement instead and their frames pooled, keeping the run to run noise in the interval.
+	void ResampleRuns(const std::vector<double>& values, const std::vector<size_t>& runEnds, std::mt19937& rng, std::vector<double>& resampled)
+	{
+		resampled.clear();
+		for (size_t i = 0; i < runEnds.size(); i++)
+		{
+			size_t run = rng() % runEnds.size();
+			size_t begin = run > 0 ? runEnds[run - 1] : 0;
+			resampled.insert(resampled.end(), values.begin() + begin, values.begin() + runEnds[run]);
+		}
+	}
+
+	// each run reduced to its statistics, the per frame samples of the rank test
+	void ComputeRunStatistics(const std::vector<double>& values, const std::vector<size_t>& runEnds, std::vector<double>* runStatistics)
+	{
+		std::vector<double> run;
+		for (size_t i = 0; i < runEnds.size(); i++)
+		{
+			run.assign(values.begin() + (i > 0 ? runEnds[i - 1] : 0), values.begin() + runEnds[i]);
+
+			double statistics[STATISTIC_COUNT];
+			ComputeStatistics(run, statistics);
+			for (int s = 0; s < STATISTIC_COUNT; s++)
+			{
+				runStatistics[s].push_back(statistics[s]);
+			}
+		}
+	}
+
+	// two sided p-value for a shift between the distributions, normal approximation with tie correction
+	double MannWhitneyPValue(const std::vector<double>& baseline, const std::vector<double>& candidate)
+	{
+		struct RankedValue
+		{
+			double value;
+			int side;
+		};
+
+		std::vector<RankedValue> combined;
+		combined.reserve(baseline.size() + candidate.size());
+		for (double value : baseline)
+		{
+			combined.push_back(RankedValue{ value, 0 });
+		}
+		for (double value : candidate)
+		{
+			combined.push_back(RankedValue{ value, 1 });
+		}
+		std::sort(combined.begin(), combined.end(), [](const RankedValue& a, const RankedValue& b) { return a.value < b.value; });
+
+		const double n0 = (double) baseline.size();
+		const double n1 = (double) candidate.size();
+		const double n = n0 + n1;
+
+		double baselineRankSum = 0.0;
+		double tieCorrection = 0.0;
+		for (size_t i = 0; i < combined.size();)
+		{
+			size_t tieEnd = i;
+			while (tieEnd < combined.size() && combined[tieEnd].value == combined[i].value)
+			{
+				tieEnd++;
+			}
+
+			// tied values share the average of their ranks, which start at 1
+			double averageRank = (i + 1 + tieEnd) * 0.5;
+			for (size_t j = i; j < tieEnd; j++)
+			{
+				if (combined[j].side == 0)
+				{
+					baselineRankSum += averageRank;
+				}
+			}
+
+			double ties = (double) (tieEnd - i);
+			tieCorrection += ties * ties * ties - ties;
+			i = tieEnd;
+		}
+
+		double u = baselineRankSum - n0 * (n0 + 1.0) * 0.5;
+		double mean = n0 * n1 * 0.5;
+		double variance = n0 * n1 / 12.0 * ((n + 1.0) - tieCorrection / (n * (n - 1.0)));
+		if (variance <= 0.0)
+		{
+			return 1.0;
+		}
+
+		double z = (std::fabs(u - mean) - 0.5) / std::sqrt(variance);
+		return std::erfc(std::max(z, 0.0) / std::sqrt(2.0));
+	}
+
+	struct Comparison
+	{
+		double baseline;
+		double candidate;
+		double change;          // relative, candidate over baseline minus one
+		double low, high;       // confidence interval of the change
+		bool hasInterval;
+	};
+}
+
+int RunBenchmarkComparison(const char* baselineFiles, const char* candidateFiles, double thresholdPercent)
+{
+	std::map<std::string, Metric> metrics;
+	size_t fileCounts[2] = { 0, 0 };
+	if (LoadResults(baselineFiles, 0, metrics, fileCounts[0]) != 0 || LoadResults(candidateFiles, 1, metrics, fileCounts[1]) != 0)
+	{
+		return 1;
+	}
+
+	const double threshold = thresholdPercent / 100.0;
+	printf("Baseline: %zu file(s), candidate: %zu file(s), regression threshold %.1f%%\n", fileCounts[0], fileCounts[1], thresholdPercent);
+	printf("%-44s %-5s %13s %13s %9s %21s %9s  %s\n", "Metric", "Stat", "Baseline", "Candidate", "Change", "95% CI", "MW p", "Result");
+
+	std::mt19937 rng(BOOTSTRAP_SEED);
+	std::vector<double> resampled;
+	size_t regressions = 0;
+	size_t improvements = 0;
+
+	for (auto& entry : metrics)
+	{
+		const std::string& name = entry.first;
+		Metric& metric = entry.second;
+		std::vector<double>& baseline = metric.values[0];
+		std::vector<double>& candidate = metric.values[1];
+
+		if (baseline.empty() && candidate.empty())
+		{
+			continue; // never measured, like GPU times without timer queries
+		}
+		if (baseline.empty() || candidate.empty())
+		{
+			printf("%-44s only in the %s\n", name.c_str(), baseline.empty() ? "candidate" : "baseline");
+			continue;
+		}
+
+		// frames are compared by their distribution, repeated runs by their median
+		const int firstStatistic = metric.perFrame ? MEAN : P50;
+		const int lastStatistic = metric.perFrame ? P99 : P50;
+
+		// frames reduce to one value of each statistic per run, runs are the samples either way
+		std::vector<double> runValues[2][STATISTIC_COUNT];
+		for (int side = 0; side < 2; side++)
+		{
+			if (metric.perFrame)
+			{
+				ComputeRunStatistics(metric.values[side], metric.runEnds[side], runValues[side]);
+			}
+			else
+			{
+				runValues[side][P50] = metric.values[side];
+			}
+		}
+		const bool canResample = runValues[0][firstStatistic].size() > 1 && runValues[1][firstStatistic].size() > 1;
+
+		double pValues[STATISTIC_COUNT] = {};
+		for (int s = firstStatistic; s <= lastStatistic; s++)
+		{
+			pValues[s] = canResample ? MannWhitneyPValue(runValues[0][s], runValues[1][s]) : 1.0;
+		}
+
+		Comparison comparisons[STATISTIC_COUNT] = {};
+		double statistics[2][STATISTIC_COUNT];
+		for (int side = 0; side < 2; side++)
+		{
+			// sorted copies, the resampling below needs the frames in their runs
+			resampled = metric.values[side];
+			ComputeStatistics(resampled, statistics[side]);
+		}
+		for (int s = firstStatistic; s <= lastStatistic; s++)
+		{
+			comparisons[s].baseline = statistics[0][s];
+			comparisons[s].candidate = statistics[1][s];
+			comparisons[s].change = statistics[0][s] != 0.0 ? statistics[1][s] / statistics[0][s] - 1.0 : 0.0;
+			comparisons[s].hasInterval = canResample && statistics[0][s] != 0.0;
+		}
+
+		if (canResample)
+		{
+			std::vector<double> changes[STATISTIC_COUNT];
+
+			// run metrics are one value per run, so each value is its own run
+			std::vector<size_t> singleValueRuns[2];
+			for (int side = 0; side < 2; side++)
+			{
+				if (!metric.perFrame)
+				{
+					for (size_t i = 1; i <= metric.values[side].size(); i++)
+					{
+						singleValueRuns[side].push_back(i);
+					}
+				}
+			}
+
+			for (int r = 0; r < BOOTSTRAP_RESAMPLES; r++)
+			{
+				double resampledStatistics[2][STATISTIC_COUNT];
+				for (int side = 0; side < 2; side++)
+				{
+					ResampleRuns(metric.values[side], metric.perFrame ? metric.runEnds[side] : singleValueRuns[side], rng, resampled);
+					ComputeStatistics(resampled, resampledStatistics[side]);
+				}
+
+				for (int s = firstStatistic; s <= lastStatistic; s++)
+				{
+					if (resampledStatistics[0][s] != 0.0)
+					{
+						changes[s].push_back(resampledStatistics[1][s] / resampledStatistics[0][s] - 1.0);
+					}
+				}
+			}
+
+			for (int s = firstStatistic; s <= lastStatistic; s++)
+			{
+				if (changes[s].empty())
+				{
+					comparisons[s].hasInterval = false;
+					continue;
+				}
+
+				std::sort(changes[s].begin(), changes[s].end());
+				comparisons[s].low = changes[s][(size_t) (CONFIDENCE_LOW / 100.0 * (changes[s].size() - 1))];
+				comparisons[s].high = changes[s][(size_t) (CONFIDENCE_HIGH / 100.0 * (changes[s].size() - 1))];
+			}
+		}
+
+		for (int s = firstStatistic; s <= lastStatistic; s++)
+		{
+			const Comparison& comparison = comparisons[s];
+
+			const char* result = "insufficient data";
+			char interval[32] = "-";
+			if (comparison.hasInterval)
+			{
+				snprintf(interval, sizeof(interval), "[%+.2f%%, %+.2f%%]", comparison.low * 100.0, comparison.high * 100.0);
+
+				// the whole interval on one side of zero and a change large enough to matter
+				bool significant = (comparison.low > 0.0 || comparison.high < 0.0) && std::fabs(comparison.change) >= threshold;
+
+				// a bootstrap over a handful of runs is overconfident, the rank test keeps it honest
+				if (pValues[s] >= SIGNIFICANCE_LEVEL)
+				{
+					significant = false;
+				}
+				bool worse = metric.higherIsBetter ? comparison.change < 0.0 : comparison.change > 0.0;
+
+				result = "no change";
+				if (significant && worse)
+				{
+					result = "REGRESSION";
+					regressions++;
+				}
+				else if (significant)
+				{
+					result = "improvement";
+					improvements++;
+				}
+			}
+
+			char pText[16] = "";
+			if (canResample)
+			{
+				snprintf(pText, sizeof(pText), "%.4f", pValues[s]);
+			}
+
+			printf("%-44s %-5s %13.6g %13.6g %+8.2f%% %21s %9s  %s\n", s == firstStatistic ? name.c_str() : "",
+			       metric.perFrame ? statisticNames[s] : "med", comparison.baseline, comparison.candidate, comparison.change * 100.0,
+			       interval, pText, result);
+		}
+	}
+
+	printf("%zu regression(s), %zu improvement(s)\n", regressions, improvements);
+	return regressions > 0 ? 1 : 0;
+}
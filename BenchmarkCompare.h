@@ -0,0 +1,8 @@
+#pragma once
+
+// Compares benchmark results of a baseline and a candidate build and prints a table of changes with
+// bootstrap confidence intervals. Each side is one result file or a comma separated list of repeated
+// runs: telemetry JSON or CSV, stress reports and microbenchmark JSON. Every file counts as one run and
+// changes are only reported once the runs themselves differ, which takes at least four runs on each side.
+// Returns 0 when nothing regressed by more than thresholdPercent with 95% confidence, 1 otherwise.
+int RunBenchmarkComparison(const char* baselineFiles, const char* candidateFiles, double thresholdPercent);
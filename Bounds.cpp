@@ -0,0 +1,222 @@
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+AABB ComputeAABB(const float* vertices, unsigned int vertexCount, unsigned int vertexLength)
+{
+	AABB box{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+
+	if (vertexCount == 0)
+	{
+		box.min = glm::vec3(0.0f);
+		box.max = glm::vec3(0.0f);
+		return box;
+	}
+
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const float* position = vertices + i * vertexLength;
+		glm::vec3 p(position[0], position[1], position[2]);
+
+		box.min = glm::min(box.min, p);
+		box.max = glm::max(box.max, p);
+	}
+
+	return box;
+}
+
+BoundingSphere ComputeBoundingSphere(const float* vertices, unsigned int vertexCount, unsigned int vertexLength, const AABB& box)
+{
+	// centered on the box, radius is the furthest vertex (tighter than the half diagonal)
+	BoundingSphere sphere{ (box.min + box.max) * 0.5f, 0.0f };
+
+	float maxDistanceSquared = 0.0f;
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const float* position = vertices + i * vertexLength;
+		glm::vec3 offset = glm::vec3(position[0], position[1], position[2]) - sphere.center;
+
+		maxDistanceSquared = glm::max(maxDistanceSquared, glm::dot(offset, offset));
+	}
+
+	sphere.radius = std::sqrt(maxDistanceSquared);
+
+	return sphere;
+}
+
+AABB TransformAABB(const AABB& box, const glm::mat4& transform)
+{
+	// Arvo's method: project the extents onto each world axis
+	glm::vec3 center = (box.min + box.max) * 0.5f;
+	glm::vec3 extents = (box.max - box.min) * 0.5f;
+
+	glm::vec3 newCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+	glm::vec3 newExtents{ 0.0f };
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		newExtents[axis] = std::fabs(transform[0][axis]) * extents.x +
+		                   std::fabs(transform[1][axis]) * extents.y +
+		                   std::fabs(transform[2][axis]) * extents.z;
+	}
+
+	return AABB{ newCenter - newExtents, newCenter + newExtents };
+}
+
+BoundingSphere TransformSphere(const BoundingSphere& sphere, const glm::mat4& transform)
+{
+	glm::vec3 center = glm::vec3(transform * glm::vec4(sphere.center, 1.0f));
+
+	// scale radius by the largest axis scale so non-uniform scaling stays conservative
+	float scaleX = glm::length(glm::vec3(transform[0]));
+	float scaleY = glm::length(glm::vec3(transform[1]));
+	float scaleZ = glm::length(glm::vec3(transform[2]));
+	float maxScale = glm::max(scaleX, glm::max(scaleY, scaleZ));
+
+	return BoundingSphere{ center, sphere.radius * maxScale };
+}
+
+Frustum ExtractFrustum(const glm::mat4& viewProjection)
+{
+	Frustum frustum;
+
+	// glm is column major: row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+	glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	frustum.planes[0] = row3 + row0; // left
+	frustum.planes[1] = row3 - row0; // right
+	frustum.planes[2] = row3 + row1; // bottom
+	frustum.planes[3] = row3 - row1; // top
+	frustum.planes[4] = row3 + row2; // near
+	frustum.planes[5] = row3 - row2; // far
+
+	// normalize so plane distances are in world units and can be compared to radii
+	for (int i = 0; i < Frustum::NUM_PLANES; i++)
+	{
+		float length = glm::length(glm::vec3(frustum.planes[i]));
+		if (length > 0.0f)
+		{
+			frustum.planes[i] /= length;
+		}
+	}
+
+	return frustum;
+}
+
+Frustum TransformFrustum(const Frustum& worldFrustum, const glm::mat4& model)
+{
+	Frustum frustum;
+	glm::mat4 transposed = glm::transpose(model);
+
+	// plane . (model * p) == (transpose(model) * plane) . p
+	for (int i = 0; i < Frustum::NUM_PLANES; i++)
+	{
+		frustum.planes[i] = transposed * worldFrustum.planes[i];
+
+		float length = glm::length(glm::vec3(frustum.planes[i]));
+		if (length > 0.0f)
+		{
+			frustum.planes[i] /= length;
+		}
+	}
+
+	return frustum;
+}
+
+bool SphereInFrustum(const Frustum& frustum, const BoundingSphere& sphere)
+{
+	for (int i = 0; i < Frustum::NUM_PLANES; i++)
+	{
+		const glm::vec4& plane = frustum.planes[i];
+		float distance = glm::dot(glm::vec3(plane), sphere.center) + plane.w;
+
+		if (distance < -sphere.radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool AABBInFrustum(const Frustum& frustum, const AABB& box)
+{
+	for (int i = 0; i < Frustum::NUM_PLANES; i++)
+	{
+		const glm::vec4& plane = frustum.planes[i];
+
+		// corner furthest along the plane normal
+		glm::vec3 positive{ plane.x >= 0.0f ? box.max.x : box.min.x,
+		                    plane.y >= 0.0f ? box.max.y : box.min.y,
+		                    plane.z >= 0.0f ? box.max.z : box.min.z };
+
+		if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool SphereIntersectsAABB(const BoundingSphere& sphere, const AABB& box)
+{
+	glm::vec3 closest = glm::clamp(sphere.center, box.min, box.max);
+	glm::vec3 offset = closest - sphere.center;
+
+	return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+}
+
+bool RayIntersectsAABB(const Ray& ray, const glm::vec3& inverseDirection, const AABB& box, float maxDistance, float* hitDistance)
+{
+	float tEnter = 0.0f;
+	float tExit = maxDistance;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		// parallel to the slab: the ray is inside it everywhere or nowhere. The general case would
+		// multiply 0 by infinity when the origin lies on a slab plane, and the NaN decides the result
+		if (std::isinf(inverseDirection[axis]))
+		{
+			if (ray.origin[axis] < box.min[axis] || ray.origin[axis] > box.max[axis])
+			{
+				return false;
+			}
+			continue;
+		}
+
+		float t0 = (box.min[axis] - ray.origin[axis]) * inverseDirection[axis];
+		float t1 = (box.max[axis] - ray.origin[axis]) * inverseDirection[axis];
+		tEnter = std::max(tEnter, std::min(t0, t1));
+		tExit = std::min(tExit, std::max(t0, t1));
+	}
+
+	if (tEnter > tExit)
+	{
+		return false;
+	}
+
+	if (hitDistance)
+	{
+		*hitDistance = tEnter;
+	}
+
+	return true;
+}
+
+AABB UnionAABB(const AABB& a, const AABB& b)
+{
+	return AABB{ glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+float SurfaceArea(const AABB& box)
+{
+	glm::vec3 size = glm::max(box.max - box.min, glm::vec3(0.0f));
+
+	return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
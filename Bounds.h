@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// axis aligned bounding box
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center;
+	float radius;
+};
+
+// planes stored as (normal.xyz, distance), normals point into the frustum
+struct Frustum
+{
+	static constexpr int NUM_PLANES = 6;
+	glm::vec4 planes[NUM_PLANES];
+};
+
+struct Ray
+{
+	glm::vec3 origin;
+	glm::vec3 direction; // unit length
+};
+
+// builds bounds from interleaved vertex data, position must be the first 3 components of each vertex
+AABB ComputeAABB(const float* vertices, unsigned int vertexCount, unsigned int vertexLength);
+BoundingSphere ComputeBoundingSphere(const float* vertices, unsigned int vertexCount, unsigned int vertexLength, const AABB& box);
+
+AABB TransformAABB(const AABB& box, const glm::mat4& transform);
+BoundingSphere TransformSphere(const BoundingSphere& sphere, const glm::mat4& transform);
+
+// extract the 6 clip planes from a combined projection * view matrix (Gribb-Hartmann)
+Frustum ExtractFrustum(const glm::mat4& viewProjection);
+
+// move world space planes into the object space of model, so object space bounds can be tested directly
+Frustum TransformFrustum(const Frustum& worldFrustum, const glm::mat4& model);
+
+bool SphereInFrustum(const Frustum& frustum, const BoundingSphere& sphere);
+bool AABBInFrustum(const Frustum& frustum, const AABB& box);
+bool SphereIntersectsAABB(const BoundingSphere& sphere, const AABB& box);
+
+// slab test, inverseDirection is 1 / ray.direction so it can be shared across many boxes; zero direction
+// components, and so infinite inverse ones, are handled
+bool RayIntersectsAABB(const Ray& ray, const glm::vec3& inverseDirection, const AABB& box, float maxDistance, float* hitDistance);
+
+AABB UnionAABB(const AABB& a, const AABB& b);
+float SurfaceArea(const AABB& box);
@@ -62,11 +62,25 @@ void Camera::mouseControl(GLfloat xChange, GLfloat yChange)
 	update();
 }
 
+void Camera::setState(const glm::vec3& newPosition, GLfloat newYaw, GLfloat newPitch)
+{
+	position = newPosition;
+	yaw = newYaw;
+	pitch = newPitch;
+
+	update();
+}
+
 glm::mat4 Camera::calculateViewMatrix()
 {
 	return glm::lookAt(position, position + front, up);
 }
 
+Frustum Camera::calculateFrustum(const glm::mat4& projection)
+{
+	return ExtractFrustum(projection * calculateViewMatrix());
+}
+
 void Camera::update()
 {
 	front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
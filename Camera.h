@@ -7,6 +7,8 @@
 
 #include <GLFW/glfw3.h>
 
+#include "Bounds.h"
+
 class Camera
 {
 public:
@@ -22,12 +24,17 @@ public:
 	const glm::vec3 getRight() const { return right; }
 	const glm::vec3 getUp() const { return up; }
 
+	GLfloat getYaw() const { return yaw; }
+	GLfloat getPitch() const { return pitch; }
+
 	GLfloat getMovementSpeed() { return movementSpeed; }
 	GLfloat getTurnSpeed() { return turnSpeed; }
 
 	void addPosition(const glm::vec3& offset) { position += offset; }
+	void setState(const glm::vec3& newPosition, GLfloat newYaw, GLfloat newPitch); // used by camera path playback
 
 	glm::mat4 calculateViewMatrix();
+	Frustum calculateFrustum(const glm::mat4& projection); // world space clip planes for the current view
 
 	~Camera();
 
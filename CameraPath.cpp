@@ -0,0 +1,193 @@
+#include "CameraPath.h"
+
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+
+namespace
+{
+	constexpr uint32_t CAMERA_PATH_VERSION = 1;
+	constexpr size_t FRAME_FLOATS = 9; // everything but the key bits
+
+	const int recordedKeys[] = { GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D, GLFW_KEY_SPACE, GLFW_KEY_LEFT_SHIFT };
+
+	void PackFrame(const CameraPathFrame& frame, float* values)
+	{
+		const float packed[FRAME_FLOATS] = { frame.time, frame.deltaTime, frame.mouseX, frame.mouseY,
+		                                     frame.position.x, frame.position.y, frame.position.z, frame.yaw, frame.pitch };
+		memcpy(values, packed, sizeof(packed));
+	}
+
+	void UnpackFrame(const float* values, CameraPathFrame& frame)
+	{
+		frame.time = values[0];
+		frame.deltaTime = values[1];
+		frame.mouseX = values[2];
+		frame.mouseY = values[3];
+		frame.position = glm::vec3(values[4], values[5], values[6]);
+		frame.yaw = values[7];
+		frame.pitch = values[8];
+	}
+}
+
+CameraPathRecorder::CameraPathRecorder()
+{
+	file = nullptr;
+	time = 0.0f;
+	frameCount = 0;
+}
+
+int CameraPathRecorder::Start(const char* fileName)
+{
+	Stop();
+
+	file = fopen(fileName, "wb");
+	if (!file)
+	{
+		printf("Failed to open %s for writing\n", fileName);
+		return 1;
+	}
+
+	fwrite("CPTH", 1, 4, file);
+	fwrite(&CAMERA_PATH_VERSION, sizeof(CAMERA_PATH_VERSION), 1, file);
+
+	time = 0.0f;
+	frameCount = 0;
+	return 0;
+}
+
+void CameraPathRecorder::RecordFrame(float deltaTime, const bool* keys, float mouseX, float mouseY, const Camera& camera)
+{
+	if (!file)
+	{
+		return;
+	}
+
+	time += deltaTime;
+
+	CameraPathFrame frame{};
+	frame.time = time;
+	frame.deltaTime = deltaTime;
+	frame.mouseX = mouseX;
+	frame.mouseY = mouseY;
+	frame.position = camera.getCameraPosition();
+	frame.yaw = camera.getYaw();
+	frame.pitch = camera.getPitch();
+
+	for (size_t i = 0; keys && i < sizeof(recordedKeys) / sizeof(recordedKeys[0]); i++)
+	{
+		if (keys[recordedKeys[i]])
+		{
+			frame.keys |= 1u << i;
+		}
+	}
+
+	float values[FRAME_FLOATS];
+	PackFrame(frame, values);
+	uint32_t keyBits = frame.keys;
+	fwrite(values, sizeof(float), FRAME_FLOATS, file);
+	fwrite(&keyBits, sizeof(keyBits), 1, file);
+
+	frameCount++;
+}
+
+void CameraPathRecorder::Stop()
+{
+	if (file)
+	{
+		fclose(file);
+		file = nullptr;
+		printf("Recorded camera path of %zu frames (%.2f s)\n", frameCount, time);
+	}
+}
+
+CameraPathRecorder::~CameraPathRecorder()
+{
+	Stop();
+}
+
+CameraPathPlayer::CameraPathPlayer()
+{
+}
+
+int CameraPathPlayer::Load(const char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
+	{
+		printf("Failed to open camera path %s\n", fileName);
+		return 1;
+	}
+
+	char magic[4] = {};
+	uint32_t version = 0;
+	if (fread(magic, 1, 4, file) != 4 || memcmp(magic, "CPTH", 4) != 0 ||
+	    fread(&version, sizeof(version), 1, file) != 1 || version != CAMERA_PATH_VERSION)
+	{
+		printf("%s is not a version %u camera path\n", fileName, CAMERA_PATH_VERSION);
+		fclose(file);
+		return 1;
+	}
+
+	frames.clear();
+
+	float values[FRAME_FLOATS];
+	uint32_t keyBits;
+	while (fread(values, sizeof(float), FRAME_FLOATS, file) == FRAME_FLOATS && fread(&keyBits, sizeof(keyBits), 1, file) == 1)
+	{
+		CameraPathFrame frame{};
+		UnpackFrame(values, frame);
+		frame.keys = keyBits;
+		frames.push_back(frame);
+	}
+
+	fclose(file);
+
+	if (frames.empty())
+	{
+		printf("Camera path %s has no frames\n", fileName);
+		return 1;
+	}
+
+	return 0;
+}
+
+size_t CameraPathPlayer::GetStepCount(float timeStep) const
+{
+	// rounded, recorded times are float sums that drift slightly from whole steps
+	return frames.empty() ? 0 : std::max<size_t>(1, (size_t) (getDuration() / timeStep + 0.5f));
+}
+
+void CameraPathPlayer::ApplyStep(size_t step, float timeStep, Camera& camera) const
+{
+	if (frames.empty())
+	{
+		return;
+	}
+
+	// recorded states are taken at the end of a frame, so step 0 ends one step in
+	float stepTime = (float) (step + 1) * timeStep;
+
+	// first recorded frame ending at or after the step
+	auto next = std::lower_bound(frames.begin(), frames.end(), stepTime,
+	                             [](const CameraPathFrame& frame, float t) { return frame.time < t; });
+
+	if (next == frames.begin() || next == frames.end())
+	{
+		const CameraPathFrame& frame = next == frames.end() ? frames.back() : frames.front();
+		camera.setState(frame.position, frame.yaw, frame.pitch);
+		return;
+	}
+
+	const CameraPathFrame& previous = *(next - 1);
+	float span = next->time - previous.time;
+	float blend = span > 0.0f ? (stepTime - previous.time) / span : 1.0f;
+
+	camera.setState(glm::mix(previous.position, next->position, blend),
+	                glm::mix(previous.yaw, next->yaw, blend),
+	                glm::mix(previous.pitch, next->pitch, blend));
+}
+
+CameraPathPlayer::~CameraPathPlayer()
+{
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+
+// One frame of a recorded camera path: the input that was applied and the camera state it produced
+struct CameraPathFrame
+{
+	float time;       // seconds since recording started, at the end of the frame
+	float deltaTime;
+	float mouseX, mouseY;
+	unsigned int keys; // one bit per movement key Camera::keyControl reads
+	glm::vec3 position;
+	float yaw, pitch;
+};
+
+// Writes a camera path frame by frame while the app is driven by the user.
+// Format: "CPTH", version, then raw CameraPathFrame fields, so floats round trip exactly.
+class CameraPathRecorder
+{
+public:
+	CameraPathRecorder();
+
+	int Start(const char* fileName);
+	void RecordFrame(float deltaTime, const bool* keys, float mouseX, float mouseY, const Camera& camera);
+	void Stop();
+
+	bool isRecording() const { return file != nullptr; }
+
+	~CameraPathRecorder();
+
+private:
+	FILE* file;
+	float time;
+	size_t frameCount;
+};
+
+// Plays a recorded path back at a fixed timestep independent of the recording's frame rate: the
+// camera state at each step is interpolated between the recorded frames around it, so every replay
+// renders exactly the same views no matter how fast the machine is.
+class CameraPathPlayer
+{
+public:
+	CameraPathPlayer();
+
+	int Load(const char* fileName);
+
+	size_t GetStepCount(float timeStep) const;
+	void ApplyStep(size_t step, float timeStep, Camera& camera) const;
+
+	float getDuration() const { return frames.empty() ? 0.0f : frames.back().time; }
+
+	~CameraPathPlayer();
+
+private:
+	std::vector<CameraPathFrame> frames;
+};
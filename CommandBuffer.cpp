@@ -0,0 +1,331 @@
+#include "CommandBuffer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include "FrameArena.h"
+#include "Profiler.h"
+
+namespace
+{
+	enum CommandType : uint32_t
+	{
+		COMMAND_DRAW_INDEXED,
+		COMMAND_DRAW_INDEXED_RANGES,
+		COMMAND_BIND_TEXTURE,
+		COMMAND_USE_PROGRAM,
+		COMMAND_UNIFORM_FLOAT,
+		COMMAND_UNIFORM_VEC3,
+		COMMAND_UNIFORM_MAT4,
+		COMMAND_CLEAR
+	};
+
+	// every command starts with this, size covers header and payload
+	struct CommandHeader
+	{
+		uint32_t type;
+		uint32_t size;
+	};
+
+	struct DrawIndexedCommand
+	{
+		GLuint vertexArray;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+	};
+
+	// followed by rangeCount counts and then rangeCount byte offsets
+	struct DrawIndexedRangesCommand
+	{
+		GLuint vertexArray;
+		GLsizei rangeCount;
+	};
+
+	struct BindTextureCommand
+	{
+		GLuint texture;
+		unsigned int unit;
+	};
+
+	template <typename Value>
+	struct UniformCommand
+	{
+		GLuint location;
+		Value value;
+	};
+
+	// the stream is only byte aligned, so payloads are copied in and out rather than cast
+	template <typename Payload>
+	Payload Read(const unsigned char* source)
+	{
+		Payload payload;
+		memcpy(&payload, source, sizeof(Payload));
+		return payload;
+	}
+}
+
+CommandBuffer::CommandBuffer() : currentBlock(0), commandCount(0), refusedCount(0), reportedCount(0)
+{
+}
+
+unsigned char* CommandBuffer::Allocate(uint32_t type, size_t payloadSize)
+{
+	size_t size = sizeof(CommandHeader) + payloadSize;
+
+	while (currentBlock < blocks.size() && blocks[currentBlock].used + size > blocks[currentBlock].data.size())
+	{
+		// a block kept from an earlier frame may be too small for an unusually large command
+		if (blocks[currentBlock].used == 0)
+		{
+			blocks[currentBlock].data.resize(std::max(BLOCK_SIZE, size));
+			break;
+		}
+		currentBlock++;
+	}
+
+	if (currentBlock == blocks.size())
+	{
+		blocks.push_back(Block{ std::vector<unsigned char>(std::max(BLOCK_SIZE, size)), 0 });
+	}
+
+	Block& block = blocks[currentBlock];
+	unsigned char* command = block.data.data() + block.used;
+	block.used += size;
+	commandCount++;
+
+	CommandHeader header{ type, (uint32_t) size };
+	memcpy(command, &header, sizeof(header));
+	return command + sizeof(header);
+}
+
+void CommandBuffer::Refuse(const char* call)
+{
+	if (reportedCount < MAX_REPORTED_REFUSALS)
+	{
+		printf("Command buffer: %s: needs the context, not recorded\n", call);
+		reportedCount++;
+	}
+
+	refusedCount++;
+}
+
+GLuint CommandBuffer::CreateVertexArray(const GLfloat* /*vertices*/, size_t /*vertexFloatCount*/, const unsigned int* /*indices*/, size_t /*indexCount*/,
+                                        const unsigned int* /*attributeSizes*/, unsigned int /*attributeCount*/)
+{
+	Refuse("CreateVertexArray");
+	return 0;
+}
+
+void CommandBuffer::SetIndices(GLuint /*vertexArray*/, const unsigned int* /*indices*/, size_t /*indexCount*/)
+{
+	Refuse("SetIndices");
+}
+
+void CommandBuffer::UpdateIndices(GLuint /*vertexArray*/, size_t /*firstIndex*/, const unsigned int* /*indices*/, size_t /*indexCount*/)
+{
+	Refuse("UpdateIndices");
+}
+
+void CommandBuffer::DrawIndexed(GLuint vertexArray, size_t firstIndex, size_t indexCount)
+{
+	DrawIndexedCommand command{ vertexArray, (uint32_t) firstIndex, (uint32_t) indexCount };
+	memcpy(Allocate(COMMAND_DRAW_INDEXED, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandBuffer::DrawIndexedRanges(GLuint vertexArray, const GLsizei* indexCounts, const void* const* byteOffsets, GLsizei rangeCount)
+{
+	if (rangeCount <= 0)
+	{
+		return;
+	}
+
+	size_t countBytes = sizeof(GLsizei) * rangeCount;
+	size_t offsetBytes = sizeof(const void*) * rangeCount;
+
+	DrawIndexedRangesCommand command{ vertexArray, rangeCount };
+	unsigned char* payload = Allocate(COMMAND_DRAW_INDEXED_RANGES, sizeof(command) + countBytes + offsetBytes);
+	memcpy(payload, &command, sizeof(command));
+	memcpy(payload + sizeof(command), indexCounts, countBytes);
+	memcpy(payload + sizeof(command) + countBytes, byteOffsets, offsetBytes);
+}
+
+void CommandBuffer::DestroyVertexArray(GLuint /*vertexArray*/)
+{
+	Refuse("DestroyVertexArray");
+}
+
+GLuint CommandBuffer::CreateTexture(int /*width*/, int /*height*/, const unsigned char* /*rgba*/)
+{
+	Refuse("CreateTexture");
+	return 0;
+}
+
+void CommandBuffer::BindTexture(GLuint texture, unsigned int unit)
+{
+	BindTextureCommand command{ texture, unit };
+	memcpy(Allocate(COMMAND_BIND_TEXTURE, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandBuffer::DestroyTexture(GLuint /*texture*/)
+{
+	Refuse("DestroyTexture");
+}
+
+GLuint CommandBuffer::CreateProgram(const char* /*vertexCode*/, const char* /*fragmentCode*/)
+{
+	Refuse("CreateProgram");
+	return 0;
+}
+
+GLuint CommandBuffer::GetUniformLocation(GLuint /*program*/, const char* /*name*/)
+{
+	Refuse("GetUniformLocation");
+	return (GLuint) -1;
+}
+
+void CommandBuffer::UseProgram(GLuint program)
+{
+	memcpy(Allocate(COMMAND_USE_PROGRAM, sizeof(program)), &program, sizeof(program));
+}
+
+void CommandBuffer::DestroyProgram(GLuint /*program*/)
+{
+	Refuse("DestroyProgram");
+}
+
+void CommandBuffer::SetUniform(GLuint location, GLfloat value)
+{
+	UniformCommand<GLfloat> command{ location, value };
+	memcpy(Allocate(COMMAND_UNIFORM_FLOAT, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandBuffer::SetUniform(GLuint location, const glm::vec3& value)
+{
+	UniformCommand<glm::vec3> command{ location, value };
+	memcpy(Allocate(COMMAND_UNIFORM_VEC3, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandBuffer::SetUniform(GLuint location, const glm::mat4& value)
+{
+	UniformCommand<glm::mat4> command{ location, value };
+	memcpy(Allocate(COMMAND_UNIFORM_MAT4, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandBuffer::Clear(const glm::vec4& color)
+{
+	memcpy(Allocate(COMMAND_CLEAR, sizeof(color)), &color, sizeof(color));
+}
+
+void CommandBuffer::Replay(RenderBackend& backend) const
+{
+	PROFILE_SCOPE("CommandBuffer::Replay");
+
+	for (const Block& block : blocks)
+	{
+		const unsigned char* command = block.data.data();
+		const unsigned char* end = command + block.used;
+
+		while (command < end)
+		{
+			CommandHeader header = Read<CommandHeader>(command);
+			const unsigned char* payload = command + sizeof(CommandHeader);
+
+			switch (header.type)
+			{
+			case COMMAND_DRAW_INDEXED:
+			{
+				DrawIndexedCommand draw = Read<DrawIndexedCommand>(payload);
+				backend.DrawIndexed(draw.vertexArray, draw.firstIndex, draw.indexCount);
+				break;
+			}
+			case COMMAND_DRAW_INDEXED_RANGES:
+			{
+				DrawIndexedRangesCommand draw = Read<DrawIndexedRangesCommand>(payload);
+				// the backend takes the ranges as arrays, so they are copied out of the stream into aligned frame scratch
+				FrameArena& arena = GetFrameArena();
+				GLsizei* rangeCounts = arena.AllocateArray<GLsizei>(draw.rangeCount);
+				const void** rangeOffsets = arena.AllocateArray<const void*>(draw.rangeCount);
+				memcpy(rangeCounts, payload + sizeof(draw), sizeof(GLsizei) * draw.rangeCount);
+				memcpy(rangeOffsets, payload + sizeof(draw) + sizeof(GLsizei) * draw.rangeCount, sizeof(const void*) * draw.rangeCount);
+				backend.DrawIndexedRanges(draw.vertexArray, rangeCounts, rangeOffsets, draw.rangeCount);
+				break;
+			}
+			case COMMAND_BIND_TEXTURE:
+			{
+				BindTextureCommand bind = Read<BindTextureCommand>(payload);
+				backend.BindTexture(bind.texture, bind.unit);
+				break;
+			}
+			case COMMAND_USE_PROGRAM:
+				backend.UseProgram(Read<GLuint>(payload));
+				break;
+			case COMMAND_UNIFORM_FLOAT:
+			{
+				UniformCommand<GLfloat> uniform = Read<UniformCommand<GLfloat>>(payload);
+				backend.SetUniform(uniform.location, uniform.value);
+				break;
+			}
+			case COMMAND_UNIFORM_VEC3:
+			{
+				UniformCommand<glm::vec3> uniform = Read<UniformCommand<glm::vec3>>(payload);
+				backend.SetUniform(uniform.location, uniform.value);
+				break;
+			}
+			case COMMAND_UNIFORM_MAT4:
+			{
+				UniformCommand<glm::mat4> uniform = Read<UniformCommand<glm::mat4>>(payload);
+				backend.SetUniform(uniform.location, uniform.value);
+				break;
+			}
+			case COMMAND_CLEAR:
+				backend.Clear(Read<glm::vec4>(payload));
+				break;
+			}
+
+			command += header.size;
+		}
+	}
+}
+
+void CommandBuffer::Reset()
+{
+	for (Block& block : blocks)
+	{
+		block.used = 0;
+	}
+	currentBlock = 0;
+	commandCount = 0;
+	refusedCount = 0;
+}
+
+void CommandBuffer::Reserve(size_t size)
+{
+	size_t reserved = 0;
+	for (const Block& block : blocks)
+	{
+		reserved += block.data.size();
+	}
+
+	// one block for all that is missing, like the frame arena
+	if (reserved < size)
+	{
+		blocks.push_back(Block{ std::vector<unsigned char>(std::max(BLOCK_SIZE, size - reserved)), 0 });
+	}
+}
+
+size_t CommandBuffer::GetMaxCommandSize()
+{
+	size_t payloadSize = std::max({ sizeof(DrawIndexedCommand), sizeof(BindTextureCommand), sizeof(GLuint), sizeof(UniformCommand<GLfloat>),
+	                                sizeof(UniformCommand<glm::vec3>), sizeof(UniformCommand<glm::mat4>), sizeof(glm::vec4) });
+	return sizeof(CommandHeader) + payloadSize;
+}
+
+size_t CommandBuffer::GetRangesCommandSize(size_t rangeCount)
+{
+	return sizeof(CommandHeader) + sizeof(DrawIndexedRangesCommand) + (sizeof(GLsizei) + sizeof(const void*)) * rangeCount;
+}
+
+CommandBuffer::~CommandBuffer()
+{
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "RenderBackend.h"
+
+// RenderBackend that records draw, bind, uniform and clear calls into a compact byte stream instead of
+// executing them, so threads without the GL context can prepare draws; Replay issues them in order on
+// the backend that owns the context. Installed with SetThreadRenderBackend, the engine classes record
+// through it unchanged. Calls that create, upload or destroy resources need the context right away and
+// are refused. The stream lives in blocks that Reset keeps, so recording a frame like the previous one
+// allocates nothing.
+class CommandBuffer : public RenderBackend
+{
+public:
+	CommandBuffer();
+
+	GLuint CreateVertexArray(const GLfloat* vertices, size_t vertexFloatCount, const unsigned int* indices, size_t indexCount,
+	                         const unsigned int* attributeSizes, unsigned int attributeCount) override;
+	void SetIndices(GLuint vertexArray, const unsigned int* indices, size_t indexCount) override;
+	void UpdateIndices(GLuint vertexArray, size_t firstIndex, const unsigned int* indices, size_t indexCount) override;
+	void DrawIndexed(GLuint vertexArray, size_t firstIndex, size_t indexCount) override;
+	void DrawIndexedRanges(GLuint vertexArray, const GLsizei* indexCounts, const void* const* byteOffsets, GLsizei rangeCount) override;
+	void DestroyVertexArray(GLuint vertexArray) override;
+
+	GLuint CreateTexture(int width, int height, const unsigned char* rgba) override;
+	void BindTexture(GLuint texture, unsigned int unit) override;
+	void DestroyTexture(GLuint texture) override;
+
+	GLuint CreateProgram(const char* vertexCode, const char* fragmentCode) override;
+	GLuint GetUniformLocation(GLuint program, const char* name) override;
+	void UseProgram(GLuint program) override;
+	void DestroyProgram(GLuint program) override;
+
+	void SetUniform(GLuint location, GLfloat value) override;
+	void SetUniform(GLuint location, const glm::vec3& value) override;
+	void SetUniform(GLuint location, const glm::mat4& value) override;
+
+	void Clear(const glm::vec4& color) override;
+
+	void Replay(RenderBackend& backend) const;
+	void Reset(); // drops the commands, keeps the memory
+	void Reserve(size_t size); // keeps blocks for at least size bytes of commands
+
+	// stream bytes of the largest command but DrawIndexedRanges, and of DrawIndexedRanges with rangeCount ranges
+	static size_t GetMaxCommandSize();
+	static size_t GetRangesCommandSize(size_t rangeCount);
+
+	size_t GetCommandCount() const { return commandCount; }
+	size_t GetRefusedCount() const { return refusedCount; }
+
+	~CommandBuffer();
+
+private:
+	static constexpr size_t BLOCK_SIZE = 64 * 1024;
+	static constexpr size_t MAX_REPORTED_REFUSALS = 16; // later refusals are only counted, Reset keeps the tally
+
+	struct Block
+	{
+		std::vector<unsigned char> data;
+		size_t used;
+	};
+
+	std::vector<Block> blocks;
+	size_t currentBlock;
+	size_t commandCount;
+	size_t refusedCount;
+	size_t reportedCount;
+
+	// room for one command with payloadSize bytes after its header, never split across blocks
+	unsigned char* Allocate(uint32_t type, size_t payloadSize);
+	void Refuse(const char* call);
+};
@@ -0,0 +1,201 @@
+#include "FrameArena.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace
+{
+	struct ThreadArenas
+	{
+		FrameArena arenas[FRAME_ARENA_BUFFERS];
+		uint64_t frame;
+		unsigned int thread; // order of first use
+		size_t frames;       // frames this thread allocated in
+		size_t totalUsed;    // bytes over those frames
+		size_t maxUsed;
+	};
+
+	std::atomic<uint64_t> currentFrame(0);
+	size_t reservedSize = FrameArena::BLOCK_SIZE; // per arena, guarded by registryMutex
+
+	// owns every thread's arenas, so they outlive threads that exit before the stats are printed
+	std::mutex registryMutex;
+	std::vector<std::unique_ptr<ThreadArenas>> registry;
+
+	thread_local ThreadArenas* threadArenas = nullptr;
+
+	void FinishFrame(ThreadArenas& arenas, FrameArena& arena)
+	{
+		if (arena.GetUsed() > 0)
+		{
+			arenas.frames++;
+			arenas.totalUsed += arena.GetUsed();
+			arenas.maxUsed = std::max(arenas.maxUsed, arena.GetUsed());
+		}
+	}
+}
+
+FrameArena::FrameArena() : currentBlock(0), used(0), peak(0), blockAllocations(0)
+{
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	while (true)
+	{
+		if (currentBlock == blocks.size())
+		{
+			// at least big enough for this allocation at any alignment
+			blocks.push_back(Block{ std::vector<unsigned char>(std::max(BLOCK_SIZE, size + alignment)), 0 });
+			blockAllocations++;
+		}
+
+		Block& block = blocks[currentBlock];
+		uintptr_t base = reinterpret_cast<uintptr_t>(block.data.data());
+		uintptr_t start = (base + block.used + alignment - 1) & ~(uintptr_t) (alignment - 1);
+
+		if (start + size <= base + block.data.size())
+		{
+			size_t newUsed = (size_t) (start + size - base);
+			used += newUsed - block.used;
+			block.used = newUsed;
+			return reinterpret_cast<void*>(start);
+		}
+
+		// a kept block too small for a large allocation is skipped, not resized, it still serves smaller frames
+		currentBlock++;
+	}
+}
+
+void FrameArena::Reset()
+{
+	peak = std::max(peak, used);
+
+	for (Block& block : blocks)
+	{
+#ifdef FRAME_ARENA_DEBUG
+		memset(block.data.data(), POISON, block.used);
+#endif
+		block.used = 0;
+	}
+	currentBlock = 0;
+	used = 0;
+}
+
+void FrameArena::Reserve(size_t size)
+{
+	// one block for all that is missing, fewer block ends go unused than with many small ones
+	size_t reserved = GetReserved();
+	if (reserved < size)
+	{
+		blocks.push_back(Block{ std::vector<unsigned char>(std::max(BLOCK_SIZE, size - reserved)), 0 });
+		blockAllocations++;
+	}
+}
+
+size_t FrameArena::GetReserved() const
+{
+	size_t reserved = 0;
+	for (const Block& block : blocks)
+	{
+		reserved += block.data.size();
+	}
+	return reserved;
+}
+
+FrameArena::~FrameArena()
+{
+}
+
+void FrameArenaNextFrame()
+{
+	currentFrame.fetch_add(1, std::memory_order_release);
+}
+
+FrameArena& GetFrameArena()
+{
+	if (!threadArenas)
+	{
+		std::unique_ptr<ThreadArenas> arenas(new ThreadArenas());
+
+		arenas->frame = currentFrame.load(std::memory_order_acquire);
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+
+		// every arena is filled now, a thread's first use of a later frame's arena is no time to allocate
+		for (FrameArena& arena : arenas->arenas)
+		{
+			arena.Reserve(reservedSize);
+		}
+		arenas->thread = (unsigned int) registry.size();
+		threadArenas = arenas.get();
+		registry.push_back(std::move(arenas));
+	}
+
+	uint64_t frame = currentFrame.load(std::memory_order_acquire);
+	if (frame != threadArenas->frame)
+	{
+		FinishFrame(*threadArenas, threadArenas->arenas[threadArenas->frame % FRAME_ARENA_BUFFERS]);
+
+		// what this arena held is FRAME_ARENA_BUFFERS frames old or older
+		threadArenas->frame = frame;
+		threadArenas->arenas[frame % FRAME_ARENA_BUFFERS].Reset();
+	}
+
+	return threadArenas->arenas[frame % FRAME_ARENA_BUFFERS];
+}
+
+void FrameArenaReserve(size_t size)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	reservedSize = std::max(reservedSize, size);
+	for (const std::unique_ptr<ThreadArenas>& arenas : registry)
+	{
+		for (FrameArena& arena : arenas->arenas)
+		{
+			arena.Reserve(reservedSize);
+		}
+	}
+}
+
+void PrintFrameArenaStats()
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+
+	for (const std::unique_ptr<ThreadArenas>& arenas : registry)
+	{
+		// the frame still in progress counts as well
+		size_t frames = arenas->frames;
+		size_t totalUsed = arenas->totalUsed;
+		size_t maxUsed = arenas->maxUsed;
+		size_t reserved = 0;
+		size_t blockAllocations = 0;
+
+		const FrameArena& current = arenas->arenas[arenas->frame % FRAME_ARENA_BUFFERS];
+		if (current.GetUsed() > 0)
+		{
+			frames++;
+			totalUsed += current.GetUsed();
+			maxUsed = std::max(maxUsed, current.GetUsed());
+		}
+
+		for (const FrameArena& arena : arenas->arenas)
+		{
+			reserved += arena.GetReserved();
+			blockAllocations += arena.GetBlockAllocations();
+		}
+
+		if (frames == 0)
+		{
+			continue;
+		}
+
+		printf("Frame arena, thread %u: peak %.1f KB per frame, mean %.1f KB over %zu frames, %.1f KB reserved in %zu block allocations\n",
+		       arenas->thread, maxUsed / 1024.0, totalUsed / 1024.0 / frames, frames, reserved / 1024.0, blockAllocations);
+	}
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// debug builds poison dropped memory unless told otherwise
+#if defined(_DEBUG) && !defined(FRAME_ARENA_DEBUG)
+#define FRAME_ARENA_DEBUG
+#endif
+
+// Linear allocator for data that lives a frame or two. Allocate bumps an offset through blocks that are
+// kept from frame to frame, so once they have grown to what a frame needs nothing touches the heap. There
+// is no free; Reset drops everything at once and remembers the most a frame used. With FRAME_ARENA_DEBUG
+// dropped memory is filled with POISON, so data read after its frame shows up as garbage instead of
+// stale values that still look right.
+class FrameArena
+{
+public:
+	static constexpr size_t BLOCK_SIZE = 64 * 1024;
+	static constexpr unsigned char POISON = 0xDD;
+
+	FrameArena();
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// value initialized; nothing is ever destroyed, so only for types that need no destructor
+	template <typename T>
+	T* AllocateArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "the arena never runs destructors");
+		T* items = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		for (size_t i = 0; i < count; i++)
+		{
+			new (items + i) T();
+		}
+		return items;
+	}
+
+	void Reset();
+	void Reserve(size_t size); // keeps blocks for at least size bytes
+
+	size_t GetUsed() const { return used; }         // bytes since the last reset, alignment padding included
+	size_t GetPeak() const { return peak; }         // most bytes any frame used
+	size_t GetReserved() const;                     // bytes held in blocks
+	size_t GetBlockAllocations() const { return blockAllocations; } // times a block came from the heap
+
+	~FrameArena();
+
+private:
+	struct Block
+	{
+		std::vector<unsigned char> data;
+		size_t used;
+	};
+
+	std::vector<Block> blocks;
+	size_t currentBlock;
+	size_t used;
+	size_t peak;
+	size_t blockAllocations;
+};
+
+// Every thread has FRAME_ARENA_BUFFERS arenas and uses the one for the current frame, so what it allocated
+// stays valid for that frame and the two after it, as long as the triple buffered frame packets keep a
+// frame around. The main thread moves every thread on with FrameArenaNextFrame; a thread resets the arena
+// it moves to the first time it allocates in the new frame, never while another thread uses it.
+static constexpr unsigned int FRAME_ARENA_BUFFERS = 3;
+
+void FrameArenaNextFrame();
+FrameArena& GetFrameArena(); // the calling thread's arena for the current frame
+
+// keeps at least size bytes in every arena of every thread, including threads that start later; the
+// other threads must not be using their arenas, so call it before frames run
+void FrameArenaReserve(size_t size);
+
+// per thread peak and mean use per frame, for threads that allocated anything; call once the other threads are idle
+void PrintFrameArenaStats();
+
+// STL allocator on a frame arena. A container allocates from the arena of the thread that made it, so
+// only that thread may grow it, and it must not outlive the arena's frames. Deallocation does nothing.
+template <typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameAllocator() : arena(&GetFrameArena()) {}
+	explicit FrameAllocator(FrameArena& arena) : arena(&arena) {}
+
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t count) { return static_cast<T*>(arena->Allocate(sizeof(T) * count, alignof(T))); }
+	void deallocate(T* items, size_t count) {}
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+	template <typename U>
+	bool operator!=(const FrameAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+	template <typename U>
+	friend class FrameAllocator;
+
+	FrameArena* arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
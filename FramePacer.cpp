@@ -0,0 +1,111 @@
+#include "FramePacer.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX // keeps std::max usable
+#include <Windows.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+#include "Profiler.h"
+
+FramePacer::FramePacer() :
+	framePeriod(0), started(false), spinMargin(INITIAL_SPIN_MARGIN), timerPeriodRaised(false),
+	pacedFrames(0), overBudgetFrames(0), sleepTime(0.0), spinTime(0.0), totalLateness(0.0), maxLateness(0.0)
+{
+}
+
+void FramePacer::SetTargetRate(double framesPerSecond)
+{
+	framePeriod = framesPerSecond > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond))
+	                                    : Clock::duration(0);
+	started = false;
+
+#ifdef _WIN32
+	// the default 15.6 ms timer resolution would turn every sleep into a spin
+	if (IsLimiting() && !timerPeriodRaised)
+	{
+		timerPeriodRaised = timeBeginPeriod(1) == TIMERR_NOERROR;
+	}
+	else if (!IsLimiting() && timerPeriodRaised)
+	{
+		timeEndPeriod(1);
+		timerPeriodRaised = false;
+	}
+#endif
+}
+
+void FramePacer::Wait()
+{
+	if (!IsLimiting())
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("Frame limiter");
+
+	Clock::time_point now = Clock::now();
+	if (!started || now >= nextDeadline)
+	{
+		// behind schedule: start the next period from here rather than rushing frames out to catch up
+		overBudgetFrames += started ? 1 : 0;
+		started = true;
+		nextDeadline = now + framePeriod;
+		return;
+	}
+
+	Clock::time_point sleepUntil = nextDeadline - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(spinMargin));
+	if (now < sleepUntil)
+	{
+		std::this_thread::sleep_until(sleepUntil);
+		Clock::time_point woke = Clock::now();
+		sleepTime += std::chrono::duration<double>(woke - now).count();
+
+		// keep enough margin for the worst oversleep lately, shrinking slowly once the scheduler behaves
+		double oversleep = std::chrono::duration<double>(woke - sleepUntil).count();
+		spinMargin = std::max({ MIN_SPIN_MARGIN, spinMargin * MARGIN_DECAY, oversleep * 1.5 });
+		now = woke;
+	}
+
+	Clock::time_point spinStart = now;
+	while (now < nextDeadline)
+	{
+		std::this_thread::yield();
+		now = Clock::now();
+	}
+	spinTime += std::chrono::duration<double>(now - spinStart).count();
+
+	double lateness = std::chrono::duration<double>(now - nextDeadline).count();
+	totalLateness += lateness;
+	maxLateness = std::max(maxLateness, lateness);
+	pacedFrames++;
+
+	nextDeadline += framePeriod;
+}
+
+void FramePacer::PrintSummary() const
+{
+	if (!IsLimiting())
+	{
+		return;
+	}
+
+	size_t frames = std::max<size_t>(pacedFrames, 1);
+	printf("Frame limiter at %.1f fps: %zu paced frames, %zu over budget\n",
+	       1.0 / std::chrono::duration<double>(framePeriod).count(), pacedFrames, overBudgetFrames);
+	printf("  per paced frame: sleep %.3f ms, spin %.3f ms, late by %.3f ms (max %.3f ms), spin margin %.3f ms\n",
+	       sleepTime * 1000.0 / frames, spinTime * 1000.0 / frames, totalLateness * 1000.0 / frames, maxLateness * 1000.0, spinMargin * 1000.0);
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+	if (timerPeriodRaised)
+	{
+		timeEndPeriod(1);
+	}
+#endif
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <chrono>
+
+// Frame rate limiter: Wait holds each frame back until a fixed period after the previous one started.
+// It sleeps until shortly before the deadline and spins the rest, since a sleep can wake up a whole
+// scheduler tick late; the spin margin follows the worst recent oversleep, so the CPU only spins as
+// long as it has to. Called before input is sampled, so the wait never adds to input latency.
+class FramePacer
+{
+public:
+	FramePacer();
+
+	void SetTargetRate(double framesPerSecond); // 0 disables the limit
+	bool IsLimiting() const { return framePeriod.count() > 0; }
+
+	void Wait();
+
+	// frames over budget, time slept and spun, and how late the frames started
+	void PrintSummary() const;
+
+	~FramePacer();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	static constexpr double INITIAL_SPIN_MARGIN = 0.002; // seconds, about two scheduler ticks
+	static constexpr double MIN_SPIN_MARGIN = 0.0002;
+	static constexpr double MARGIN_DECAY = 0.99;         // per frame, so one bad wake up is forgotten after a while
+
+	Clock::duration framePeriod;
+	Clock::time_point nextDeadline;
+	bool started;
+	double spinMargin; // seconds before the deadline where sleeping stops
+	bool timerPeriodRaised;
+
+	size_t pacedFrames;
+	size_t overBudgetFrames; // already late when Wait was called, nothing to limit
+	double sleepTime;        // seconds, totals over the paced frames
+	double spinTime;
+	double totalLateness;    // seconds past the deadline each paced frame actually started
+	double maxLateness;
+};
@@ -0,0 +1,101 @@
+#include "FramePacket.h"
+
+void FramePacket::Clear()
+{
+	draws.clear();
+	meshletRanges.clear();
+	fullDetailTriangles = 0;
+	renderedTriangles = 0;
+	occlusionTested = 0;
+	occlusionOccluded = 0;
+	simTime = 0.0;
+	occlusionTime = 0.0;
+	mouseLook = false;
+}
+
+FramePacketBuffer::FramePacketBuffer() :
+	middle(1), writeIndex(0), readIndex(2), droppedPackets(0), closed(false)
+{
+	for (FramePacket& packet : packets)
+	{
+		packet.frame = 0;
+		packet.Clear();
+	}
+}
+
+void FramePacketBuffer::Reserve(size_t draws, size_t meshletRanges)
+{
+	for (FramePacket& packet : packets)
+	{
+		packet.draws.reserve(draws);
+		packet.meshletRanges.reserve(meshletRanges);
+	}
+}
+
+void FramePacketBuffer::Publish()
+{
+	unsigned int previous = middle.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+	if (previous & FRESH)
+	{
+		droppedPackets++; // the consumer never saw it
+	}
+	writeIndex = previous & INDEX_MASK;
+	Notify();
+}
+
+bool FramePacketBuffer::WaitUntilConsumed()
+{
+	std::unique_lock<std::mutex> lock(waitMutex);
+	changed.wait(lock, [this] { return !(middle.load() & FRESH) || closed.load(); });
+	return !closed.load();
+}
+
+const FramePacket* FramePacketBuffer::Acquire()
+{
+	// only the producer changes the middle slot besides us, and it never clears FRESH
+	if (!(middle.load(std::memory_order_acquire) & FRESH))
+	{
+		return nullptr;
+	}
+
+	unsigned int previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+	readIndex = previous & INDEX_MASK;
+	Notify();
+	return &packets[readIndex];
+}
+
+const FramePacket* FramePacketBuffer::WaitForPacket()
+{
+	while (true)
+	{
+		// closed is read first, so a packet published before closing is still picked up
+		bool wasClosed = closed.load();
+		const FramePacket* packet = Acquire();
+		if (packet || wasClosed)
+		{
+			return packet;
+		}
+
+		std::unique_lock<std::mutex> lock(waitMutex);
+		changed.wait(lock, [this] { return (middle.load() & FRESH) || closed.load(); });
+	}
+}
+
+void FramePacketBuffer::Close()
+{
+	closed = true;
+	Notify();
+}
+
+void FramePacketBuffer::Notify()
+{
+	// waiters check their condition under the mutex, so taking it here means none of them misses this
+	{
+		std::lock_guard<std::mutex> lock(waitMutex);
+	}
+	changed.notify_all();
+}
+
+FramePacketBuffer::~FramePacketBuffer()
+{
+}
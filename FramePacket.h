@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "Meshlet.h"
+
+class Mesh;
+class Texture;
+class Light;
+class Material;
+
+// one object the render thread draws, with everything the simulation decided about it
+struct PacketDraw
+{
+	Mesh* mesh;
+	Texture* texture;
+	Material* material;
+	Light* light;
+	glm::mat4 model;
+	unsigned int lod;
+	size_t firstRange;  // meshlets that survived culling, in FramePacket::meshletRanges, when LOD 0 is drawn per meshlet
+	size_t rangeCount;
+};
+
+// Everything the render thread needs for one frame. Written by the simulation, read only once published,
+// so the two threads never touch the camera or the scene objects at the same time.
+struct FramePacket
+{
+	uint64_t frame;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 eyePosition;
+	Camera viewCamera; // what view and eyePosition come from, low latency mode turns a copy by later mouse motion
+	std::vector<PacketDraw> draws;
+	std::vector<MeshletRange> meshletRanges;
+
+	unsigned int fullDetailTriangles;
+	unsigned int renderedTriangles;
+	unsigned int occlusionTested;   // objects left by frustum culling and tested against the occluders
+	unsigned int occlusionOccluded;
+
+	std::chrono::steady_clock::time_point inputTime; // when the input this frame shows was sampled
+	double takenMouseX; // all mouse motion simulated up to this packet, motion the window saw since comes after it
+	double takenMouseY;
+	bool mouseLook; // the mouse turns the camera, not a gamepad
+	double simTime;                                  // ms the simulation spent building the packet
+	double occlusionTime;                            // ms of it spent rasterizing occluders and testing against them
+
+	void Clear();
+};
+
+// Triple buffer between one producer and one consumer. The producer always owns a slot to write into,
+// the consumer always owns the slot it is rendering, and the third holds the newest published packet,
+// so neither side waits for the other while both have work. Swapping slots is a single atomic exchange.
+class FramePacketBuffer
+{
+public:
+	FramePacketBuffer();
+
+	// producer side
+	FramePacket& GetWritePacket() { return packets[writeIndex]; }
+	void Publish();           // hands the write slot over, replacing a packet nobody acquired yet
+	bool WaitUntilConsumed(); // blocks while a published packet is still pending, false once closed
+	void Reserve(size_t draws, size_t meshletRanges); // in every slot, before the first packet is written
+
+	// consumer side: the newest packet published since the last acquire, nullptr if there is none
+	const FramePacket* Acquire();
+	const FramePacket* WaitForPacket(); // nullptr once closed and drained
+
+	// wakes both sides for good, a packet already published can still be acquired
+	void Close();
+	bool IsClosed() const { return closed.load(); }
+
+	size_t GetDroppedCount() const { return droppedPackets; } // read once the producer has stopped
+
+	~FramePacketBuffer();
+
+private:
+	static constexpr unsigned int SLOT_COUNT = 3;
+	static constexpr unsigned int INDEX_MASK = 3;
+	static constexpr unsigned int FRESH = 4; // set while the middle slot holds a packet nobody acquired
+
+	FramePacket packets[SLOT_COUNT];
+	std::atomic<unsigned int> middle; // index of the shared slot, plus FRESH
+	unsigned int writeIndex;          // only touched by the producer
+	unsigned int readIndex;           // only touched by the consumer
+	size_t droppedPackets;
+	std::atomic<bool> closed;
+
+	// only for sleeping, the slots themselves are exchanged without it
+	std::mutex waitMutex;
+	std::condition_variable changed;
+
+	void Notify();
+};
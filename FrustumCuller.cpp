@@ -0,0 +1,171 @@
+#include "FrustumCuller.h"
+
+#include <cfloat>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+FrustumCuller::FrustumCuller() : objectCount(0), visibleCount(0), culledCount(0)
+{
+}
+
+void FrustumCuller::Reserve(size_t count)
+{
+	size_t padded = (count + BATCH_SIZE - 1) / BATCH_SIZE * BATCH_SIZE;
+
+	centerX.reserve(padded);
+	centerY.reserve(padded);
+	centerZ.reserve(padded);
+	radius.reserve(padded);
+	visible.reserve(padded);
+}
+
+unsigned int FrustumCuller::AddObject(const BoundingSphere& worldSphere)
+{
+	if (objectCount == centerX.size())
+	{
+		// grow by a whole batch of padding spheres, negative radius means they are never visible
+		centerX.resize(objectCount + BATCH_SIZE, 0.0f);
+		centerY.resize(objectCount + BATCH_SIZE, 0.0f);
+		centerZ.resize(objectCount + BATCH_SIZE, 0.0f);
+		radius.resize(objectCount + BATCH_SIZE, -FLT_MAX);
+	}
+
+	unsigned int index = (unsigned int) objectCount;
+	objectCount++;
+
+	SetObject(index, worldSphere);
+
+	return index;
+}
+
+void FrustumCuller::SetObject(unsigned int index, const BoundingSphere& worldSphere)
+{
+	if (index >= objectCount)
+	{
+		return;
+	}
+
+	centerX[index] = worldSphere.center.x;
+	centerY[index] = worldSphere.center.y;
+	centerZ[index] = worldSphere.center.z;
+	radius[index] = worldSphere.radius;
+}
+
+void FrustumCuller::Clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	radius.clear();
+	visible.clear();
+
+	objectCount = 0;
+	visibleCount = 0;
+	culledCount = 0;
+}
+
+size_t FrustumCuller::Cull(const Frustum& frustum)
+{
+	const size_t paddedCount = centerX.size();
+
+	// worst case every object is visible, so compaction can write without bounds checks
+	visible.resize(paddedCount);
+	unsigned int* out = visible.data();
+	size_t count = 0;
+
+#if defined(__AVX__)
+	__m256 planeX[Frustum::NUM_PLANES], planeY[Frustum::NUM_PLANES], planeZ[Frustum::NUM_PLANES], planeW[Frustum::NUM_PLANES];
+	for (int p = 0; p < Frustum::NUM_PLANES; p++)
+	{
+		planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+	}
+
+	const __m256 zero = _mm256_setzero_ps();
+
+	for (size_t i = 0; i < paddedCount; i += BATCH_SIZE)
+	{
+		__m256 x = _mm256_loadu_ps(&centerX[i]);
+		__m256 y = _mm256_loadu_ps(&centerY[i]);
+		__m256 z = _mm256_loadu_ps(&centerZ[i]);
+		__m256 r = _mm256_loadu_ps(&radius[i]);
+
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < Frustum::NUM_PLANES; p++)
+		{
+			// distance + radius >= 0 for every plane
+			__m256 distance = _mm256_add_ps(_mm256_mul_ps(x, planeX[p]), _mm256_mul_ps(y, planeY[p]));
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(z, planeZ[p]));
+			distance = _mm256_add_ps(distance, _mm256_add_ps(planeW[p], r));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+		}
+
+		int mask = _mm256_movemask_ps(inside);
+#else
+	__m128 planeX[Frustum::NUM_PLANES], planeY[Frustum::NUM_PLANES], planeZ[Frustum::NUM_PLANES], planeW[Frustum::NUM_PLANES];
+	for (int p = 0; p < Frustum::NUM_PLANES; p++)
+	{
+		planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+
+	// two SSE registers per iteration keeps the same batch of 8 as the AVX path
+	for (size_t i = 0; i < paddedCount; i += BATCH_SIZE)
+	{
+		__m128 xLo = _mm_loadu_ps(&centerX[i]), xHi = _mm_loadu_ps(&centerX[i + 4]);
+		__m128 yLo = _mm_loadu_ps(&centerY[i]), yHi = _mm_loadu_ps(&centerY[i + 4]);
+		__m128 zLo = _mm_loadu_ps(&centerZ[i]), zHi = _mm_loadu_ps(&centerZ[i + 4]);
+		__m128 rLo = _mm_loadu_ps(&radius[i]), rHi = _mm_loadu_ps(&radius[i + 4]);
+
+		__m128 insideLo = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 insideHi = insideLo;
+		for (int p = 0; p < Frustum::NUM_PLANES; p++)
+		{
+			__m128 distanceLo = _mm_add_ps(_mm_mul_ps(xLo, planeX[p]), _mm_mul_ps(yLo, planeY[p]));
+			__m128 distanceHi = _mm_add_ps(_mm_mul_ps(xHi, planeX[p]), _mm_mul_ps(yHi, planeY[p]));
+			distanceLo = _mm_add_ps(distanceLo, _mm_mul_ps(zLo, planeZ[p]));
+			distanceHi = _mm_add_ps(distanceHi, _mm_mul_ps(zHi, planeZ[p]));
+			distanceLo = _mm_add_ps(distanceLo, _mm_add_ps(planeW[p], rLo));
+			distanceHi = _mm_add_ps(distanceHi, _mm_add_ps(planeW[p], rHi));
+			insideLo = _mm_and_ps(insideLo, _mm_cmpge_ps(distanceLo, zero));
+			insideHi = _mm_and_ps(insideHi, _mm_cmpge_ps(distanceHi, zero));
+		}
+
+		int mask = _mm_movemask_ps(insideLo) | (_mm_movemask_ps(insideHi) << 4);
+#endif
+
+		// compact the surviving indices
+		while (mask != 0)
+		{
+			int bit = 0;
+			while (((mask >> bit) & 1) == 0)
+			{
+				bit++;
+			}
+
+			out[count++] = (unsigned int) (i + bit);
+			mask &= mask - 1; // clear lowest set bit
+		}
+	}
+
+	visible.resize(count);
+
+	visibleCount = count;
+	culledCount = objectCount - count;
+
+	return visibleCount;
+}
+
+FrustumCuller::~FrustumCuller()
+{
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "Bounds.h"
+
+// Tests world space bounding spheres against a frustum in SoA batches of 8.
+// Objects are identified by the index returned from AddObject.
+class FrustumCuller
+{
+public:
+	FrustumCuller();
+
+	void Reserve(size_t objectCount);
+	unsigned int AddObject(const BoundingSphere& worldSphere);
+	void SetObject(unsigned int index, const BoundingSphere& worldSphere);
+	void Clear();
+
+	// fills the visible list with the indices of every object touching the frustum, returns the visible count
+	size_t Cull(const Frustum& frustum);
+
+	const std::vector<unsigned int>& GetVisible() const { return visible; }
+	size_t GetObjectCount() const { return objectCount; }
+	size_t GetVisibleCount() const { return visibleCount; }
+	size_t GetCulledCount() const { return culledCount; }
+
+	~FrustumCuller();
+
+private:
+	static constexpr size_t BATCH_SIZE = 8;
+
+	// SoA storage, padded to a multiple of BATCH_SIZE with spheres that always fail
+	std::vector<float> centerX;
+	std::vector<float> centerY;
+	std::vector<float> centerZ;
+	std::vector<float> radius;
+
+	std::vector<unsigned int> visible;
+
+	size_t objectCount;
+	size_t visibleCount;
+	size_t culledCount;
+};
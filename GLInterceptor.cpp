@@ -0,0 +1,919 @@
+#include "GLInterceptor.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+namespace
+{
+	constexpr int MAX_TRACKED_TEXTURE_UNITS = 32;
+
+	const char* callNames[GL_TRACE_CALL_COUNT] = {
+		"glGenVertexArrays", "glBindVertexArray", "glDeleteVertexArrays",
+		"glGenBuffers", "glBindBuffer", "glBufferData", "glBufferSubData", "glDeleteBuffers",
+		"glVertexAttribPointer", "glEnableVertexAttribArray",
+		"glDrawElements", "glMultiDrawElements",
+		"glGenTextures", "glActiveTexture", "glBindTexture", "glTexImage2D", "glTexParameteri", "glGenerateMipmap", "glDeleteTextures",
+		"glCreateProgram", "glCreateShader", "glShaderSource", "glCompileShader", "glAttachShader", "glDeleteShader",
+		"glLinkProgram", "glValidateProgram", "glUseProgram", "glDeleteProgram", "glGetUniformLocation",
+		"glUniform1f", "glUniform3f", "glUniformMatrix4fv",
+		"glGenFramebuffers", "glBindFramebuffer", "glFramebufferRenderbuffer", "glDeleteFramebuffers",
+		"glGenRenderbuffers", "glBindRenderbuffer", "glRenderbufferStorage", "glDeleteRenderbuffers",
+		"glClearColor", "glClear",
+		"glGetShaderiv", "glGetShaderInfoLog", "glGetProgramiv", "glGetProgramInfoLog"
+	};
+
+	struct InterceptorState
+	{
+		bool installed;
+		FILE* trace;
+
+		GLFrameStats current;
+		GLFrameStats last;
+		size_t totals[GL_TRACE_CALL_COUNT];
+
+		// what the hooks believe is bound, only used to spot redundant binds
+		GLuint vertexArray;
+		GLuint arrayBuffer;
+		GLuint elementBuffer; // part of the vertex array state, forgotten whenever that changes
+		GLuint program;
+		GLuint framebuffer;
+		GLuint renderbuffer;
+		GLuint activeTexture;
+		GLuint textures[MAX_TRACKED_TEXTURE_UNITS];
+	};
+
+	InterceptorState state;
+
+	// the driver entry points the hooks forward to
+	PFNGLGENVERTEXARRAYSPROC realGenVertexArrays;
+	PFNGLBINDVERTEXARRAYPROC realBindVertexArray;
+	PFNGLDELETEVERTEXARRAYSPROC realDeleteVertexArrays;
+	PFNGLGENBUFFERSPROC realGenBuffers;
+	PFNGLBINDBUFFERPROC realBindBuffer;
+	PFNGLBUFFERDATAPROC realBufferData;
+	PFNGLBUFFERSUBDATAPROC realBufferSubData;
+	PFNGLDELETEBUFFERSPROC realDeleteBuffers;
+	PFNGLVERTEXATTRIBPOINTERPROC realVertexAttribPointer;
+	PFNGLENABLEVERTEXATTRIBARRAYPROC realEnableVertexAttribArray;
+	PFNGLMULTIDRAWELEMENTSPROC realMultiDrawElements;
+	PFNGLACTIVETEXTUREPROC realActiveTexture;
+	PFNGLGENERATEMIPMAPPROC realGenerateMipmap;
+	PFNGLCREATEPROGRAMPROC realCreateProgram;
+	PFNGLCREATESHADERPROC realCreateShader;
+	PFNGLSHADERSOURCEPROC realShaderSource;
+	PFNGLCOMPILESHADERPROC realCompileShader;
+	PFNGLATTACHSHADERPROC realAttachShader;
+	PFNGLDELETESHADERPROC realDeleteShader;
+	PFNGLLINKPROGRAMPROC realLinkProgram;
+	PFNGLVALIDATEPROGRAMPROC realValidateProgram;
+	PFNGLUSEPROGRAMPROC realUseProgram;
+	PFNGLDELETEPROGRAMPROC realDeleteProgram;
+	PFNGLGETUNIFORMLOCATIONPROC realGetUniformLocation;
+	PFNGLUNIFORM1FPROC realUniform1f;
+	PFNGLUNIFORM3FPROC realUniform3f;
+	PFNGLUNIFORMMATRIX4FVPROC realUniformMatrix4fv;
+	PFNGLGENFRAMEBUFFERSPROC realGenFramebuffers;
+	PFNGLBINDFRAMEBUFFERPROC realBindFramebuffer;
+	PFNGLFRAMEBUFFERRENDERBUFFERPROC realFramebufferRenderbuffer;
+	PFNGLDELETEFRAMEBUFFERSPROC realDeleteFramebuffers;
+	PFNGLGENRENDERBUFFERSPROC realGenRenderbuffers;
+	PFNGLBINDRENDERBUFFERPROC realBindRenderbuffer;
+	PFNGLRENDERBUFFERSTORAGEPROC realRenderbufferStorage;
+	PFNGLDELETERENDERBUFFERSPROC realDeleteRenderbuffers;
+	PFNGLGETSHADERIVPROC realGetShaderiv;
+	PFNGLGETSHADERINFOLOGPROC realGetShaderInfoLog;
+	PFNGLGETPROGRAMIVPROC realGetProgramiv;
+	PFNGLGETPROGRAMINFOLOGPROC realGetProgramInfoLog;
+
+	void Write(const void* data, size_t size)
+	{
+		fwrite(data, 1, size, state.trace);
+	}
+
+	template <typename T>
+	void Write(T value)
+	{
+		Write(&value, sizeof(T));
+	}
+
+	void WriteBlob(const void* data, size_t size)
+	{
+		Write((uint32_t) size);
+		if (size > 0)
+		{
+			Write(data, size);
+		}
+	}
+
+	void Count(GLTraceCall call)
+	{
+		state.current.calls++;
+		state.totals[call]++;
+	}
+
+	// counts the call and starts its trace record, true when the arguments should be written
+	bool Begin(GLTraceCall call)
+	{
+		Count(call);
+
+		if (!state.trace)
+		{
+			return false;
+		}
+
+		Write((uint16_t) call);
+		return true;
+	}
+
+	void Bind(GLuint& tracked, GLuint name)
+	{
+		if (tracked == name)
+		{
+			state.current.redundantBinds++;
+		}
+		tracked = name;
+	}
+
+	void Forget(GLuint& tracked, GLsizei n, const GLuint* names)
+	{
+		for (GLsizei i = 0; i < n; i++)
+		{
+			if (tracked == names[i])
+			{
+				tracked = 0;
+			}
+		}
+	}
+
+	void CountDraw(GLenum mode, size_t indexCount)
+	{
+		state.current.draws++;
+		if (mode == GL_TRIANGLES)
+		{
+			state.current.triangles += indexCount / 3;
+		}
+	}
+
+	// size of a glTexImage2D upload with the default unpack alignment of 4
+	size_t TextureUploadSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+	{
+		size_t channels = 4;
+		switch (format)
+		{
+		case GL_RED: case GL_DEPTH_COMPONENT: channels = 1; break;
+		case GL_RG: channels = 2; break;
+		case GL_RGB: case GL_BGR: channels = 3; break;
+		default: break;
+		}
+
+		size_t channelSize = (type == GL_FLOAT || type == GL_UNSIGNED_INT || type == GL_INT) ? 4 :
+		                     (type == GL_UNSIGNED_SHORT || type == GL_SHORT || type == GL_HALF_FLOAT) ? 2 : 1;
+
+		size_t rowSize = (width * channels * channelSize + 3) / 4 * 4;
+		return rowSize * height;
+	}
+
+	void GLAPIENTRY HookGenVertexArrays(GLsizei n, GLuint* arrays)
+	{
+		realGenVertexArrays(n, arrays);
+		if (Begin(GL_TRACE_GEN_VERTEX_ARRAYS))
+		{
+			Write(n);
+			Write(arrays, sizeof(GLuint) * n);
+		}
+	}
+
+	void GLAPIENTRY HookBindVertexArray(GLuint array)
+	{
+		if (Begin(GL_TRACE_BIND_VERTEX_ARRAY))
+		{
+			Write(array);
+		}
+
+		if (state.vertexArray != array)
+		{
+			state.elementBuffer = 0;
+		}
+		Bind(state.vertexArray, array);
+		realBindVertexArray(array);
+	}
+
+	void GLAPIENTRY HookDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+	{
+		if (Begin(GL_TRACE_DELETE_VERTEX_ARRAYS))
+		{
+			Write(n);
+			Write(arrays, sizeof(GLuint) * n);
+		}
+
+		Forget(state.vertexArray, n, arrays);
+		realDeleteVertexArrays(n, arrays);
+	}
+
+	void GLAPIENTRY HookGenBuffers(GLsizei n, GLuint* buffers)
+	{
+		realGenBuffers(n, buffers);
+		if (Begin(GL_TRACE_GEN_BUFFERS))
+		{
+			Write(n);
+			Write(buffers, sizeof(GLuint) * n);
+		}
+	}
+
+	void GLAPIENTRY HookBindBuffer(GLenum target, GLuint buffer)
+	{
+		if (Begin(GL_TRACE_BIND_BUFFER))
+		{
+			Write(target);
+			Write(buffer);
+		}
+
+		if (target == GL_ARRAY_BUFFER)
+		{
+			Bind(state.arrayBuffer, buffer);
+		}
+		else if (target == GL_ELEMENT_ARRAY_BUFFER)
+		{
+			Bind(state.elementBuffer, buffer);
+		}
+		realBindBuffer(target, buffer);
+	}
+
+	void GLAPIENTRY HookBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+	{
+		if (Begin(GL_TRACE_BUFFER_DATA))
+		{
+			Write(target);
+			Write(usage);
+			Write((uint64_t) size);
+			WriteBlob(data, data ? size : 0);
+		}
+
+		state.current.bufferBytes += size;
+		realBufferData(target, size, data, usage);
+	}
+
+	void GLAPIENTRY HookBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+	{
+		if (Begin(GL_TRACE_BUFFER_SUB_DATA))
+		{
+			Write(target);
+			Write((uint64_t) offset);
+			WriteBlob(data, size);
+		}
+
+		state.current.bufferBytes += size;
+		realBufferSubData(target, offset, size, data);
+	}
+
+	void GLAPIENTRY HookDeleteBuffers(GLsizei n, const GLuint* buffers)
+	{
+		if (Begin(GL_TRACE_DELETE_BUFFERS))
+		{
+			Write(n);
+			Write(buffers, sizeof(GLuint) * n);
+		}
+
+		Forget(state.arrayBuffer, n, buffers);
+		Forget(state.elementBuffer, n, buffers);
+		realDeleteBuffers(n, buffers);
+	}
+
+	void GLAPIENTRY HookVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+	{
+		if (Begin(GL_TRACE_VERTEX_ATTRIB_POINTER))
+		{
+			Write(index);
+			Write(size);
+			Write(type);
+			Write(normalized);
+			Write(stride);
+			Write((uint64_t) (uintptr_t) pointer);
+		}
+
+		realVertexAttribPointer(index, size, type, normalized, stride, pointer);
+	}
+
+	void GLAPIENTRY HookEnableVertexAttribArray(GLuint index)
+	{
+		if (Begin(GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY))
+		{
+			Write(index);
+		}
+
+		realEnableVertexAttribArray(index);
+	}
+
+	void GLAPIENTRY HookMultiDrawElements(GLenum mode, const GLsizei* count, GLenum type, const void* const* indices, GLsizei drawcount)
+	{
+		if (Begin(GL_TRACE_MULTI_DRAW_ELEMENTS))
+		{
+			Write(mode);
+			Write(type);
+			Write(drawcount);
+			Write(count, sizeof(GLsizei) * drawcount);
+			for (GLsizei i = 0; i < drawcount; i++)
+			{
+				Write((uint64_t) (uintptr_t) indices[i]);
+			}
+		}
+
+		size_t indexCount = 0;
+		for (GLsizei i = 0; i < drawcount; i++)
+		{
+			indexCount += count[i];
+		}
+		CountDraw(mode, indexCount);
+
+		realMultiDrawElements(mode, count, type, indices, drawcount);
+	}
+
+	void GLAPIENTRY HookActiveTexture(GLenum texture)
+	{
+		if (Begin(GL_TRACE_ACTIVE_TEXTURE))
+		{
+			Write(texture);
+		}
+
+		state.activeTexture = texture - GL_TEXTURE0;
+		realActiveTexture(texture);
+	}
+
+	void GLAPIENTRY HookGenerateMipmap(GLenum target)
+	{
+		if (Begin(GL_TRACE_GENERATE_MIPMAP))
+		{
+			Write(target);
+		}
+
+		realGenerateMipmap(target);
+	}
+
+	GLuint GLAPIENTRY HookCreateProgram()
+	{
+		GLuint program = realCreateProgram();
+		if (Begin(GL_TRACE_CREATE_PROGRAM))
+		{
+			Write(program);
+		}
+		return program;
+	}
+
+	GLuint GLAPIENTRY HookCreateShader(GLenum type)
+	{
+		GLuint shader = realCreateShader(type);
+		if (Begin(GL_TRACE_CREATE_SHADER))
+		{
+			Write(type);
+			Write(shader);
+		}
+		return shader;
+	}
+
+	void GLAPIENTRY HookShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+	{
+		if (Begin(GL_TRACE_SHADER_SOURCE))
+		{
+			// all strings joined into one source
+			std::string source;
+			for (GLsizei i = 0; i < count; i++)
+			{
+				source.append(strings[i], lengths && lengths[i] >= 0 ? (size_t) lengths[i] : strlen(strings[i]));
+			}
+
+			Write(shader);
+			WriteBlob(source.data(), source.size());
+		}
+
+		realShaderSource(shader, count, strings, lengths);
+	}
+
+	void GLAPIENTRY HookCompileShader(GLuint shader)
+	{
+		if (Begin(GL_TRACE_COMPILE_SHADER))
+		{
+			Write(shader);
+		}
+
+		realCompileShader(shader);
+	}
+
+	void GLAPIENTRY HookAttachShader(GLuint program, GLuint shader)
+	{
+		if (Begin(GL_TRACE_ATTACH_SHADER))
+		{
+			Write(program);
+			Write(shader);
+		}
+
+		realAttachShader(program, shader);
+	}
+
+	void GLAPIENTRY HookDeleteShader(GLuint shader)
+	{
+		if (Begin(GL_TRACE_DELETE_SHADER))
+		{
+			Write(shader);
+		}
+
+		realDeleteShader(shader);
+	}
+
+	void GLAPIENTRY HookLinkProgram(GLuint program)
+	{
+		if (Begin(GL_TRACE_LINK_PROGRAM))
+		{
+			Write(program);
+		}
+
+		realLinkProgram(program);
+	}
+
+	void GLAPIENTRY HookValidateProgram(GLuint program)
+	{
+		if (Begin(GL_TRACE_VALIDATE_PROGRAM))
+		{
+			Write(program);
+		}
+
+		realValidateProgram(program);
+	}
+
+	void GLAPIENTRY HookUseProgram(GLuint program)
+	{
+		if (Begin(GL_TRACE_USE_PROGRAM))
+		{
+			Write(program);
+		}
+
+		Bind(state.program, program);
+		realUseProgram(program);
+	}
+
+	void GLAPIENTRY HookDeleteProgram(GLuint program)
+	{
+		if (Begin(GL_TRACE_DELETE_PROGRAM))
+		{
+			Write(program);
+		}
+
+		realDeleteProgram(program);
+	}
+
+	GLint GLAPIENTRY HookGetUniformLocation(GLuint program, const GLchar* name)
+	{
+		GLint location = realGetUniformLocation(program, name);
+		if (Begin(GL_TRACE_GET_UNIFORM_LOCATION))
+		{
+			Write(program);
+			WriteBlob(name, strlen(name));
+			Write(location);
+		}
+		return location;
+	}
+
+	void GLAPIENTRY HookUniform1f(GLint location, GLfloat v0)
+	{
+		if (Begin(GL_TRACE_UNIFORM_1F))
+		{
+			Write(location);
+			Write(v0);
+		}
+
+		realUniform1f(location, v0);
+	}
+
+	void GLAPIENTRY HookUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+	{
+		if (Begin(GL_TRACE_UNIFORM_3F))
+		{
+			Write(location);
+			Write(v0);
+			Write(v1);
+			Write(v2);
+		}
+
+		realUniform3f(location, v0, v1, v2);
+	}
+
+	void GLAPIENTRY HookUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+	{
+		constexpr size_t MATRIX_FLOATS = 16;
+
+		if (Begin(GL_TRACE_UNIFORM_MATRIX_4FV))
+		{
+			Write(location);
+			Write(count);
+			Write(transpose);
+			Write(value, sizeof(GLfloat) * MATRIX_FLOATS * count);
+		}
+
+		realUniformMatrix4fv(location, count, transpose, value);
+	}
+
+	void GLAPIENTRY HookGenFramebuffers(GLsizei n, GLuint* framebuffers)
+	{
+		realGenFramebuffers(n, framebuffers);
+		if (Begin(GL_TRACE_GEN_FRAMEBUFFERS))
+		{
+			Write(n);
+			Write(framebuffers, sizeof(GLuint) * n);
+		}
+	}
+
+	void GLAPIENTRY HookBindFramebuffer(GLenum target, GLuint framebuffer)
+	{
+		if (Begin(GL_TRACE_BIND_FRAMEBUFFER))
+		{
+			Write(target);
+			Write(framebuffer);
+		}
+
+		// separate draw and read bindings are not tracked, only binding both at once
+		if (target == GL_FRAMEBUFFER)
+		{
+			Bind(state.framebuffer, framebuffer);
+		}
+		else
+		{
+			state.framebuffer = (GLuint) -1;
+		}
+		realBindFramebuffer(target, framebuffer);
+	}
+
+	void GLAPIENTRY HookFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer)
+	{
+		if (Begin(GL_TRACE_FRAMEBUFFER_RENDERBUFFER))
+		{
+			Write(target);
+			Write(attachment);
+			Write(renderbufferTarget);
+			Write(renderbuffer);
+		}
+
+		realFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+	}
+
+	void GLAPIENTRY HookDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+	{
+		if (Begin(GL_TRACE_DELETE_FRAMEBUFFERS))
+		{
+			Write(n);
+			Write(framebuffers, sizeof(GLuint) * n);
+		}
+
+		Forget(state.framebuffer, n, framebuffers);
+		realDeleteFramebuffers(n, framebuffers);
+	}
+
+	void GLAPIENTRY HookGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+	{
+		realGenRenderbuffers(n, renderbuffers);
+		if (Begin(GL_TRACE_GEN_RENDERBUFFERS))
+		{
+			Write(n);
+			Write(renderbuffers, sizeof(GLuint) * n);
+		}
+	}
+
+	void GLAPIENTRY HookBindRenderbuffer(GLenum target, GLuint renderbuffer)
+	{
+		if (Begin(GL_TRACE_BIND_RENDERBUFFER))
+		{
+			Write(target);
+			Write(renderbuffer);
+		}
+
+		Bind(state.renderbuffer, renderbuffer);
+		realBindRenderbuffer(target, renderbuffer);
+	}
+
+	void GLAPIENTRY HookRenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height)
+	{
+		if (Begin(GL_TRACE_RENDERBUFFER_STORAGE))
+		{
+			Write(target);
+			Write(internalFormat);
+			Write(width);
+			Write(height);
+		}
+
+		realRenderbufferStorage(target, internalFormat, width, height);
+	}
+
+	void GLAPIENTRY HookDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
+	{
+		if (Begin(GL_TRACE_DELETE_RENDERBUFFERS))
+		{
+			Write(n);
+			Write(renderbuffers, sizeof(GLuint) * n);
+		}
+
+		Forget(state.renderbuffer, n, renderbuffers);
+		realDeleteRenderbuffers(n, renderbuffers);
+	}
+
+	void GLAPIENTRY HookGetShaderiv(GLuint shader, GLenum name, GLint* params)
+	{
+		Count(GL_TRACE_GET_SHADER_IV);
+		realGetShaderiv(shader, name, params);
+	}
+
+	void GLAPIENTRY HookGetShaderInfoLog(GLuint shader, GLsizei bufferSize, GLsizei* length, GLchar* infoLog)
+	{
+		Count(GL_TRACE_GET_SHADER_INFO_LOG);
+		realGetShaderInfoLog(shader, bufferSize, length, infoLog);
+	}
+
+	void GLAPIENTRY HookGetProgramiv(GLuint program, GLenum name, GLint* params)
+	{
+		Count(GL_TRACE_GET_PROGRAM_IV);
+		realGetProgramiv(program, name, params);
+	}
+
+	void GLAPIENTRY HookGetProgramInfoLog(GLuint program, GLsizei bufferSize, GLsizei* length, GLchar* infoLog)
+	{
+		Count(GL_TRACE_GET_PROGRAM_INFO_LOG);
+		realGetProgramInfoLog(program, bufferSize, length, infoLog);
+	}
+
+	// keeps the driver's pointer and puts the hook in GLEW's table
+	template <typename Proc>
+	void Hook(Proc& glewPointer, Proc& real, Proc hook)
+	{
+		real = glewPointer;
+		if (real)
+		{
+			glewPointer = hook;
+		}
+	}
+}
+
+void InstallGLInterceptor()
+{
+	if (state.installed)
+	{
+		return;
+	}
+
+	Hook(__glewGenVertexArrays, realGenVertexArrays, HookGenVertexArrays);
+	Hook(__glewBindVertexArray, realBindVertexArray, HookBindVertexArray);
+	Hook(__glewDeleteVertexArrays, realDeleteVertexArrays, HookDeleteVertexArrays);
+	Hook(__glewGenBuffers, realGenBuffers, HookGenBuffers);
+	Hook(__glewBindBuffer, realBindBuffer, HookBindBuffer);
+	Hook(__glewBufferData, realBufferData, HookBufferData);
+	Hook(__glewBufferSubData, realBufferSubData, HookBufferSubData);
+	Hook(__glewDeleteBuffers, realDeleteBuffers, HookDeleteBuffers);
+	Hook(__glewVertexAttribPointer, realVertexAttribPointer, HookVertexAttribPointer);
+	Hook(__glewEnableVertexAttribArray, realEnableVertexAttribArray, HookEnableVertexAttribArray);
+	Hook(__glewMultiDrawElements, realMultiDrawElements, HookMultiDrawElements);
+	Hook(__glewActiveTexture, realActiveTexture, HookActiveTexture);
+	Hook(__glewGenerateMipmap, realGenerateMipmap, HookGenerateMipmap);
+	Hook(__glewCreateProgram, realCreateProgram, HookCreateProgram);
+	Hook(__glewCreateShader, realCreateShader, HookCreateShader);
+	Hook(__glewShaderSource, realShaderSource, HookShaderSource);
+	Hook(__glewCompileShader, realCompileShader, HookCompileShader);
+	Hook(__glewAttachShader, realAttachShader, HookAttachShader);
+	Hook(__glewDeleteShader, realDeleteShader, HookDeleteShader);
+	Hook(__glewLinkProgram, realLinkProgram, HookLinkProgram);
+	Hook(__glewValidateProgram, realValidateProgram, HookValidateProgram);
+	Hook(__glewUseProgram, realUseProgram, HookUseProgram);
+	Hook(__glewDeleteProgram, realDeleteProgram, HookDeleteProgram);
+	Hook(__glewGetUniformLocation, realGetUniformLocation, HookGetUniformLocation);
+	Hook(__glewUniform1f, realUniform1f, HookUniform1f);
+	Hook(__glewUniform3f, realUniform3f, HookUniform3f);
+	Hook(__glewUniformMatrix4fv, realUniformMatrix4fv, HookUniformMatrix4fv);
+	Hook(__glewGenFramebuffers, realGenFramebuffers, HookGenFramebuffers);
+	Hook(__glewBindFramebuffer, realBindFramebuffer, HookBindFramebuffer);
+	Hook(__glewFramebufferRenderbuffer, realFramebufferRenderbuffer, HookFramebufferRenderbuffer);
+	Hook(__glewDeleteFramebuffers, realDeleteFramebuffers, HookDeleteFramebuffers);
+	Hook(__glewGenRenderbuffers, realGenRenderbuffers, HookGenRenderbuffers);
+	Hook(__glewBindRenderbuffer, realBindRenderbuffer, HookBindRenderbuffer);
+	Hook(__glewRenderbufferStorage, realRenderbufferStorage, HookRenderbufferStorage);
+	Hook(__glewDeleteRenderbuffers, realDeleteRenderbuffers, HookDeleteRenderbuffers);
+	Hook(__glewGetShaderiv, realGetShaderiv, HookGetShaderiv);
+	Hook(__glewGetShaderInfoLog, realGetShaderInfoLog, HookGetShaderInfoLog);
+	Hook(__glewGetProgramiv, realGetProgramiv, HookGetProgramiv);
+	Hook(__glewGetProgramInfoLog, realGetProgramInfoLog, HookGetProgramInfoLog);
+
+	// nothing is known to be bound yet, so no bind can count as redundant
+	state.vertexArray = (GLuint) -1;
+	state.arrayBuffer = (GLuint) -1;
+	state.elementBuffer = (GLuint) -1;
+	state.program = (GLuint) -1;
+	state.framebuffer = (GLuint) -1;
+	state.renderbuffer = (GLuint) -1;
+	state.activeTexture = 0;
+	for (GLuint& texture : state.textures)
+	{
+		texture = (GLuint) -1;
+	}
+
+	state.installed = true;
+}
+
+bool IsGLInterceptorInstalled()
+{
+	return state.installed;
+}
+
+bool StartGLTrace(const char* fileName)
+{
+	if (!state.installed)
+	{
+		printf("The GL interceptor must be installed before tracing\n");
+		return false;
+	}
+
+	StopGLTrace();
+
+	state.trace = fopen(fileName, "wb");
+	if (!state.trace)
+	{
+		printf("Failed to open %s for writing\n", fileName);
+		return false;
+	}
+
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	Write("GLTR", 4);
+	Write((uint32_t) GL_TRACE_VERSION);
+	Write((int32_t) viewport[2]);
+	Write((int32_t) viewport[3]);
+
+	return true;
+}
+
+void StopGLTrace()
+{
+	if (state.trace)
+	{
+		fclose(state.trace);
+		state.trace = nullptr;
+	}
+}
+
+void EndGLFrame()
+{
+	if (state.trace)
+	{
+		Write((uint16_t) GL_TRACE_FRAME_END);
+	}
+
+	state.last = state.current;
+	state.current = GLFrameStats{};
+}
+
+const GLFrameStats& GetLastGLFrameStats()
+{
+	return state.last;
+}
+
+const char* GetGLTraceCallName(GLTraceCall call)
+{
+	return call < GL_TRACE_CALL_COUNT ? callNames[call] : "frame end";
+}
+
+void PrintGLCallCounts(size_t frameCount)
+{
+	double frames = frameCount > 0 ? (double) frameCount : 1.0;
+
+	printf("GL calls (total, per frame):\n");
+	for (int call = 0; call < GL_TRACE_CALL_COUNT; call++)
+	{
+		if (state.totals[call] > 0)
+		{
+			printf("  %-28s %10zu %10.1f\n", callNames[call], state.totals[call], state.totals[call] / frames);
+		}
+	}
+}
+
+void TracedGenTextures(GLsizei n, GLuint* textures)
+{
+	glGenTextures(n, textures);
+	if (state.installed && Begin(GL_TRACE_GEN_TEXTURES))
+	{
+		Write(n);
+		Write(textures, sizeof(GLuint) * n);
+	}
+}
+
+void TracedBindTexture(GLenum target, GLuint texture)
+{
+	if (state.installed)
+	{
+		if (Begin(GL_TRACE_BIND_TEXTURE))
+		{
+			Write(target);
+			Write(texture);
+		}
+
+		if (target == GL_TEXTURE_2D && state.activeTexture < MAX_TRACKED_TEXTURE_UNITS)
+		{
+			Bind(state.textures[state.activeTexture], texture);
+		}
+	}
+
+	glBindTexture(target, texture);
+}
+
+void TracedTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                      GLenum format, GLenum type, const void* pixels)
+{
+	if (state.installed)
+	{
+		size_t size = TextureUploadSize(width, height, format, type);
+
+		if (Begin(GL_TRACE_TEX_IMAGE_2D))
+		{
+			Write(target);
+			Write(level);
+			Write(internalFormat);
+			Write(width);
+			Write(height);
+			Write(border);
+			Write(format);
+			Write(type);
+			WriteBlob(pixels, pixels ? size : 0);
+		}
+
+		state.current.textureBytes += size;
+	}
+
+	glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+void TracedTexParameteri(GLenum target, GLenum name, GLint value)
+{
+	if (state.installed && Begin(GL_TRACE_TEX_PARAMETER_I))
+	{
+		Write(target);
+		Write(name);
+		Write(value);
+	}
+
+	glTexParameteri(target, name, value);
+}
+
+void TracedDeleteTextures(GLsizei n, const GLuint* textures)
+{
+	if (state.installed)
+	{
+		if (Begin(GL_TRACE_DELETE_TEXTURES))
+		{
+			Write(n);
+			Write(textures, sizeof(GLuint) * n);
+		}
+
+		for (GLuint& bound : state.textures)
+		{
+			Forget(bound, n, textures);
+		}
+	}
+
+	glDeleteTextures(n, textures);
+}
+
+void TracedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+	if (state.installed)
+	{
+		if (Begin(GL_TRACE_DRAW_ELEMENTS))
+		{
+			Write(mode);
+			Write(count);
+			Write(type);
+			Write((uint64_t) (uintptr_t) indices);
+		}
+
+		CountDraw(mode, count);
+	}
+
+	glDrawElements(mode, count, type, indices);
+}
+
+void TracedClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	if (state.installed && Begin(GL_TRACE_CLEAR_COLOR))
+	{
+		Write(red);
+		Write(green);
+		Write(blue);
+		Write(alpha);
+	}
+
+	glClearColor(red, green, blue, alpha);
+}
+
+void TracedClear(GLbitfield mask)
+{
+	if (state.installed && Begin(GL_TRACE_CLEAR))
+	{
+		Write(mask);
+	}
+
+	glClear(mask);
+}
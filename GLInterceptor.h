@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <GL/glew.h>
+
+// Instrumentation between the engine and the driver. InstallGLInterceptor swaps the GLEW function
+// pointers for hooks that count every call and can record them to a binary trace for GLTraceReplayer.
+// GL 1.1 entry points are exported by the GL library itself instead of being loaded by GLEW, so the
+// few the engine uses are reached through the Traced* functions below.
+
+struct GLFrameStats
+{
+	size_t calls;
+	size_t draws;
+	size_t triangles;
+	size_t bufferBytes;   // glBufferData and glBufferSubData
+	size_t textureBytes;  // glTexImage2D
+	size_t redundantBinds; // binding what is already bound
+};
+
+// Trace format: "GLTR", version, viewport width and height, then records of a uint16 call id followed
+// by that call's arguments. Pointers into buffers are stored as 64 bit offsets, data as a uint32 size and bytes.
+enum GLTraceCall : unsigned short
+{
+	GL_TRACE_GEN_VERTEX_ARRAYS,
+	GL_TRACE_BIND_VERTEX_ARRAY,
+	GL_TRACE_DELETE_VERTEX_ARRAYS,
+	GL_TRACE_GEN_BUFFERS,
+	GL_TRACE_BIND_BUFFER,
+	GL_TRACE_BUFFER_DATA,
+	GL_TRACE_BUFFER_SUB_DATA,
+	GL_TRACE_DELETE_BUFFERS,
+	GL_TRACE_VERTEX_ATTRIB_POINTER,
+	GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY,
+	GL_TRACE_DRAW_ELEMENTS,
+	GL_TRACE_MULTI_DRAW_ELEMENTS,
+	GL_TRACE_GEN_TEXTURES,
+	GL_TRACE_ACTIVE_TEXTURE,
+	GL_TRACE_BIND_TEXTURE,
+	GL_TRACE_TEX_IMAGE_2D,
+	GL_TRACE_TEX_PARAMETER_I,
+	GL_TRACE_GENERATE_MIPMAP,
+	GL_TRACE_DELETE_TEXTURES,
+	GL_TRACE_CREATE_PROGRAM,
+	GL_TRACE_CREATE_SHADER,
+	GL_TRACE_SHADER_SOURCE,
+	GL_TRACE_COMPILE_SHADER,
+	GL_TRACE_ATTACH_SHADER,
+	GL_TRACE_DELETE_SHADER,
+	GL_TRACE_LINK_PROGRAM,
+	GL_TRACE_VALIDATE_PROGRAM,
+	GL_TRACE_USE_PROGRAM,
+	GL_TRACE_DELETE_PROGRAM,
+	GL_TRACE_GET_UNIFORM_LOCATION,
+	GL_TRACE_UNIFORM_1F,
+	GL_TRACE_UNIFORM_3F,
+	GL_TRACE_UNIFORM_MATRIX_4FV,
+	GL_TRACE_GEN_FRAMEBUFFERS,
+	GL_TRACE_BIND_FRAMEBUFFER,
+	GL_TRACE_FRAMEBUFFER_RENDERBUFFER,
+	GL_TRACE_DELETE_FRAMEBUFFERS,
+	GL_TRACE_GEN_RENDERBUFFERS,
+	GL_TRACE_BIND_RENDERBUFFER,
+	GL_TRACE_RENDERBUFFER_STORAGE,
+	GL_TRACE_DELETE_RENDERBUFFERS,
+	GL_TRACE_CLEAR_COLOR,
+	GL_TRACE_CLEAR,
+
+	// counted but never written to a trace, replaying them has no effect on the frame
+	GL_TRACE_GET_SHADER_IV,
+	GL_TRACE_GET_SHADER_INFO_LOG,
+	GL_TRACE_GET_PROGRAM_IV,
+	GL_TRACE_GET_PROGRAM_INFO_LOG,
+
+	GL_TRACE_CALL_COUNT,
+	GL_TRACE_FRAME_END = 0xFFFF
+};
+
+constexpr unsigned int GL_TRACE_VERSION = 1;
+
+// call once right after glewInit, before any resources are created
+void InstallGLInterceptor();
+bool IsGLInterceptorInstalled();
+
+// records every following call, creation included, so start it before the scene is loaded
+bool StartGLTrace(const char* fileName);
+void StopGLTrace();
+
+// closes the statistics of the current frame and marks a frame boundary in the trace
+void EndGLFrame();
+const GLFrameStats& GetLastGLFrameStats();
+void PrintGLCallCounts(size_t frameCount); // per entry point totals and per frame averages
+
+const char* GetGLTraceCallName(GLTraceCall call);
+
+void TracedGenTextures(GLsizei n, GLuint* textures);
+void TracedBindTexture(GLenum target, GLuint texture);
+void TracedTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                      GLenum format, GLenum type, const void* pixels);
+void TracedTexParameteri(GLenum target, GLenum name, GLint value);
+void TracedDeleteTextures(GLsizei n, const GLuint* textures);
+void TracedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void TracedClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void TracedClear(GLbitfield mask);
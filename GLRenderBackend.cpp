@@ -0,0 +1,279 @@
+#include "GLRenderBackend.h"
+
+#include "GLInterceptor.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <glm/gtc/type_ptr.hpp>
+
+GLRenderBackend::GLRenderBackend()
+{
+}
+
+GLuint GLRenderBackend::CreateVertexArray(const GLfloat* vertices, size_t vertexFloatCount, const unsigned int* indices, size_t indexCount,
+                                          const unsigned int* attributeSizes, unsigned int attributeCount)
+{
+	constexpr GLsizei NUM_BUFFERS = 1;
+
+	GLuint VAO = 0;
+	VertexArrayBuffers arrayBuffers{ 0, 0 };
+
+	glGenVertexArrays(NUM_BUFFERS, &VAO);
+	glBindVertexArray(VAO);
+
+	glGenBuffers(NUM_BUFFERS, &arrayBuffers.IBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arrayBuffers.IBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * indexCount, indices, GL_STATIC_DRAW);
+
+	glGenBuffers(NUM_BUFFERS, &arrayBuffers.VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, arrayBuffers.VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices[0]) * vertexFloatCount, vertices, GL_STATIC_DRAW);
+
+	GLsizei vertexLength = 0;
+	for (unsigned int i = 0; i < attributeCount; i++)
+	{
+		vertexLength += attributeSizes[i];
+	}
+
+	GLenum type = GL_FLOAT;
+	GLboolean isNormalized = GL_FALSE;
+	GLsizei stride = sizeof(vertices[0]) * vertexLength;
+	size_t offset = 0;
+
+	for (unsigned int i = 0; i < attributeCount; i++)
+	{
+		glVertexAttribPointer(i, attributeSizes[i], type, isNormalized, stride, (void*) (sizeof(vertices[0]) * offset));
+		glEnableVertexAttribArray(i);
+		offset += attributeSizes[i];
+	}
+
+	glBindVertexArray(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	buffers[VAO] = arrayBuffers;
+	return VAO;
+}
+
+void GLRenderBackend::SetIndices(GLuint vertexArray, const unsigned int* indices, size_t indexCount)
+{
+	// the element buffer binding is part of the VAO state
+	glBindVertexArray(vertexArray);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[vertexArray].IBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * indexCount, indices, GL_STATIC_DRAW);
+	glBindVertexArray(0);
+}
+
+void GLRenderBackend::UpdateIndices(GLuint vertexArray, size_t firstIndex, const unsigned int* indices, size_t indexCount)
+{
+	glBindVertexArray(vertexArray);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[vertexArray].IBO);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * firstIndex, sizeof(indices[0]) * indexCount, indices);
+	glBindVertexArray(0);
+}
+
+void GLRenderBackend::DrawIndexed(GLuint vertexArray, size_t firstIndex, size_t indexCount)
+{
+	glBindVertexArray(vertexArray);
+	TracedDrawElements(GL_TRIANGLES, (GLsizei) indexCount, GL_UNSIGNED_INT, (void*) (sizeof(GLuint) * firstIndex));
+	glBindVertexArray(0);
+}
+
+void GLRenderBackend::DrawIndexedRanges(GLuint vertexArray, const GLsizei* indexCounts, const void* const* byteOffsets, GLsizei rangeCount)
+{
+	glBindVertexArray(vertexArray);
+	glMultiDrawElements(GL_TRIANGLES, indexCounts, GL_UNSIGNED_INT, byteOffsets, rangeCount);
+	glBindVertexArray(0);
+}
+
+void GLRenderBackend::DestroyVertexArray(GLuint vertexArray)
+{
+	constexpr int NUM_BUFFERS_TO_DELETE = 1;
+
+	auto found = buffers.find(vertexArray);
+	if (found != buffers.end())
+	{
+		// delete index and vertex buffer objects from graphics card memory
+		glDeleteBuffers(NUM_BUFFERS_TO_DELETE, &found->second.IBO);
+		glDeleteBuffers(NUM_BUFFERS_TO_DELETE, &found->second.VBO);
+		buffers.erase(found);
+	}
+
+	glDeleteVertexArrays(NUM_BUFFERS_TO_DELETE, &vertexArray);
+}
+
+GLuint GLRenderBackend::CreateTexture(int width, int height, const unsigned char* rgba)
+{
+	const GLint textureIndex = 0;
+
+	const GLint numTextures = 1;
+	const GLenum textureType = GL_TEXTURE_2D;
+	const GLint mipMapLevel = 0;
+	const GLenum internalFormat = GL_RGBA;
+	const GLint border = 0;
+	const GLenum format = GL_RGBA;
+	const GLenum type = GL_UNSIGNED_BYTE;
+
+	GLuint textureID = 0;
+	TracedGenTextures(numTextures, &textureID);
+	TracedBindTexture(textureType, textureID);
+
+	GLint edgeHandling = GL_MIRRORED_REPEAT;
+	GLenum filterType = GL_NEAREST;
+
+	// s and t axis wrap behavior
+	TracedTexParameteri(textureType, GL_TEXTURE_WRAP_S, edgeHandling);
+	TracedTexParameteri(textureType, GL_TEXTURE_WRAP_T, edgeHandling);
+
+	TracedTexParameteri(textureType, GL_TEXTURE_MIN_FILTER, filterType);
+	TracedTexParameteri(textureType, GL_TEXTURE_MAG_FILTER, filterType);
+
+	TracedTexImage2D(textureType, mipMapLevel, internalFormat, width, height, border, format, type, rgba);
+
+	glGenerateMipmap(textureType);
+
+	TracedBindTexture(textureType, textureIndex);
+
+	return textureID;
+}
+
+void GLRenderBackend::BindTexture(GLuint texture, unsigned int unit)
+{
+	glActiveTexture(GL_TEXTURE0 + unit); // sampler accesses texture through texture unit
+	TracedBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLRenderBackend::DestroyTexture(GLuint texture)
+{
+	const GLint numTextures = 1;
+
+	TracedDeleteTextures(numTextures, &texture);
+}
+
+GLuint GLRenderBackend::CreateProgram(const char* vertexCode, const char* fragmentCode)
+{
+	GLuint shaderID = glCreateProgram(); // Create shader program
+
+	if (!shaderID)  // If shader program creation failed
+	{
+		printf("Shader program creation failed!\n");
+		return 0;
+	}
+
+	if (!AddShader(shaderID, vertexCode, GL_VERTEX_SHADER) ||    // Add vertex shader
+	    !AddShader(shaderID, fragmentCode, GL_FRAGMENT_SHADER))  // Add fragment shader
+	{
+		glDeleteProgram(shaderID);
+		return 0;
+	}
+
+	const int logLength = 1024;
+	GLint result = 0;               // Compilation result
+	GLchar eLog[logLength] = { 0 }; // Error log buffer
+	GLsizei* infoLogLength = NULL;
+
+	glLinkProgram(shaderID); // Link the shader program; create executables on graphics card to link program together
+	glGetProgramiv(shaderID, GL_LINK_STATUS, &result); // Get link status
+
+	if (!result)  // Linking failed
+	{
+		glGetProgramInfoLog(shaderID, logLength, infoLogLength, eLog);
+		printf("Error linking program: '%s'\n", eLog);
+		glDeleteProgram(shaderID);
+		return 0;
+	}
+	glValidateProgram(shaderID); // Validate the shader program
+	glGetProgramiv(shaderID, GL_VALIDATE_STATUS, &result); // Get validation status
+
+	if (!result)
+	{
+		glGetProgramInfoLog(shaderID, logLength, infoLogLength, eLog);
+		printf("Error validating program: '%s'\n", eLog);
+		glDeleteProgram(shaderID);
+		return 0;
+	}
+
+	return shaderID;
+}
+
+bool GLRenderBackend::AddShader(GLuint theProgram, const char* shaderCode, GLenum shaderType)
+{
+	GLuint theShader = glCreateShader(shaderType); // Create shader object
+
+	if (!theShader)  // If shader object creation failed
+	{
+		printf("Error creating shader type %d\n", shaderType);
+		return false;
+	}
+
+	const GLchar* theCode[1];
+	theCode[0] = shaderCode;
+	GLint codeLength[1];
+	codeLength[0] = (GLint) strlen(shaderCode);
+
+	glShaderSource(theShader, 1, theCode, codeLength); // Set the source code in the shader object
+	glCompileShader(theShader); // Compile the shader
+
+	const int logLength = 1024;
+	GLint result = 0;               // Compilation result
+	GLchar eLog[logLength] = { 0 };      // Error log buffer
+	GLsizei* infoLogLength = NULL;
+	glGetShaderiv(theShader, GL_COMPILE_STATUS, &result); // Get compilation status
+
+	if (!result)  // Compilation failed
+	{
+		glGetShaderInfoLog(theShader, sizeof(eLog), infoLogLength, eLog);
+		printf("Error compiling the %d shader: '%s'\n", shaderType, eLog);
+		glDeleteShader(theShader);
+		return false;
+	}
+
+	glAttachShader(theProgram, theShader); // Attach the compiled shader to the program
+	glDeleteShader(theShader); // only flagged, it lives as long as the program it is attached to
+
+	return true;
+}
+
+GLuint GLRenderBackend::GetUniformLocation(GLuint program, const char* name)
+{
+	return glGetUniformLocation(program, name);
+}
+
+void GLRenderBackend::UseProgram(GLuint program)
+{
+	glUseProgram(program); // Set the current active shader program to this program
+}
+
+void GLRenderBackend::DestroyProgram(GLuint program)
+{
+	glDeleteProgram(program); // Delete the shader program from graphics card memory
+}
+
+void GLRenderBackend::SetUniform(GLuint location, GLfloat value)
+{
+	glUniform1f(location, value);
+}
+
+void GLRenderBackend::SetUniform(GLuint location, const glm::vec3& value)
+{
+	glUniform3f(location, value.x, value.y, value.z);
+}
+
+void GLRenderBackend::SetUniform(GLuint location, const glm::mat4& value)
+{
+	const GLint MATRIX_COUNT = 1;
+	GLboolean TO_TRANSPOSE = GL_FALSE; // Whether to transpose matrix
+
+	glUniformMatrix4fv(location, MATRIX_COUNT, TO_TRANSPOSE, glm::value_ptr(value));
+}
+
+void GLRenderBackend::Clear(const glm::vec4& color)
+{
+	TracedClearColor(color.r, color.g, color.b, color.a);
+	TracedClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+GLRenderBackend::~GLRenderBackend()
+{
+}
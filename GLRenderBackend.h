@@ -0,0 +1,49 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "RenderBackend.h"
+
+// RenderBackend that issues the GL calls directly on the current context
+class GLRenderBackend : public RenderBackend
+{
+public:
+	GLRenderBackend();
+
+	GLuint CreateVertexArray(const GLfloat* vertices, size_t vertexFloatCount, const unsigned int* indices, size_t indexCount,
+	                         const unsigned int* attributeSizes, unsigned int attributeCount) override;
+	void SetIndices(GLuint vertexArray, const unsigned int* indices, size_t indexCount) override;
+	void UpdateIndices(GLuint vertexArray, size_t firstIndex, const unsigned int* indices, size_t indexCount) override;
+	void DrawIndexed(GLuint vertexArray, size_t firstIndex, size_t indexCount) override;
+	void DrawIndexedRanges(GLuint vertexArray, const GLsizei* indexCounts, const void* const* byteOffsets, GLsizei rangeCount) override;
+	void DestroyVertexArray(GLuint vertexArray) override;
+
+	GLuint CreateTexture(int width, int height, const unsigned char* rgba) override;
+	void BindTexture(GLuint texture, unsigned int unit) override;
+	void DestroyTexture(GLuint texture) override;
+
+	GLuint CreateProgram(const char* vertexCode, const char* fragmentCode) override;
+	GLuint GetUniformLocation(GLuint program, const char* name) override;
+	void UseProgram(GLuint program) override;
+	void DestroyProgram(GLuint program) override;
+
+	void SetUniform(GLuint location, GLfloat value) override;
+	void SetUniform(GLuint location, const glm::vec3& value) override;
+	void SetUniform(GLuint location, const glm::mat4& value) override;
+
+	void Clear(const glm::vec4& color) override;
+
+	~GLRenderBackend();
+
+private:
+	struct VertexArrayBuffers
+	{
+		GLuint VBO;
+		GLuint IBO;
+	};
+
+	// buffers owned by each vertex array, deleted together with it
+	std::unordered_map<GLuint, VertexArrayBuffers> buffers;
+
+	bool AddShader(GLuint theProgram, const char* shaderCode, GLenum shaderType);
+};
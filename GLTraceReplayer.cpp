@@ -0,0 +1,510 @@
+#include "GLTraceReplayer.h"
+
+#include <string.h>
+#include <chrono>
+#include <string>
+
+#include "GLInterceptor.h"
+#include "HeadlessContext.h"
+#include "OffscreenTarget.h"
+#include "ImageWriter.h"
+#include "Benchmark.h"
+
+namespace
+{
+	// traced name to replay name, 0 stays 0
+	GLuint MapName(const std::unordered_map<GLuint, GLuint>& names, GLuint name)
+	{
+		auto found = names.find(name);
+		return found != names.end() ? found->second : 0;
+	}
+
+	const void* Offset(uint64_t offset)
+	{
+		return (const void*) (uintptr_t) offset;
+	}
+}
+
+GLTraceReplayer::GLTraceReplayer()
+{
+	cursor = 0;
+	truncated = false;
+	width = 0;
+	height = 0;
+	targetFramebuffer = 0;
+	currentProgram = 0;
+}
+
+int GLTraceReplayer::Load(const char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
+	{
+		printf("Failed to open GL trace %s\n", fileName);
+		return 1;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	trace.resize(size > 0 ? (size_t) size : 0);
+	size_t read = fread(trace.data(), 1, trace.size(), file);
+	fclose(file);
+
+	if (read != trace.size())
+	{
+		printf("Failed to read GL trace %s\n", fileName);
+		return 1;
+	}
+
+	cursor = 0;
+	truncated = false;
+
+	const unsigned char* magic = ReadBytes(4);
+	uint32_t version = Read<uint32_t>();
+	width = Read<int32_t>();
+	height = Read<int32_t>();
+
+	if (truncated || memcmp(magic, "GLTR", 4) != 0)
+	{
+		printf("%s is not a GL trace\n", fileName);
+		return 1;
+	}
+
+	if (version != GL_TRACE_VERSION)
+	{
+		printf("GL trace version %u is not supported, expected %u\n", version, GL_TRACE_VERSION);
+		return 1;
+	}
+
+	if (width <= 0 || height <= 0)
+	{
+		printf("GL trace has no viewport size\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+int GLTraceReplayer::Replay(const char* dumpDirectory)
+{
+	HeadlessContext context;
+	OffscreenTarget target;
+
+	if (context.Initialize() != 0 || target.Create(width, height) != 0)
+	{
+		return 1;
+	}
+
+	target.Bind();
+	targetFramebuffer = target.getFramebuffer();
+
+	std::vector<double> frameTimes;
+	std::vector<unsigned char> framePixels;
+	int frameIndex = 0;
+	auto frameStart = std::chrono::steady_clock::now();
+
+	while (cursor < trace.size())
+	{
+		unsigned short call = Read<uint16_t>();
+
+		if (call == GL_TRACE_FRAME_END)
+		{
+			glFinish();
+			frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+			if (dumpDirectory)
+			{
+				char framePath[512];
+				snprintf(framePath, sizeof(framePath), "%s/frame_%04d.png", dumpDirectory, frameIndex);
+				target.ReadPixels(framePixels);
+				WritePNG(framePath, width, height, framePixels.data(), true);
+			}
+
+			frameIndex++;
+			frameStart = std::chrono::steady_clock::now();
+			continue;
+		}
+
+		if (ReplayCall(call) != 0 || truncated)
+		{
+			printf("GL trace is corrupt at byte %zu (call %u)\n", cursor, call);
+			return 1;
+		}
+	}
+
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR)
+	{
+		printf("GL error 0x%x during replay\n", error);
+	}
+
+	if (frameTimes.empty())
+	{
+		printf("GL trace contains no frames\n");
+		return 1;
+	}
+
+	// the first frame also creates every resource, so it is kept out of the percentiles
+	printf("Replayed %zu frames at %dx%d, first frame %.3f ms\n", frameTimes.size(), width, height, frameTimes[0]);
+	if (frameTimes.size() > 1)
+	{
+		PrintFrameTimes(std::vector<double>(frameTimes.begin() + 1, frameTimes.end()));
+	}
+
+	return error == GL_NO_ERROR ? 0 : 1;
+}
+
+template <typename T>
+T GLTraceReplayer::Read()
+{
+	T value{};
+	const unsigned char* bytes = ReadBytes(sizeof(T));
+	if (bytes)
+	{
+		memcpy(&value, bytes, sizeof(T));
+	}
+	return value;
+}
+
+const unsigned char* GLTraceReplayer::ReadBytes(size_t size)
+{
+	if (truncated || size > trace.size() - cursor)
+	{
+		truncated = true;
+		cursor = trace.size();
+		return nullptr;
+	}
+
+	const unsigned char* bytes = trace.data() + cursor;
+	cursor += size;
+	return bytes;
+}
+
+const unsigned char* GLTraceReplayer::ReadBlob(uint32_t& size)
+{
+	size = Read<uint32_t>();
+	return size > 0 ? ReadBytes(size) : nullptr;
+}
+
+GLuint GLTraceReplayer::MapFramebuffer(GLuint framebuffer) const
+{
+	// the window, or a framebuffer created before tracing started, becomes the replay target
+	GLuint mapped = MapName(framebuffers, framebuffer);
+	return mapped != 0 ? mapped : targetFramebuffer;
+}
+
+GLint GLTraceReplayer::MapUniform(GLint location) const
+{
+	auto found = uniformLocations.find((uint64_t) currentProgram << 32 | (uint32_t) location);
+	return found != uniformLocations.end() ? found->second : -1;
+}
+
+void GLTraceReplayer::ReplayGen(std::unordered_map<GLuint, GLuint>& names, void (GLAPIENTRY *gen)(GLsizei, GLuint*))
+{
+	GLsizei n = Read<GLsizei>();
+	const unsigned char* traced = ReadBytes(sizeof(GLuint) * (n > 0 ? n : 0));
+	if (!traced || n <= 0)
+	{
+		return;
+	}
+
+	std::vector<GLuint> created(n);
+	gen(n, created.data());
+
+	for (GLsizei i = 0; i < n; i++)
+	{
+		GLuint name;
+		memcpy(&name, traced + sizeof(GLuint) * i, sizeof(GLuint));
+		names[name] = created[i];
+	}
+}
+
+void GLTraceReplayer::ReplayDelete(std::unordered_map<GLuint, GLuint>& names, void (GLAPIENTRY *del)(GLsizei, const GLuint*))
+{
+	GLsizei n = Read<GLsizei>();
+	const unsigned char* traced = ReadBytes(sizeof(GLuint) * (n > 0 ? n : 0));
+	if (!traced || n <= 0)
+	{
+		return;
+	}
+
+	std::vector<GLuint> deleted;
+	for (GLsizei i = 0; i < n; i++)
+	{
+		GLuint name;
+		memcpy(&name, traced + sizeof(GLuint) * i, sizeof(GLuint));
+
+		auto found = names.find(name);
+		if (found != names.end())
+		{
+			deleted.push_back(found->second);
+			names.erase(found);
+		}
+	}
+
+	if (!deleted.empty())
+	{
+		del((GLsizei) deleted.size(), deleted.data());
+	}
+}
+
+int GLTraceReplayer::ReplayCall(unsigned short call)
+{
+	constexpr size_t MATRIX_FLOATS = 16;
+
+	switch (call)
+	{
+	case GL_TRACE_GEN_VERTEX_ARRAYS: ReplayGen(vertexArrays, glGenVertexArrays); break;
+	case GL_TRACE_BIND_VERTEX_ARRAY: glBindVertexArray(MapName(vertexArrays, Read<GLuint>())); break;
+	case GL_TRACE_DELETE_VERTEX_ARRAYS: ReplayDelete(vertexArrays, glDeleteVertexArrays); break;
+	case GL_TRACE_GEN_BUFFERS: ReplayGen(buffers, glGenBuffers); break;
+	case GL_TRACE_BIND_BUFFER:
+	{
+		GLenum target = Read<GLenum>();
+		glBindBuffer(target, MapName(buffers, Read<GLuint>()));
+		break;
+	}
+	case GL_TRACE_BUFFER_DATA:
+	{
+		GLenum target = Read<GLenum>();
+		GLenum usage = Read<GLenum>();
+		uint64_t size = Read<uint64_t>();
+		uint32_t dataSize;
+		const unsigned char* data = ReadBlob(dataSize);
+		glBufferData(target, (GLsizeiptr) size, data, usage);
+		break;
+	}
+	case GL_TRACE_BUFFER_SUB_DATA:
+	{
+		GLenum target = Read<GLenum>();
+		uint64_t offset = Read<uint64_t>();
+		uint32_t size;
+		const unsigned char* data = ReadBlob(size);
+		glBufferSubData(target, (GLintptr) offset, size, data);
+		break;
+	}
+	case GL_TRACE_DELETE_BUFFERS: ReplayDelete(buffers, glDeleteBuffers); break;
+	case GL_TRACE_VERTEX_ATTRIB_POINTER:
+	{
+		GLuint index = Read<GLuint>();
+		GLint size = Read<GLint>();
+		GLenum type = Read<GLenum>();
+		GLboolean normalized = Read<GLboolean>();
+		GLsizei stride = Read<GLsizei>();
+		glVertexAttribPointer(index, size, type, normalized, stride, Offset(Read<uint64_t>()));
+		break;
+	}
+	case GL_TRACE_ENABLE_VERTEX_ATTRIB_ARRAY: glEnableVertexAttribArray(Read<GLuint>()); break;
+	case GL_TRACE_DRAW_ELEMENTS:
+	{
+		GLenum mode = Read<GLenum>();
+		GLsizei count = Read<GLsizei>();
+		GLenum type = Read<GLenum>();
+		glDrawElements(mode, count, type, Offset(Read<uint64_t>()));
+		break;
+	}
+	case GL_TRACE_MULTI_DRAW_ELEMENTS:
+	{
+		GLenum mode = Read<GLenum>();
+		GLenum type = Read<GLenum>();
+		GLsizei drawCount = Read<GLsizei>();
+		if (drawCount < 0)
+		{
+			return 1;
+		}
+
+		std::vector<GLsizei> counts(drawCount);
+		std::vector<const void*> offsets(drawCount);
+		for (GLsizei i = 0; i < drawCount; i++)
+		{
+			counts[i] = Read<GLsizei>();
+		}
+		for (GLsizei i = 0; i < drawCount; i++)
+		{
+			offsets[i] = Offset(Read<uint64_t>());
+		}
+
+		if (!truncated)
+		{
+			glMultiDrawElements(mode, counts.data(), type, offsets.data(), drawCount);
+		}
+		break;
+	}
+	case GL_TRACE_GEN_TEXTURES: ReplayGen(textures, glGenTextures); break;
+	case GL_TRACE_ACTIVE_TEXTURE: glActiveTexture(Read<GLenum>()); break;
+	case GL_TRACE_BIND_TEXTURE:
+	{
+		GLenum target = Read<GLenum>();
+		glBindTexture(target, MapName(textures, Read<GLuint>()));
+		break;
+	}
+	case GL_TRACE_TEX_IMAGE_2D:
+	{
+		GLenum target = Read<GLenum>();
+		GLint level = Read<GLint>();
+		GLint internalFormat = Read<GLint>();
+		GLsizei texWidth = Read<GLsizei>();
+		GLsizei texHeight = Read<GLsizei>();
+		GLint border = Read<GLint>();
+		GLenum format = Read<GLenum>();
+		GLenum type = Read<GLenum>();
+		uint32_t size;
+		const unsigned char* pixels = ReadBlob(size);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexImage2D(target, level, internalFormat, texWidth, texHeight, border, format, type, pixels);
+		break;
+	}
+	case GL_TRACE_TEX_PARAMETER_I:
+	{
+		GLenum target = Read<GLenum>();
+		GLenum name = Read<GLenum>();
+		glTexParameteri(target, name, Read<GLint>());
+		break;
+	}
+	case GL_TRACE_GENERATE_MIPMAP: glGenerateMipmap(Read<GLenum>()); break;
+	case GL_TRACE_DELETE_TEXTURES: ReplayDelete(textures, glDeleteTextures); break;
+	case GL_TRACE_CREATE_PROGRAM: programs[Read<GLuint>()] = glCreateProgram(); break;
+	case GL_TRACE_CREATE_SHADER:
+	{
+		GLenum type = Read<GLenum>();
+		shaders[Read<GLuint>()] = glCreateShader(type);
+		break;
+	}
+	case GL_TRACE_SHADER_SOURCE:
+	{
+		GLuint shader = MapName(shaders, Read<GLuint>());
+		uint32_t size;
+		const GLchar* source = (const GLchar*) ReadBlob(size);
+		GLint length = (GLint) size;
+		glShaderSource(shader, 1, &source, &length);
+		break;
+	}
+	case GL_TRACE_COMPILE_SHADER: glCompileShader(MapName(shaders, Read<GLuint>())); break;
+	case GL_TRACE_ATTACH_SHADER:
+	{
+		GLuint program = MapName(programs, Read<GLuint>());
+		glAttachShader(program, MapName(shaders, Read<GLuint>()));
+		break;
+	}
+	case GL_TRACE_DELETE_SHADER:
+	{
+		GLuint traced = Read<GLuint>();
+		glDeleteShader(MapName(shaders, traced));
+		shaders.erase(traced);
+		break;
+	}
+	case GL_TRACE_LINK_PROGRAM: glLinkProgram(MapName(programs, Read<GLuint>())); break;
+	case GL_TRACE_VALIDATE_PROGRAM: glValidateProgram(MapName(programs, Read<GLuint>())); break;
+	case GL_TRACE_USE_PROGRAM:
+		currentProgram = Read<GLuint>();
+		glUseProgram(MapName(programs, currentProgram));
+		break;
+	case GL_TRACE_DELETE_PROGRAM:
+	{
+		GLuint traced = Read<GLuint>();
+		glDeleteProgram(MapName(programs, traced));
+		programs.erase(traced);
+		break;
+	}
+	case GL_TRACE_GET_UNIFORM_LOCATION:
+	{
+		GLuint program = Read<GLuint>();
+		uint32_t size;
+		const unsigned char* name = ReadBlob(size);
+		GLint location = Read<GLint>();
+
+		std::string uniformName(name ? (const char*) name : "", size);
+		uniformLocations[(uint64_t) program << 32 | (uint32_t) location] = glGetUniformLocation(MapName(programs, program), uniformName.c_str());
+		break;
+	}
+	case GL_TRACE_UNIFORM_1F:
+	{
+		GLint location = MapUniform(Read<GLint>());
+		glUniform1f(location, Read<GLfloat>());
+		break;
+	}
+	case GL_TRACE_UNIFORM_3F:
+	{
+		GLint location = MapUniform(Read<GLint>());
+		GLfloat v0 = Read<GLfloat>();
+		GLfloat v1 = Read<GLfloat>();
+		GLfloat v2 = Read<GLfloat>();
+		glUniform3f(location, v0, v1, v2);
+		break;
+	}
+	case GL_TRACE_UNIFORM_MATRIX_4FV:
+	{
+		GLint location = MapUniform(Read<GLint>());
+		GLsizei count = Read<GLsizei>();
+		GLboolean transpose = Read<GLboolean>();
+		const unsigned char* value = ReadBytes(sizeof(GLfloat) * MATRIX_FLOATS * (count > 0 ? count : 0));
+		if (value)
+		{
+			std::vector<GLfloat> matrices(MATRIX_FLOATS * count);
+			memcpy(matrices.data(), value, sizeof(GLfloat) * matrices.size());
+			glUniformMatrix4fv(location, count, transpose, matrices.data());
+		}
+		break;
+	}
+	case GL_TRACE_GEN_FRAMEBUFFERS: ReplayGen(framebuffers, glGenFramebuffers); break;
+	case GL_TRACE_BIND_FRAMEBUFFER:
+	{
+		GLenum target = Read<GLenum>();
+		glBindFramebuffer(target, MapFramebuffer(Read<GLuint>()));
+		break;
+	}
+	case GL_TRACE_FRAMEBUFFER_RENDERBUFFER:
+	{
+		GLenum target = Read<GLenum>();
+		GLenum attachment = Read<GLenum>();
+		GLenum renderbufferTarget = Read<GLenum>();
+		GLuint renderbuffer = MapName(renderbuffers, Read<GLuint>());
+
+		// never rewire the replay target itself
+		GLint bound = 0;
+		glGetIntegerv(target == GL_READ_FRAMEBUFFER ? GL_READ_FRAMEBUFFER_BINDING : GL_DRAW_FRAMEBUFFER_BINDING, &bound);
+		if ((GLuint) bound != targetFramebuffer)
+		{
+			glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+		}
+		break;
+	}
+	case GL_TRACE_DELETE_FRAMEBUFFERS: ReplayDelete(framebuffers, glDeleteFramebuffers); break;
+	case GL_TRACE_GEN_RENDERBUFFERS: ReplayGen(renderbuffers, glGenRenderbuffers); break;
+	case GL_TRACE_BIND_RENDERBUFFER:
+	{
+		GLenum target = Read<GLenum>();
+		glBindRenderbuffer(target, MapName(renderbuffers, Read<GLuint>()));
+		break;
+	}
+	case GL_TRACE_RENDERBUFFER_STORAGE:
+	{
+		GLenum target = Read<GLenum>();
+		GLenum internalFormat = Read<GLenum>();
+		GLsizei storageWidth = Read<GLsizei>();
+		GLsizei storageHeight = Read<GLsizei>();
+		glRenderbufferStorage(target, internalFormat, storageWidth, storageHeight);
+		break;
+	}
+	case GL_TRACE_DELETE_RENDERBUFFERS: ReplayDelete(renderbuffers, glDeleteRenderbuffers); break;
+	case GL_TRACE_CLEAR_COLOR:
+	{
+		GLfloat red = Read<GLfloat>();
+		GLfloat green = Read<GLfloat>();
+		GLfloat blue = Read<GLfloat>();
+		glClearColor(red, green, blue, Read<GLfloat>());
+		break;
+	}
+	case GL_TRACE_CLEAR: glClear(Read<GLbitfield>()); break;
+	default:
+		return 1;
+	}
+
+	return 0;
+}
+
+GLTraceReplayer::~GLTraceReplayer()
+{
+}
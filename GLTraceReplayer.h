@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+#include <GL/glew.h>
+
+// Plays a trace written by StartGLTrace back into a headless context, without the engine.
+// Object names and uniform locations are remapped to the ones the replaying driver hands out
+// and the default framebuffer is redirected to an offscreen target of the traced viewport size,
+// so the same frames can be timed on another driver or machine.
+class GLTraceReplayer
+{
+public:
+	GLTraceReplayer();
+
+	int Load(const char* fileName);
+	int Replay(const char* dumpDirectory); // writes frame_NNNN.png per frame when dumpDirectory is set
+
+	~GLTraceReplayer();
+
+private:
+	std::vector<unsigned char> trace;
+	size_t cursor;
+	bool truncated;
+	GLint width, height;
+
+	GLuint targetFramebuffer;
+	GLuint currentProgram; // traced name, needed to look up uniform locations
+
+	std::unordered_map<GLuint, GLuint> vertexArrays;
+	std::unordered_map<GLuint, GLuint> buffers;
+	std::unordered_map<GLuint, GLuint> textures;
+	std::unordered_map<GLuint, GLuint> shaders;
+	std::unordered_map<GLuint, GLuint> programs;
+	std::unordered_map<GLuint, GLuint> framebuffers;
+	std::unordered_map<GLuint, GLuint> renderbuffers;
+	std::unordered_map<uint64_t, GLint> uniformLocations; // traced program << 32 | traced location
+
+	template <typename T>
+	T Read();
+	const unsigned char* ReadBytes(size_t size);
+	const unsigned char* ReadBlob(uint32_t& size);
+
+	int ReplayCall(unsigned short call);
+
+	GLuint MapFramebuffer(GLuint framebuffer) const;
+	GLint MapUniform(GLint location) const;
+	void ReplayGen(std::unordered_map<GLuint, GLuint>& names, void (GLAPIENTRY *gen)(GLsizei, GLuint*));
+	void ReplayDelete(std::unordered_map<GLuint, GLuint>& names, void (GLAPIENTRY *del)(GLsizei, const GLuint*));
+};
@@ -15,8 +15,12 @@ GLWindow::GLWindow(GLint windowWidth, GLint windowHeight)
 	bufferWidth = 0;
 	bufferHeight = 0;
 
-	xChange = 0.0f;
-	yChange = 0.0f;
+	lastX = 0.0;
+	lastY = 0.0;
+	totalMouseX = 0.0;
+	totalMouseY = 0.0;
+	unsentX = 0.0f;
+	unsentY = 0.0f;
 
 	for (size_t i = 0; i < MAX_KEYS; i++)
 	{
@@ -65,6 +69,12 @@ int GLWindow::Initialize()
 	createCallbacks();
 	glfwSetInputMode(mainWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED); // Disable mouse cursor (lock cursor to window)
 
+	// unaccelerated, unscaled motion where the platform has it, better for looking around
+	if (glfwRawMouseMotionSupported())
+	{
+		glfwSetInputMode(mainWindow, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+	}
+
 	// Initialize GLEW
 	if (glewInit() != GLEW_OK)
 	{
@@ -87,21 +97,27 @@ int GLWindow::Initialize()
 void GLWindow::createCallbacks()
 {
 	glfwSetKeyCallback(mainWindow, handleKeys); // Set the key callback function
+	glfwSetMouseButtonCallback(mainWindow, handleMouseButtons);
 	glfwSetCursorPosCallback(mainWindow, handleMouse); // Set the mouse position callback function
 }
 
-GLfloat GLWindow::getXChange()
+int GLWindow::setSwapInterval(int interval)
 {
-	GLfloat theChange = xChange;
-	xChange = 0.0f; // reset change to 0
-	return theChange;
+	if (interval < 0 && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+	{
+		printf("Adaptive vsync is not supported, using vsync\n");
+		interval = 1;
+	}
+
+	glfwSwapInterval(interval);
+	return interval;
 }
 
-GLfloat GLWindow::getYChange()
+int GLWindow::getRefreshRate()
 {
-	GLfloat theChange = yChange;
-	yChange = 0.0f; // reset change to 0
-	return theChange;
+	GLFWmonitor* monitor = glfwGetWindowMonitor(mainWindow);
+	const GLFWvidmode* mode = glfwGetVideoMode(monitor ? monitor : glfwGetPrimaryMonitor());
+	return mode ? mode->refreshRate : 60;
 }
 
 void GLWindow::handleKeys(GLFWwindow* window, int key, int code, int action, int mode)
@@ -113,6 +129,8 @@ void GLWindow::handleKeys(GLFWwindow* window, int key, int code, int action, int
 		glfwSetWindowShouldClose(window, GL_TRUE); // Close window if escape is pressed
 	}
 
+	theWindow->inputEvents.Push(InputEvent{ INPUT_KEY, key, action, 0.0f, 0.0f, std::chrono::steady_clock::now() });
+
 	if (key >= 0 && key < MAX_KEYS)
 	{
 		if (action == GLFW_PRESS)
@@ -136,28 +154,51 @@ void GLWindow::handleKeys(GLFWwindow* window, int key, int code, int action, int
 
 }
 
+void GLWindow::handleMouseButtons(GLFWwindow* window, int button, int action, int mods)
+{
+	GLWindow* theWindow = static_cast<GLWindow*>(glfwGetWindowUserPointer(window));
+	theWindow->inputEvents.Push(InputEvent{ INPUT_MOUSE_BUTTON, button, action, 0.0f, 0.0f, std::chrono::steady_clock::now() });
+}
+
 void GLWindow::handleMouse(GLFWwindow* window, double xPos, double yPos)
 {
 	GLWindow* theWindow = static_cast<GLWindow*>(glfwGetWindowUserPointer(window));
 
 	if (theWindow->mouseFirstMoved) // if mouse moved for the first time
 	{
-		theWindow->lastX = (GLfloat) xPos;
-		theWindow->lastY = (GLfloat) yPos;
+		theWindow->lastX = xPos;
+		theWindow->lastY = yPos;
 		theWindow->mouseFirstMoved = false;
 	}
-	theWindow->xChange = (GLfloat) xPos - theWindow->lastX; // change in x
-	theWindow->yChange = theWindow->lastY - (GLfloat) yPos; // change in y
-	theWindow->lastX = (GLfloat) xPos; // set lastX to current x position
-	theWindow->lastY = (GLfloat) yPos; // set lastY to current y position
+
+	// one poll can deliver several positions, every step between them goes out as its own event
+	GLfloat xChange = (GLfloat) (xPos - theWindow->lastX); // change in x
+	GLfloat yChange = (GLfloat) (theWindow->lastY - yPos); // change in y
+	theWindow->lastX = xPos; // set lastX to current x position
+	theWindow->lastY = yPos; // set lastY to current y position
+	theWindow->totalMouseX += xChange;
+	theWindow->totalMouseY += yChange;
+
+	theWindow->unsentX += xChange;
+	theWindow->unsentY += yChange;
+	if (theWindow->inputEvents.Push(InputEvent{ INPUT_MOUSE_MOTION, 0, 0, theWindow->unsentX, theWindow->unsentY, std::chrono::steady_clock::now() }))
+	{
+		theWindow->unsentX = 0.0f;
+		theWindow->unsentY = 0.0f;
+	}
+
 	if (verbose)
 	{
-		printf("x: %f, y: %f\n", theWindow->xChange, theWindow->yChange);
+		printf("x: %f, y: %f\n", xChange, yChange);
 	}
 }
 
 GLWindow::~GLWindow()
 {
-	glfwDestroyWindow(mainWindow);
-	glfwTerminate();
+	// headless runs never initialize the window
+	if (mainWindow)
+	{
+		glfwDestroyWindow(mainWindow);
+		glfwTerminate();
+	}
 }
\ No newline at end of file
@@ -5,9 +5,13 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include "InputQueue.h"
+
 class GLWindow
 {
 public:
+	static constexpr int MAX_KEYS = InputState::MAX_KEYS;
+
 	GLWindow();
 	GLWindow(GLint windowWidth, GLint windowHeight);
 
@@ -16,13 +20,23 @@ public:
 	GLint getBufferWidth() { return bufferWidth; }
 	GLint getBufferHeight() { return bufferHeight; }
 	bool getShouldClose() { return glfwWindowShouldClose(mainWindow); }
-	bool* getKeyStates() { return key_states; }
+	bool* getKeyStates() { return key_states; } // for the thread polling events, others drain getInputEvents
+
+	// filled while events are polled, drained by one consumer thread
+	InputEventQueue& getInputEvents() { return inputEvents; }
 
-	GLfloat getXChange();
-	GLfloat getYChange();
+	// all mouse motion seen so far, y up; the consumer's InputState has the part frames have taken
+	double getTotalMouseX() const { return totalMouseX; }
+	double getTotalMouseY() const { return totalMouseY; }
 	
 	void swapBuffers() { glfwSwapBuffers(mainWindow); }
 
+	// 0 off, 1 vsync, -1 adaptive vsync (a late frame tears instead of waiting for the next refresh),
+	// which falls back to 1 without swap_control_tear; returns the interval set
+	int setSwapInterval(int interval);
+
+	int getRefreshRate(); // Hz of the monitor the window is on, the primary one while windowed
+
 	~GLWindow();
 
 private:
@@ -31,16 +45,19 @@ private:
 	GLint width, height;
 	GLint bufferWidth, bufferHeight;
 
-	static constexpr int MAX_KEYS = 1024;
 	bool key_states[MAX_KEYS];
 
-	GLfloat lastX;
-	GLfloat lastY;
-	GLfloat xChange;
-	GLfloat yChange;
+	InputEventQueue inputEvents;
+	double lastX;
+	double lastY;
+	double totalMouseX;
+	double totalMouseY;
+	GLfloat unsentX; // motion a full queue could not take, sent with the next motion event
+	GLfloat unsentY;
 	bool mouseFirstMoved;
 
 	void createCallbacks();
 	static void handleKeys(GLFWwindow* window, int key, int code, int action, int mode);
+	static void handleMouseButtons(GLFWwindow* window, int button, int action, int mods);
 	static void handleMouse(GLFWwindow* window, double XPos, double yPos);
 };
\ No newline at end of file
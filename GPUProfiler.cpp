@@ -0,0 +1,282 @@
+#include "GPUProfiler.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+	struct FrameQueries
+	{
+		GLuint frameQueries[2];
+		GLuint scopeQueries[GPU_MAX_SCOPES_PER_FRAME * 2];
+		const char* names[GPU_MAX_SCOPES_PER_FRAME];
+		unsigned int scopeCount;
+		bool pending;
+	};
+
+	struct ScopeTotals
+	{
+		const char* name;
+		double totalTime;
+		size_t count;
+	};
+
+	bool active = false;
+	bool frameOpen = false;
+	FrameQueries frames[GPU_QUERY_FRAMES];
+	unsigned int currentFrame = 0;
+
+	double lastFrameTime = 0.0;
+	double totalFrameTime = 0.0;
+	size_t resolvedFrames = 0;
+	size_t droppedFrames = 0;
+	size_t overflowedScopes = 0;
+	std::vector<ScopeTotals> scopeTotals;
+
+#ifdef ENABLE_PROFILER
+	// GPU nanoseconds to ProfilerNow ticks, the rate is measured over the whole run
+	int gpuTrack = -1;
+	GLint64 firstGPUTime = 0;
+	uint64_t firstCPUTime = 0;
+	GLint64 anchorGPUTime = 0;
+	uint64_t anchorCPUTime = 0;
+
+	void SampleClocks()
+	{
+		glGetInteger64v(GL_TIMESTAMP, &anchorGPUTime);
+		anchorCPUTime = ProfilerNow();
+	}
+#endif
+
+	void AddScopeTime(const char* name, double time)
+	{
+		for (ScopeTotals& totals : scopeTotals)
+		{
+			if (totals.name == name || strcmp(totals.name, name) == 0)
+			{
+				totals.totalTime += time;
+				totals.count++;
+				return;
+			}
+		}
+
+		scopeTotals.push_back(ScopeTotals{ name, time, 1 });
+	}
+
+	void Resolve(FrameQueries& frame)
+	{
+		constexpr double NANOSECONDS_PER_MILLISECOND = 1e6;
+
+		if (!frame.pending)
+		{
+			return;
+		}
+
+		frame.pending = false;
+
+		// the frame end query was issued last, so once it is available every other one is too
+		GLint available = 0;
+		glGetQueryObjectiv(frame.frameQueries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			droppedFrames++;
+			return;
+		}
+
+		GLuint64 frameBegin = 0, frameEnd = 0;
+		glGetQueryObjectui64v(frame.frameQueries[0], GL_QUERY_RESULT, &frameBegin);
+		glGetQueryObjectui64v(frame.frameQueries[1], GL_QUERY_RESULT, &frameEnd);
+
+		lastFrameTime = (frameEnd - frameBegin) / NANOSECONDS_PER_MILLISECOND;
+		totalFrameTime += lastFrameTime;
+		resolvedFrames++;
+
+#ifdef ENABLE_PROFILER
+		double ticksPerNanosecond = 0.0;
+		if (anchorGPUTime - firstGPUTime > (GLint64) NANOSECONDS_PER_MILLISECOND)
+		{
+			ticksPerNanosecond = (double) (anchorCPUTime - firstCPUTime) / (double) (anchorGPUTime - firstGPUTime);
+		}
+		auto toCPUTime = [ticksPerNanosecond](GLuint64 gpuTime) {
+			return anchorCPUTime + (uint64_t) (int64_t) ((double) ((GLint64) gpuTime - anchorGPUTime) * ticksPerNanosecond);
+		};
+
+		if (ticksPerNanosecond > 0.0)
+		{
+			ProfilerRecordOnTrack(gpuTrack, "GPU frame", toCPUTime(frameBegin), toCPUTime(frameEnd));
+		}
+#endif
+
+		for (unsigned int i = 0; i < frame.scopeCount; i++)
+		{
+			GLuint64 begin = 0, end = 0;
+			glGetQueryObjectui64v(frame.scopeQueries[i * 2], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame.scopeQueries[i * 2 + 1], GL_QUERY_RESULT, &end);
+
+			AddScopeTime(frame.names[i], (end - begin) / NANOSECONDS_PER_MILLISECOND);
+
+#ifdef ENABLE_PROFILER
+			if (ticksPerNanosecond > 0.0)
+			{
+				ProfilerRecordOnTrack(gpuTrack, frame.names[i], toCPUTime(begin), toCPUTime(end));
+			}
+#endif
+		}
+	}
+}
+
+int GPUProfilerInitialize()
+{
+	if (active)
+	{
+		return 0;
+	}
+
+	if (!glQueryCounter || !glGetQueryObjectui64v || !glGetInteger64v)
+	{
+		printf("GPU timer queries are not supported\n");
+		return 1;
+	}
+
+	GLint timestampBits = 0;
+	glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &timestampBits);
+	if (timestampBits == 0)
+	{
+		printf("GPU timestamps are not supported\n");
+		return 1;
+	}
+
+	for (FrameQueries& frame : frames)
+	{
+		glGenQueries(2, frame.frameQueries);
+		glGenQueries(GPU_MAX_SCOPES_PER_FRAME * 2, frame.scopeQueries);
+		frame.scopeCount = 0;
+		frame.pending = false;
+	}
+
+#ifdef ENABLE_PROFILER
+	if (gpuTrack < 0)
+	{
+		gpuTrack = ProfilerCreateTrack("GPU");
+	}
+	SampleClocks();
+	firstGPUTime = anchorGPUTime;
+	firstCPUTime = anchorCPUTime;
+#endif
+
+	currentFrame = 0;
+	active = true;
+	return 0;
+}
+
+void GPUProfilerShutdown()
+{
+	if (!active)
+	{
+		return;
+	}
+
+	for (FrameQueries& frame : frames)
+	{
+		glDeleteQueries(2, frame.frameQueries);
+		glDeleteQueries(GPU_MAX_SCOPES_PER_FRAME * 2, frame.scopeQueries);
+	}
+
+	active = false;
+	frameOpen = false;
+}
+
+bool IsGPUProfilerActive()
+{
+	return active;
+}
+
+void GPUProfilerBeginFrame()
+{
+	if (!active)
+	{
+		return;
+	}
+
+	glQueryCounter(frames[currentFrame].frameQueries[0], GL_TIMESTAMP);
+	frameOpen = true;
+}
+
+void GPUProfilerEndFrame()
+{
+	if (!active || !frameOpen)
+	{
+		return;
+	}
+
+	FrameQueries& frame = frames[currentFrame];
+	glQueryCounter(frame.frameQueries[1], GL_TIMESTAMP);
+	frame.pending = true;
+	frameOpen = false;
+
+#ifdef ENABLE_PROFILER
+	SampleClocks();
+#endif
+
+	// the oldest frame is reused next, read it back first
+	currentFrame = (currentFrame + 1) % GPU_QUERY_FRAMES;
+	Resolve(frames[currentFrame]);
+	frames[currentFrame].scopeCount = 0;
+}
+
+int GPUProfilerBeginScope(const char* name)
+{
+	if (!frameOpen)
+	{
+		return -1;
+	}
+
+	FrameQueries& frame = frames[currentFrame];
+	if (frame.scopeCount == GPU_MAX_SCOPES_PER_FRAME)
+	{
+		overflowedScopes++;
+		return -1;
+	}
+
+	unsigned int scope = frame.scopeCount++;
+	frame.names[scope] = name;
+	glQueryCounter(frame.scopeQueries[scope * 2], GL_TIMESTAMP);
+	return (int) scope;
+}
+
+void GPUProfilerEndScope(int scope)
+{
+	if (scope < 0 || !frameOpen)
+	{
+		return;
+	}
+
+	glQueryCounter(frames[currentFrame].scopeQueries[scope * 2 + 1], GL_TIMESTAMP);
+}
+
+double GetLastGPUFrameTime()
+{
+	return lastFrameTime;
+}
+
+void PrintGPUTimes()
+{
+	if (resolvedFrames == 0)
+	{
+		printf("No GPU frame times resolved (%zu frames dropped)\n", droppedFrames);
+		return;
+	}
+
+	double frameCount = (double) resolvedFrames;
+	printf("GPU frame: mean %.3f ms over %zu frames, %zu frames not ready in time\n", totalFrameTime / frameCount, resolvedFrames, droppedFrames);
+	for (const ScopeTotals& totals : scopeTotals)
+	{
+		printf("  %-28s %.3f ms per frame (%.1f scopes per frame)\n", totals.name, totals.totalTime / frameCount, totals.count / frameCount);
+	}
+
+	if (overflowedScopes > 0)
+	{
+		printf("  %zu scopes were not timed, more than %u in a frame\n", overflowedScopes, GPU_MAX_SCOPES_PER_FRAME);
+	}
+}
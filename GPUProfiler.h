@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <GL/glew.h>
+
+#include "Profiler.h"
+
+// GPU timings from GL_TIMESTAMP queries. Every scope writes a begin and an end timestamp into the
+// query pool of the current frame; pools are reused GPU_QUERY_FRAMES frames later, by which time the
+// results are normally available and can be read without stalling. Frames whose results are still
+// pending by then are dropped and counted instead of waited on.
+// Resolved scopes are placed on a "GPU" track of the CPU profiler's capture.
+
+constexpr unsigned int GPU_QUERY_FRAMES = 4;
+constexpr unsigned int GPU_MAX_SCOPES_PER_FRAME = 64;
+
+int GPUProfilerInitialize(); // needs a current GL 3.3 context, 1 when timer queries are unsupported
+void GPUProfilerShutdown();
+bool IsGPUProfilerActive();
+
+// bracket all GPU work of a frame, EndFrame also reads back the oldest frame in the ring
+void GPUProfilerBeginFrame();
+void GPUProfilerEndFrame();
+
+int GPUProfilerBeginScope(const char* name); // query pair index, -1 when not recording
+void GPUProfilerEndScope(int scope);
+
+double GetLastGPUFrameTime(); // ms of the most recently resolved frame
+void PrintGPUTimes();         // per scope means over every resolved frame
+
+#ifdef ENABLE_PROFILER
+
+class GPUProfileScope
+{
+public:
+	explicit GPUProfileScope(const char* name) { scope = GPUProfilerBeginScope(name); }
+	~GPUProfileScope() { GPUProfilerEndScope(scope); }
+
+	GPUProfileScope(const GPUProfileScope&) = delete;
+	GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+
+private:
+	int scope;
+};
+
+#define PROFILE_GPU_SCOPE(name) GPUProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__){ name }
+
+#else
+
+#define PROFILE_GPU_SCOPE(name)
+
+#endif
@@ -0,0 +1,313 @@
+#include "Gamepad.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include "Profiler.h"
+
+static_assert(std::is_trivially_copyable<GamepadState>::value, "the poller copies readings word by word");
+
+// global variable to toggle verbose output for gamepad events
+static const bool verbose = false;
+
+GLFWGamepadDevice::GLFWGamepadDevice() : joystick(-1), scanned(false)
+{
+}
+
+bool GLFWGamepadDevice::Read(GamepadState& state)
+{
+	if (joystick >= 0 && !glfwJoystickIsGamepad(joystick))
+	{
+		joystick = -1; // unplugged
+	}
+
+	if (joystick < 0)
+	{
+		auto now = std::chrono::steady_clock::now();
+		if (scanned && std::chrono::duration<double>(now - lastScan).count() < SCAN_INTERVAL)
+		{
+			return false;
+		}
+
+		scanned = true;
+		lastScan = now;
+		for (int candidate = GLFW_JOYSTICK_1; candidate <= GLFW_JOYSTICK_LAST && joystick < 0; candidate++)
+		{
+			if (glfwJoystickIsGamepad(candidate))
+			{
+				joystick = candidate;
+			}
+		}
+
+		if (joystick < 0)
+		{
+			return false;
+		}
+	}
+
+	GLFWgamepadstate gamepad;
+	if (!glfwGetGamepadState(joystick, &gamepad))
+	{
+		joystick = -1;
+		return false;
+	}
+
+	// GLFW's y axes point down and its triggers rest at -1
+	state.connected = true;
+	state.leftX = gamepad.axes[GLFW_GAMEPAD_AXIS_LEFT_X];
+	state.leftY = -gamepad.axes[GLFW_GAMEPAD_AXIS_LEFT_Y];
+	state.rightX = gamepad.axes[GLFW_GAMEPAD_AXIS_RIGHT_X];
+	state.rightY = -gamepad.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y];
+	state.leftTrigger = (gamepad.axes[GLFW_GAMEPAD_AXIS_LEFT_TRIGGER] + 1.0f) * 0.5f;
+	state.rightTrigger = (gamepad.axes[GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER] + 1.0f) * 0.5f;
+
+	state.buttons = 0;
+	for (int button = 0; button <= GLFW_GAMEPAD_BUTTON_LAST; button++)
+	{
+		if (gamepad.buttons[button] == GLFW_PRESS)
+		{
+			state.buttons |= 1u << button;
+		}
+	}
+	return true;
+}
+
+const char* GLFWGamepadDevice::GetName() const
+{
+	const char* name = joystick >= 0 ? glfwGetGamepadName(joystick) : nullptr;
+	return name ? name : "Gamepad";
+}
+
+GLFWGamepadDevice::~GLFWGamepadDevice()
+{
+}
+
+MockGamepadDevice::MockGamepadDevice() : state{}
+{
+}
+
+void MockGamepadDevice::SetState(const GamepadState& newState)
+{
+	std::lock_guard<std::mutex> lock(stateMutex);
+	state = newState;
+}
+
+bool MockGamepadDevice::Read(GamepadState& state)
+{
+	std::lock_guard<std::mutex> lock(stateMutex);
+	if (!this->state.connected)
+	{
+		return false;
+	}
+
+	state = this->state;
+	return true;
+}
+
+MockGamepadDevice::~MockGamepadDevice()
+{
+}
+
+GamepadPoller::GamepadPoller() : device(nullptr), pollPeriod(0), wasConnected(false), running(false), version(0)
+{
+	Publish(GamepadState{});
+}
+
+void GamepadPoller::Start(GamepadDevice* device, double pollRate)
+{
+	Stop();
+
+	this->device = device;
+	pollPeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / pollRate));
+	nextPoll = std::chrono::steady_clock::now();
+
+	if (device->NeedsMainThread())
+	{
+		return;
+	}
+
+	// the first reading is there before Start returns, so a pad that is already connected counts from the first frame
+	Poll();
+
+	running = true;
+	pollThread = std::thread([this]() {
+		PROFILE_THREAD_NAME("Gamepad");
+
+		while (running.load())
+		{
+			Poll();
+			nextPoll = std::max(nextPoll + pollPeriod, std::chrono::steady_clock::now());
+			std::this_thread::sleep_until(nextPoll);
+		}
+	});
+}
+
+void GamepadPoller::Stop()
+{
+	running = false;
+	if (pollThread.joinable())
+	{
+		pollThread.join();
+	}
+	device = nullptr;
+}
+
+void GamepadPoller::PollOnMainThread()
+{
+	if (!device || !device->NeedsMainThread())
+	{
+		return;
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	if (now < nextPoll)
+	{
+		return;
+	}
+
+	Poll();
+
+	// a late call starts the next period from here rather than polling twice to catch up
+	nextPoll = std::max(nextPoll + pollPeriod, now);
+}
+
+void GamepadPoller::Poll()
+{
+	PROFILE_SCOPE("Gamepad poll");
+
+	GamepadState state{};
+	if (!device->Read(state))
+	{
+		state = GamepadState{};
+	}
+	state.time = std::chrono::steady_clock::now();
+
+	if (state.connected != wasConnected)
+	{
+		printf("%s %s\n", device->GetName(), state.connected ? "connected" : "disconnected");
+		wasConnected = state.connected;
+	}
+
+	Publish(state);
+}
+
+void GamepadPoller::Publish(const GamepadState& state)
+{
+	uint32_t words[STATE_WORDS] = {};
+	memcpy(words, &state, sizeof(state));
+
+	uint32_t current = version.load(std::memory_order_relaxed);
+	version.store(current + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release); // the odd version is visible before any word changes
+
+	for (size_t i = 0; i < STATE_WORDS; i++)
+	{
+		stateWords[i].store(words[i], std::memory_order_relaxed);
+	}
+
+	version.store(current + 2, std::memory_order_release);
+}
+
+GamepadState GamepadPoller::GetState() const
+{
+	uint32_t words[STATE_WORDS];
+
+	while (true)
+	{
+		uint32_t before = version.load(std::memory_order_acquire);
+		if (before & 1)
+		{
+			std::this_thread::yield(); // mid publish, a few stores away from done
+			continue;
+		}
+
+		for (size_t i = 0; i < STATE_WORDS; i++)
+		{
+			words[i] = stateWords[i].load(std::memory_order_relaxed);
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire); // the words are read before the version is checked again
+		if (version.load(std::memory_order_relaxed) == before)
+		{
+			break;
+		}
+	}
+
+	GamepadState state;
+	memcpy(&state, words, sizeof(state));
+	return state;
+}
+
+GamepadPoller::~GamepadPoller()
+{
+	Stop();
+}
+
+void ProcessGamepad(const GamepadState& gamepad, Camera& camera, float deltaTime)
+{
+	if (!gamepad.connected)
+	{
+		return;
+	}
+
+	const float STICK_DEADZONE = 0.2f;
+	const float TRIGGER_DEADZONE = 0.2f;
+
+	float LX = gamepad.leftX;
+	float LY = gamepad.leftY;
+	float RX = gamepad.rightX;
+	float RY = gamepad.rightY;
+
+	// Deadzone
+	if (fabs(LX) < STICK_DEADZONE) { LX = 0.0f; }
+	if (fabs(LY) < STICK_DEADZONE) { LY = 0.0f; }
+	if (fabs(RX) < STICK_DEADZONE) { RX = 0.0f; }
+	if (fabs(RY) < STICK_DEADZONE) { RY = 0.0f; }
+
+	// Move position (left stick)
+	glm::vec3 move{ 0.0f };
+	move += camera.getFront() * LY;   // Forward/back
+	move += camera.getRight() * LX;   // Left/right
+
+	// Up/down using triggers
+	float triggerUp = gamepad.rightTrigger;
+	float triggerDown = gamepad.leftTrigger;
+
+	if (triggerUp < TRIGGER_DEADZONE) { triggerUp = 0; }
+	if (triggerDown < TRIGGER_DEADZONE) { triggerDown = 0; }
+
+	if (triggerUp || triggerDown)
+	{
+		move += camera.getUp() * (triggerUp - triggerDown);
+	}
+
+	if (gamepad.IsButtonDown(GLFW_GAMEPAD_BUTTON_A))
+	{
+		if (verbose)
+		{
+			printf("A is being pressed");
+		}
+		move += camera.getUp();
+	}
+
+	if (gamepad.IsButtonDown(GLFW_GAMEPAD_BUTTON_B))
+	{
+		if (verbose)
+		{
+			printf("B is being pressed");
+		}
+		move -= camera.getUp();
+	}
+
+	// Check magnitude threshold to avoid drift
+	if (glm::length(move) > 0.001f)
+	{
+		camera.addPosition(move * deltaTime * camera.getMovementSpeed());
+	}
+
+	// Change looking direction (right stick)
+	camera.mouseControl(RX * camera.getTurnSpeed() * deltaTime, RY * camera.getTurnSpeed() * deltaTime);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "Camera.h"
+
+// Gamepad input on GLFW's gamepad API, which maps every supported controller to one layout. A poller
+// reads the device at a fixed rate and publishes each reading lock-free, so the threads that use it
+// never wait on device I/O, and connecting or disconnecting a pad is picked up while running.
+
+// one reading, before dead zones
+struct GamepadState
+{
+	bool connected;
+	float leftX, leftY;   // -1 to 1, y up
+	float rightX, rightY;
+	float leftTrigger, rightTrigger; // 0 to 1
+	unsigned int buttons; // bit n set while GLFW_GAMEPAD_BUTTON_n is held
+	std::chrono::steady_clock::time_point time;
+
+	bool IsButtonDown(int button) const { return (buttons & (1u << button)) != 0; }
+};
+
+class GamepadDevice
+{
+public:
+	virtual bool Read(GamepadState& state) = 0; // false, and state untouched, while nothing is connected
+	virtual const char* GetName() const = 0;
+
+	// GLFW joystick functions may only be called from the main thread
+	virtual bool NeedsMainThread() const { return false; }
+
+	virtual ~GamepadDevice() {}
+};
+
+// the first joystick GLFW has a gamepad mapping for; GLFW learns about connections from the OS, so
+// reading never probes an empty slot, and while none is connected the slots are scanned once a second
+class GLFWGamepadDevice : public GamepadDevice
+{
+public:
+	GLFWGamepadDevice();
+
+	bool Read(GamepadState& state) override;
+	const char* GetName() const override;
+	bool NeedsMainThread() const override { return true; }
+
+	~GLFWGamepadDevice();
+
+private:
+	static constexpr double SCAN_INTERVAL = 1.0; // seconds
+
+	int joystick; // -1 while none is connected
+	std::chrono::steady_clock::time_point lastScan;
+	bool scanned;
+};
+
+// device that reads back whatever was set last, for testing the gamepad path without hardware
+class MockGamepadDevice : public GamepadDevice
+{
+public:
+	MockGamepadDevice();
+
+	void SetState(const GamepadState& newState); // any thread, connected decides whether Read succeeds
+
+	bool Read(GamepadState& state) override;
+	const char* GetName() const override { return "Mock gamepad"; }
+
+	~MockGamepadDevice();
+
+private:
+	std::mutex stateMutex;
+	GamepadState state;
+};
+
+class GamepadPoller
+{
+public:
+	GamepadPoller();
+
+	// polls on a thread of its own unless the device needs the main thread, which then calls PollOnMainThread
+	void Start(GamepadDevice* device, double pollRate);
+	void Stop();
+
+	// after the events are polled; reads the device if its period has passed, otherwise returns right away
+	void PollOnMainThread();
+
+	GamepadState GetState() const; // the newest reading, from any thread, disconnected before the first
+
+	~GamepadPoller();
+
+private:
+	// the state goes through a sequence lock of plain words: the poller bumps the version to odd, stores
+	// the words and bumps it to even again, and a reader retries when the version was odd or changed
+	static constexpr size_t STATE_WORDS = (sizeof(GamepadState) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+	GamepadDevice* device;
+	std::chrono::steady_clock::duration pollPeriod;
+	std::chrono::steady_clock::time_point nextPoll;
+	bool wasConnected;
+
+	std::thread pollThread;
+	std::atomic<bool> running;
+
+	std::atomic<uint32_t> version;
+	std::atomic<uint32_t> stateWords[STATE_WORDS];
+
+	void Poll();
+	void Publish(const GamepadState& state);
+};
+
+// moves and turns the camera from a reading, does nothing while disconnected
+void ProcessGamepad(const GamepadState& gamepad, Camera& camera, float deltaTime);
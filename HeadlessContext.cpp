@@ -0,0 +1,228 @@
+#include "HeadlessContext.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::HeadlessContext()
+{
+#ifdef _WIN32
+	hiddenWindow = nullptr;
+#else
+	display = EGL_NO_DISPLAY;
+	context = EGL_NO_CONTEXT;
+	surface = EGL_NO_SURFACE;
+#endif
+}
+
+#ifdef _WIN32
+
+int HeadlessContext::Initialize()
+{
+	if (!glfwInit())
+	{
+		printf("GLFW initialization failed!\n");
+		return 1;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	// the default framebuffer is never drawn to, so the window size does not matter
+	hiddenWindow = glfwCreateWindow(1, 1, "Headless", NULL, NULL);
+	if (!hiddenWindow)
+	{
+		printf("Hidden GLFW window creation failed\n");
+		glfwTerminate();
+		return 1;
+	}
+
+	glfwMakeContextCurrent(hiddenWindow);
+
+	if (glewInit() != GLEW_OK)
+	{
+		printf("GLEW initialization failed!\n");
+		Destroy();
+		return 1;
+	}
+
+	glEnable(GL_DEPTH_TEST);
+
+	return 0;
+}
+
+void HeadlessContext::Destroy()
+{
+	if (hiddenWindow)
+	{
+		glfwDestroyWindow(hiddenWindow);
+		glfwTerminate();
+		hiddenWindow = nullptr;
+	}
+}
+
+#else
+
+static bool HasExtension(const char* extensions, const char* name)
+{
+	if (!extensions)
+	{
+		return false;
+	}
+
+	size_t length = strlen(name);
+	for (const char* start = strstr(extensions, name); start; start = strstr(start + length, name))
+	{
+		bool startsWord = start == extensions || start[-1] == ' ';
+		bool endsWord = start[length] == ' ' || start[length] == '\0';
+		if (startsWord && endsWord)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int HeadlessContext::Initialize()
+{
+	// prefer Mesa's surfaceless platform, it needs neither an X server nor a GPU device
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if (HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+	{
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+		{
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+		}
+	}
+
+	if (display == EGL_NO_DISPLAY)
+	{
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	EGLint major = 0;
+	EGLint minor = 0;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		printf("EGL initialization failed! 0x%x\n", eglGetError());
+		return 1;
+	}
+
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		printf("EGL does not support desktop OpenGL\n");
+		Destroy();
+		return 1;
+	}
+
+	bool surfaceless = HasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		printf("No suitable EGL config found\n");
+		Destroy();
+		return 1;
+	}
+
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (context == EGL_NO_CONTEXT)
+	{
+		printf("EGL context creation failed! 0x%x\n", eglGetError());
+		Destroy();
+		return 1;
+	}
+
+	// without surfaceless contexts a tiny pbuffer is enough to make the context current
+	if (!surfaceless)
+	{
+		const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		surface = eglCreatePbufferSurface(display, config, pbufferAttributes);
+		if (surface == EGL_NO_SURFACE)
+		{
+			printf("EGL pbuffer creation failed! 0x%x\n", eglGetError());
+			Destroy();
+			return 1;
+		}
+	}
+
+	if (!eglMakeCurrent(display, surface, surface, context))
+	{
+		printf("EGL make current failed! 0x%x\n", eglGetError());
+		Destroy();
+		return 1;
+	}
+
+	// a GLX build of GLEW still loads every entry point before it fails to find an X display
+	glewExperimental = GL_TRUE;
+	GLenum glewResult = glewInit();
+	if (glewResult != GLEW_OK && glewResult != GLEW_ERROR_NO_GLX_DISPLAY)
+	{
+		printf("GLEW initialization failed!\n");
+		Destroy();
+		return 1;
+	}
+
+	glEnable(GL_DEPTH_TEST);
+
+	return 0;
+}
+
+void HeadlessContext::Destroy()
+{
+	if (display == EGL_NO_DISPLAY)
+	{
+		return;
+	}
+
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+	if (surface != EGL_NO_SURFACE)
+	{
+		eglDestroySurface(display, surface);
+		surface = EGL_NO_SURFACE;
+	}
+
+	if (context != EGL_NO_CONTEXT)
+	{
+		eglDestroyContext(display, context);
+		context = EGL_NO_CONTEXT;
+	}
+
+	eglTerminate(display);
+	display = EGL_NO_DISPLAY;
+}
+
+#endif
+
+HeadlessContext::~HeadlessContext()
+{
+	Destroy();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdio.h>
+
+#include <GL/glew.h>
+
+#ifdef _WIN32
+#include <GLFW/glfw3.h>
+#endif
+
+// OpenGL 3.3 core context without a visible window, rendering goes to an OffscreenTarget.
+// Uses a surfaceless (or 1x1 pbuffer) EGL context on Linux, which also works on Mesa llvmpipe,
+// and a hidden GLFW window on Windows.
+class HeadlessContext
+{
+public:
+	HeadlessContext();
+
+	int Initialize();
+	void Destroy();
+
+	~HeadlessContext();
+
+private:
+#ifdef _WIN32
+	GLFWwindow* hiddenWindow;
+#else
+	// EGL handles, kept opaque so EGL and X11 headers stay out of everything including this one
+	void* display;
+	void* context;
+	void* surface;
+#endif
+};
@@ -0,0 +1,108 @@
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	unsigned int BitLength(uint64_t value)
+	{
+		unsigned int bits = 0;
+		while (value != 0)
+		{
+			value >>= 1;
+			bits++;
+		}
+		return bits;
+	}
+}
+
+Histogram::Histogram()
+{
+	// values below SUB_BUCKET_COUNT are exact, every further power of two adds half a sub bucket range
+	counts.resize(SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * SUB_BUCKET_HALF, 0);
+	Reset();
+}
+
+size_t Histogram::BucketIndex(uint64_t value)
+{
+	unsigned int bits = BitLength(value);
+	unsigned int shift = bits > SUB_BUCKET_BITS ? bits - SUB_BUCKET_BITS : 0;
+
+	// for shift > 0 the value >> shift lies in [SUB_BUCKET_HALF, SUB_BUCKET_COUNT)
+	return shift * SUB_BUCKET_HALF + (size_t) (value >> shift);
+}
+
+uint64_t Histogram::HighestValueInBucket(size_t index)
+{
+	if (index < SUB_BUCKET_COUNT)
+	{
+		return index;
+	}
+
+	uint64_t shift = index / SUB_BUCKET_HALF - 1;
+	uint64_t subBucket = index - shift * SUB_BUCKET_HALF;
+	return ((subBucket + 1) << shift) - 1;
+}
+
+void Histogram::RecordValue(uint64_t value)
+{
+	counts[BucketIndex(value)]++;
+	count++;
+	total += (double) value;
+
+	if (value < minValue)
+	{
+		minValue = value;
+	}
+	if (value > maxValue)
+	{
+		maxValue = value;
+	}
+}
+
+void Histogram::Reset()
+{
+	std::fill(counts.begin(), counts.end(), 0);
+	count = 0;
+	minValue = UINT64_MAX;
+	maxValue = 0;
+	total = 0.0;
+}
+
+uint64_t Histogram::GetValueAtPercentile(double percentile) const
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	// nearest rank, like PrintFrameTimes
+	uint64_t rank = (uint64_t) std::ceil(percentile / 100.0 * count);
+	if (rank == 0)
+	{
+		rank = 1;
+	}
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < counts.size(); i++)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+		{
+			uint64_t value = HighestValueInBucket(i);
+			return value < maxValue ? value : maxValue;
+		}
+	}
+
+	return maxValue;
+}
+
+double Histogram::GetMean() const
+{
+	return count > 0 ? total / count : 0.0;
+}
+
+Histogram::~Histogram()
+{
+}
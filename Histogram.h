@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// HDR style histogram: log-linear buckets keep every recorded value within 1% (1 / 128) of its
+// bucket, from 0 up to the full 64 bit range, in a few KB and with O(1) recording.
+// Percentiles report the highest value a bucket can hold, capped at the recorded maximum.
+class Histogram
+{
+public:
+	Histogram();
+
+	void RecordValue(uint64_t value);
+	void Reset();
+
+	uint64_t GetValueAtPercentile(double percentile) const;
+	double GetMean() const;
+
+	uint64_t getCount() const { return count; }
+	uint64_t getMin() const { return count > 0 ? minValue : 0; }
+	uint64_t getMax() const { return maxValue; }
+
+	~Histogram();
+
+private:
+	static constexpr unsigned int SUB_BUCKET_BITS = 7;
+	static constexpr uint64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+	static constexpr uint64_t SUB_BUCKET_HALF = SUB_BUCKET_COUNT / 2;
+
+	std::vector<uint64_t> counts;
+	uint64_t count;
+	uint64_t minValue;
+	uint64_t maxValue;
+	double total;
+
+	static size_t BucketIndex(uint64_t value);
+	static uint64_t HighestValueInBucket(size_t index);
+};
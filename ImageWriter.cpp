@@ -0,0 +1,149 @@
+#include "ImageWriter.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+namespace
+{
+	constexpr int CHANNELS = 4;
+	constexpr size_t MAX_STORED_BLOCK = 65535;
+
+	uint32_t CRCTableEntry(uint32_t n)
+	{
+		uint32_t c = n;
+		for (int k = 0; k < 8; k++)
+		{
+			c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+		}
+		return c;
+	}
+
+	uint32_t UpdateCRC(uint32_t crc, const unsigned char* data, size_t length)
+	{
+		static uint32_t table[256];
+		static bool tableReady = false;
+		if (!tableReady)
+		{
+			for (uint32_t n = 0; n < 256; n++)
+			{
+				table[n] = CRCTableEntry(n);
+			}
+			tableReady = true;
+		}
+
+		for (size_t i = 0; i < length; i++)
+		{
+			crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc;
+	}
+
+	void PutBigEndian(std::vector<unsigned char>& out, uint32_t value)
+	{
+		out.push_back((unsigned char) (value >> 24));
+		out.push_back((unsigned char) (value >> 16));
+		out.push_back((unsigned char) (value >> 8));
+		out.push_back((unsigned char) value);
+	}
+
+	void WriteChunk(FILE* file, const char* type, const std::vector<unsigned char>& data)
+	{
+		std::vector<unsigned char> header;
+		PutBigEndian(header, (uint32_t) data.size());
+		header.insert(header.end(), type, type + 4);
+
+		// the CRC covers the chunk type and data, not the length
+		uint32_t crc = UpdateCRC(0xFFFFFFFFu, header.data() + 4, 4);
+		crc = UpdateCRC(crc, data.data(), data.size()) ^ 0xFFFFFFFFu;
+
+		std::vector<unsigned char> footer;
+		PutBigEndian(footer, crc);
+
+		fwrite(header.data(), 1, header.size(), file);
+		if (!data.empty())
+		{
+			fwrite(data.data(), 1, data.size(), file);
+		}
+		fwrite(footer.data(), 1, footer.size(), file);
+	}
+}
+
+int WritePNG(const char* fileName, int width, int height, const unsigned char* rgba, bool flipVertically)
+{
+	FILE* file = fopen(fileName, "wb");
+	if (!file)
+	{
+		printf("Failed to open %s for writing\n", fileName);
+		return 1;
+	}
+
+	const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	fwrite(signature, 1, sizeof(signature), file);
+
+	std::vector<unsigned char> header;
+	PutBigEndian(header, (uint32_t) width);
+	PutBigEndian(header, (uint32_t) height);
+	header.push_back(8); // bit depth
+	header.push_back(6); // color type RGBA
+	header.push_back(0); // deflate
+	header.push_back(0); // adaptive filtering
+	header.push_back(0); // no interlace
+	WriteChunk(file, "IHDR", header);
+
+	// every row starts with filter type 0 (none)
+	size_t rowSize = (size_t) width * CHANNELS;
+	std::vector<unsigned char> raw;
+	raw.reserve((rowSize + 1) * height);
+	for (int y = 0; y < height; y++)
+	{
+		int sourceRow = flipVertically ? height - 1 - y : y;
+		raw.push_back(0);
+		raw.insert(raw.end(), rgba + sourceRow * rowSize, rgba + (sourceRow + 1) * rowSize);
+	}
+
+	// zlib stream made of stored blocks, no compression but no dependency either
+	std::vector<unsigned char> zlib;
+	zlib.reserve(raw.size() + raw.size() / MAX_STORED_BLOCK * 5 + 16);
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+
+	size_t offset = 0;
+	do
+	{
+		size_t blockSize = raw.size() - offset < MAX_STORED_BLOCK ? raw.size() - offset : MAX_STORED_BLOCK;
+		bool lastBlock = offset + blockSize == raw.size();
+
+		zlib.push_back(lastBlock ? 1 : 0);
+		zlib.push_back((unsigned char) blockSize);
+		zlib.push_back((unsigned char) (blockSize >> 8));
+		zlib.push_back((unsigned char) ~blockSize);
+		zlib.push_back((unsigned char) (~blockSize >> 8));
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+
+		offset += blockSize;
+	} while (offset < raw.size());
+
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	for (unsigned char byte : raw)
+	{
+		adlerA = (adlerA + byte) % 65521;
+		adlerB = (adlerB + adlerA) % 65521;
+	}
+	PutBigEndian(zlib, (adlerB << 16) | adlerA);
+
+	WriteChunk(file, "IDAT", zlib);
+	WriteChunk(file, "IEND", std::vector<unsigned char>());
+
+	bool failed = ferror(file) != 0;
+	fclose(file);
+
+	if (failed)
+	{
+		printf("Failed to write %s\n", fileName);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stddef.h>
+
+// Writes 8 bit RGBA pixels as an uncompressed PNG (stored deflate blocks), returns 0 on success.
+// flipVertically turns OpenGL's bottom row first layout into the top row first order PNG expects.
+int WritePNG(const char* fileName, int width, int height, const unsigned char* rgba, bool flipVertically);
@@ -0,0 +1,88 @@
+#include "InputQueue.h"
+
+#include <GLFW/glfw3.h>
+
+static_assert((InputEventQueue::CAPACITY & (InputEventQueue::CAPACITY - 1)) == 0, "the ring is indexed with a mask");
+
+InputEventQueue::InputEventQueue() : events(CAPACITY), head(0), tail(0), droppedEvents(0)
+{
+}
+
+bool InputEventQueue::Push(const InputEvent& event)
+{
+	size_t write = head.load(std::memory_order_relaxed);
+	if (write - tail.load(std::memory_order_acquire) == CAPACITY)
+	{
+		droppedEvents++;
+		return false;
+	}
+
+	events[write & (CAPACITY - 1)] = event;
+	head.store(write + 1, std::memory_order_release); // publishes the event written above
+	return true;
+}
+
+bool InputEventQueue::Pop(InputEvent& event)
+{
+	size_t read = tail.load(std::memory_order_relaxed);
+	if (read == head.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	event = events[read & (CAPACITY - 1)];
+	tail.store(read + 1, std::memory_order_release); // the slot may be written again from here on
+	return true;
+}
+
+InputEventQueue::~InputEventQueue()
+{
+}
+
+InputState::InputState() : keys{}, buttons{}, mouseX(0.0), mouseY(0.0), takenMouseX(0.0), takenMouseY(0.0), eventCount(0)
+{
+}
+
+void InputState::Drain(InputEventQueue& queue)
+{
+	InputEvent event;
+	while (queue.Pop(event))
+	{
+		switch (event.type)
+		{
+		case INPUT_KEY:
+			if (event.code >= 0 && event.code < MAX_KEYS && event.action != GLFW_REPEAT)
+			{
+				keys[event.code] = event.action == GLFW_PRESS;
+			}
+			break;
+		case INPUT_MOUSE_BUTTON:
+			if (event.code >= 0 && event.code < MAX_BUTTONS)
+			{
+				buttons[event.code] = event.action == GLFW_PRESS;
+			}
+			break;
+		case INPUT_MOUSE_MOTION:
+			mouseX += event.deltaX;
+			mouseY += event.deltaY;
+			break;
+		}
+
+		lastEventTime = event.time;
+		eventCount++;
+	}
+}
+
+void InputState::TakeMouseMotion(float& x, float& y)
+{
+	x = (float) mouseX;
+	y = (float) mouseY;
+	takenMouseX += mouseX;
+	takenMouseY += mouseY;
+	mouseX = 0.0;
+	mouseY = 0.0;
+}
+
+InputState::~InputState()
+{
+}
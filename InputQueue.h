@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+enum InputEventType : uint8_t
+{
+	INPUT_KEY,
+	INPUT_MOUSE_BUTTON,
+	INPUT_MOUSE_MOTION
+};
+
+struct InputEvent
+{
+	InputEventType type;
+	int code;     // GLFW key or mouse button
+	int action;   // GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+	float deltaX; // mouse motion, y up
+	float deltaY;
+	std::chrono::steady_clock::time_point time; // when the window callback saw it
+};
+
+// Ring of input events from the window callbacks to whichever thread runs the simulation. One producer
+// and one consumer, each owning one index, so neither ever waits or takes a lock; a full ring drops
+// the event and counts it.
+class InputEventQueue
+{
+public:
+	static constexpr size_t CAPACITY = 4096; // power of two, a few seconds of a 1000 Hz mouse
+
+	InputEventQueue();
+
+	bool Push(const InputEvent& event); // producer only, false when full
+	bool Pop(InputEvent& event);        // consumer only, false when empty
+
+	size_t GetDroppedCount() const { return droppedEvents; } // producer side
+
+	~InputEventQueue();
+
+private:
+	std::vector<InputEvent> events; // CAPACITY of them, allocated once
+
+	// on lines of their own, so the two threads do not keep stealing each other's cache line
+	alignas(64) std::atomic<size_t> head; // next slot to write, stored by the producer
+	alignas(64) std::atomic<size_t> tail; // next slot to read, stored by the consumer
+	alignas(64) size_t droppedEvents;
+};
+
+// The consumer's view of the input, rebuilt from the events: keys and buttons held, and the mouse motion
+// since it was last taken, summed exactly however many events it arrived in.
+class InputState
+{
+public:
+	static constexpr int MAX_KEYS = 1024;
+	static constexpr int MAX_BUTTONS = 8;
+
+	InputState();
+
+	void Drain(InputEventQueue& queue); // applies every event queued so far
+
+	bool* GetKeys() { return keys; }
+	bool IsButtonDown(int button) const { return button >= 0 && button < MAX_BUTTONS && buttons[button]; }
+
+	void TakeMouseMotion(float& x, float& y);
+
+	// all motion taken so far; compared with the window's total it gives the motion no frame has taken yet
+	double GetTakenMouseX() const { return takenMouseX; }
+	double GetTakenMouseY() const { return takenMouseY; }
+
+	std::chrono::steady_clock::time_point GetLastEventTime() const { return lastEventTime; }
+	size_t GetEventCount() const { return eventCount; }
+
+	~InputState();
+
+private:
+	bool keys[MAX_KEYS];
+	bool buttons[MAX_BUTTONS];
+
+	double mouseX; // since the last take
+	double mouseY;
+	double takenMouseX;
+	double takenMouseY;
+
+	std::chrono::steady_clock::time_point lastEventTime;
+	size_t eventCount;
+};
@@ -0,0 +1,309 @@
+#include "JSONReader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+	class Parser
+	{
+	public:
+		explicit Parser(const char* text) : start(text), cursor(text) {}
+
+		bool ParseDocument(JSONValue& value)
+		{
+			if (!ParseValue(value))
+			{
+				return false;
+			}
+
+			SkipWhitespace();
+			return *cursor == '\0';
+		}
+
+		size_t GetOffset() const { return (size_t) (cursor - start); }
+
+	private:
+		const char* start;
+		const char* cursor;
+
+		void SkipWhitespace()
+		{
+			while (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')
+			{
+				cursor++;
+			}
+		}
+
+		bool Match(const char* literal)
+		{
+			size_t length = strlen(literal);
+			if (strncmp(cursor, literal, length) != 0)
+			{
+				return false;
+			}
+
+			cursor += length;
+			return true;
+		}
+
+		bool ParseValue(JSONValue& value)
+		{
+			SkipWhitespace();
+
+			switch (*cursor)
+			{
+			case '{':
+				return ParseObject(value);
+			case '[':
+				return ParseArray(value);
+			case '"':
+				value.type = JSONValue::STRING;
+				return ParseString(value.string);
+			case 't':
+				value.type = JSONValue::BOOLEAN;
+				value.boolean = true;
+				return Match("true");
+			case 'f':
+				value.type = JSONValue::BOOLEAN;
+				value.boolean = false;
+				return Match("false");
+			case 'n':
+				value.type = JSONValue::NULL_VALUE;
+				return Match("null");
+			default:
+				return ParseNumber(value);
+			}
+		}
+
+		bool ParseNumber(JSONValue& value)
+		{
+			char* end = nullptr;
+			value.type = JSONValue::NUMBER;
+			value.number = strtod(cursor, &end);
+			if (end == cursor)
+			{
+				return false;
+			}
+
+			cursor = end;
+			return true;
+		}
+
+		bool ParseString(std::string& result)
+		{
+			cursor++; // opening quote
+			result.clear();
+
+			while (*cursor != '"')
+			{
+				if (*cursor == '\0')
+				{
+					return false;
+				}
+
+				if (*cursor != '\\')
+				{
+					result += *cursor++;
+					continue;
+				}
+
+				cursor++;
+				switch (*cursor)
+				{
+				case 'n': result += '\n'; break;
+				case 't': result += '\t'; break;
+				case 'r': result += '\r'; break;
+				case 'b': result += '\b'; break;
+				case 'f': result += '\f'; break;
+				case 'u':
+					// names and paths in our reports are ASCII, anything else only needs to be skipped
+					for (int i = 0; i < 4; i++)
+					{
+						if (*++cursor == '\0')
+						{
+							return false;
+						}
+					}
+					result += '?';
+					break;
+				case '\0':
+					return false;
+				default:
+					result += *cursor; // \" \\ and \/
+					break;
+				}
+				cursor++;
+			}
+
+			cursor++; // closing quote
+			return true;
+		}
+
+		bool ParseArray(JSONValue& value)
+		{
+			value.type = JSONValue::ARRAY;
+			cursor++;
+
+			SkipWhitespace();
+			if (*cursor == ']')
+			{
+				cursor++;
+				return true;
+			}
+
+			while (true)
+			{
+				value.elements.emplace_back();
+				if (!ParseValue(value.elements.back()))
+				{
+					return false;
+				}
+
+				SkipWhitespace();
+				if (*cursor == ']')
+				{
+					cursor++;
+					return true;
+				}
+				if (*cursor++ != ',')
+				{
+					return false;
+				}
+			}
+		}
+
+		bool ParseObject(JSONValue& value)
+		{
+			value.type = JSONValue::OBJECT;
+			cursor++;
+
+			SkipWhitespace();
+			if (*cursor == '}')
+			{
+				cursor++;
+				return true;
+			}
+
+			while (true)
+			{
+				SkipWhitespace();
+				value.keys.emplace_back();
+				if (*cursor != '"' || !ParseString(value.keys.back()))
+				{
+					return false;
+				}
+
+				SkipWhitespace();
+				if (*cursor++ != ':')
+				{
+					return false;
+				}
+
+				value.elements.emplace_back();
+				if (!ParseValue(value.elements.back()))
+				{
+					return false;
+				}
+
+				SkipWhitespace();
+				if (*cursor == '}')
+				{
+					cursor++;
+					return true;
+				}
+				if (*cursor++ != ',')
+				{
+					return false;
+				}
+			}
+		}
+	};
+}
+
+const JSONValue* JSONValue::Find(const char* key) const
+{
+	if (type != OBJECT)
+	{
+		return nullptr;
+	}
+
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		if (keys[i] == key)
+		{
+			return &elements[i];
+		}
+	}
+	return nullptr;
+}
+
+int ParseJSON(const char* text, JSONValue& value)
+{
+	value = JSONValue{};
+
+	Parser parser(text);
+	if (!parser.ParseDocument(value))
+	{
+		printf("Invalid JSON at offset %zu\n", parser.GetOffset());
+		return 1;
+	}
+	return 0;
+}
+
+int ReadJSONFile(const char* fileName, JSONValue& value)
+{
+	FILE* file = fopen(fileName, "rb");
+	if (!file)
+	{
+		printf("Failed to open %s\n", fileName);
+		return 1;
+	}
+
+	std::string text;
+	char buffer[4096];
+	size_t bytesRead = 0;
+	while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		text.append(buffer, bytesRead);
+	}
+	fclose(file);
+
+	if (ParseJSON(text.c_str(), value) != 0)
+	{
+		printf("Failed to parse %s\n", fileName);
+		return 1;
+	}
+	return 0;
+}
+
+void WriteJSONString(FILE* file, const char* text)
+{
+	fputc('"', file);
+	for (const char* cursor = text; *cursor; cursor++)
+	{
+		unsigned char c = (unsigned char) *cursor;
+		switch (c)
+		{
+		case '"': fputs("\\\"", file); break;
+		case '\\': fputs("\\\\", file); break;
+		case '\n': fputs("\\n", file); break;
+		case '\t': fputs("\\t", file); break;
+		case '\r': fputs("\\r", file); break;
+		case '\b': fputs("\\b", file); break;
+		case '\f': fputs("\\f", file); break;
+		default:
+			if (c < 0x20)
+			{
+				fprintf(file, "\\u%04x", c);
+			}
+			else
+			{
+				fputc(c, file);
+			}
+			break;
+		}
+	}
+	fputc('"', file);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Parsed JSON document, just enough to read back the reports the engine writes
+struct JSONValue
+{
+	enum Type
+	{
+		NULL_VALUE,
+		BOOLEAN,
+		NUMBER,
+		STRING,
+		ARRAY,
+		OBJECT
+	};
+
+	Type type = NULL_VALUE;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+
+	std::vector<JSONValue> elements; // array elements, or object values in file order
+	std::vector<std::string> keys;   // object keys, parallel to elements
+
+	// member of an object, nullptr if missing or not an object
+	const JSONValue* Find(const char* key) const;
+};
+
+// returns 0 on success, prints where the text stopped parsing otherwise
+int ParseJSON(const char* text, JSONValue& value);
+int ReadJSONFile(const char* fileName, JSONValue& value);
+
+// writes text as a quoted JSON string, escaping quotes, backslashes and control characters
+void WriteJSONString(FILE* file, const char* text);
@@ -0,0 +1,371 @@
+#include "JobSystem.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameArena.h"
+#include "Profiler.h"
+
+namespace
+{
+	constexpr size_t DEQUE_MASK = MAX_JOBS_PER_THREAD - 1;
+	constexpr int IDLE_SPINS = 64;            // failed steal rounds before a worker goes to sleep
+	constexpr size_t SPLITS_PER_THREAD = 16;  // default ParallelFor grain gives each thread this many pieces
+
+	static_assert((MAX_JOBS_PER_THREAD & DEQUE_MASK) == 0, "deque capacity must be a power of two");
+
+	// Chase-Lev deque over a fixed ring, with the memory orders from Le et al., "Correct and Efficient
+	// Work-Stealing for Weak Memory Models". Only the owner pushes and pops, anyone steals.
+	class JobDeque
+	{
+	public:
+		JobDeque() : top(0), bottom(0)
+		{
+			for (std::atomic<Job*>& job : jobs)
+			{
+				job.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		bool Push(Job* job)
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_acquire);
+			if (b - t >= (int64_t) MAX_JOBS_PER_THREAD)
+			{
+				return false;
+			}
+
+			jobs[b & DEQUE_MASK].store(job, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		Job* Pop()
+		{
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+
+			if (t > b)
+			{
+				bottom.store(b + 1, std::memory_order_relaxed); // was empty
+				return nullptr;
+			}
+
+			Job* job = jobs[b & DEQUE_MASK].load(std::memory_order_relaxed);
+			if (t == b)
+			{
+				// last job, race the thieves for it
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				{
+					job = nullptr;
+				}
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+			return job;
+		}
+
+		Job* Steal()
+		{
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom.load(std::memory_order_acquire);
+
+			if (t >= b)
+			{
+				return nullptr;
+			}
+
+			Job* job = jobs[t & DEQUE_MASK].load(std::memory_order_relaxed);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				return nullptr; // lost to the owner or another thief
+			}
+			return job;
+		}
+
+		bool IsEmpty() const
+		{
+			return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<int64_t> top;
+		std::atomic<int64_t> bottom;
+		std::atomic<Job*> jobs[MAX_JOBS_PER_THREAD];
+	};
+
+	struct ThreadState
+	{
+		JobDeque deque;
+		std::unique_ptr<Job[]> jobs{ new Job[MAX_JOBS_PER_THREAD] };
+		size_t allocatedJobs = 0;
+		uint32_t randomState = 1; // picks steal victims
+	};
+
+	std::vector<std::unique_ptr<ThreadState>> threadStates;
+	std::vector<std::thread> workerThreads;
+	std::atomic<bool> running{ false };
+	thread_local int threadIndex = -1;
+
+	// idle workers sleep until a job is pushed
+	std::mutex sleepMutex;
+	std::condition_variable wakeCondition;
+	std::atomic<int> queuedJobs{ 0 };
+	std::atomic<int> sleepingWorkers{ 0 };
+
+	void Finish(Job* job)
+	{
+		if (job->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) == 1 && job->parent)
+		{
+			Finish(job->parent);
+		}
+	}
+
+	void Execute(Job* job)
+	{
+		job->function(job, job->data);
+		Finish(job);
+	}
+
+	Job* GetJob()
+	{
+		ThreadState& state = *threadStates[threadIndex];
+
+		Job* job = state.deque.Pop();
+		if (!job)
+		{
+			// xorshift, so threads spread their steal attempts over different victims
+			state.randomState ^= state.randomState << 13;
+			state.randomState ^= state.randomState >> 17;
+			state.randomState ^= state.randomState << 5;
+
+			size_t threadCount = threadStates.size();
+			size_t first = state.randomState % threadCount;
+			for (size_t i = 0; i < threadCount && !job; i++)
+			{
+				size_t victim = (first + i) % threadCount;
+				if (victim != (size_t) threadIndex)
+				{
+					job = threadStates[victim]->deque.Steal();
+				}
+			}
+		}
+
+		if (job)
+		{
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	void WorkerLoop(int index)
+	{
+		threadIndex = index;
+		std::string name = "Job worker " + std::to_string(index);
+		PROFILE_THREAD_NAME(name.c_str());
+		GetFrameArena(); // registers the worker's arenas now rather than in the first frame it gets work in
+
+		int idleRounds = 0;
+		while (running.load(std::memory_order_relaxed))
+		{
+			Job* job = GetJob();
+			if (job)
+			{
+				Execute(job);
+				idleRounds = 0;
+				continue;
+			}
+
+			if (++idleRounds < IDLE_SPINS)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+
+			// RunJob checks for sleepers after queueing, so either it sees this worker or the wait sees the job
+			std::unique_lock<std::mutex> lock(sleepMutex);
+			sleepingWorkers.fetch_add(1);
+			wakeCondition.wait(lock, [] { return queuedJobs.load() > 0 || !running.load(); });
+			sleepingWorkers.fetch_sub(1);
+			idleRounds = 0;
+		}
+	}
+
+	struct RangeData
+	{
+		RangeKernel kernel;
+		void* context;
+		size_t begin;
+		size_t end;
+		size_t minGrain;
+	};
+
+	void RangeJob(Job* job, const void* data)
+	{
+		RangeData range = *static_cast<const RangeData*>(data);
+		const JobDeque& deque = threadStates[threadIndex]->deque;
+
+		while (range.end - range.begin > range.minGrain)
+		{
+			// only hand out work while nothing else is queued here, otherwise keep going through our own range
+			if (range.end - range.begin >= 2 * range.minGrain && deque.IsEmpty())
+			{
+				RangeData upperHalf = range;
+				upperHalf.begin = range.begin + (range.end - range.begin) / 2;
+				range.end = upperHalf.begin;
+				RunJob(CreateChildJob(job, RangeJob, upperHalf));
+				continue;
+			}
+
+			range.kernel(range.begin, range.begin + range.minGrain, range.context);
+			range.begin += range.minGrain;
+		}
+
+		if (range.begin < range.end)
+		{
+			range.kernel(range.begin, range.end, range.context);
+		}
+	}
+}
+
+void JobSystemInitialize(unsigned int workerCount)
+{
+	JobSystemShutdown();
+
+	for (unsigned int i = 0; i <= workerCount; i++)
+	{
+		threadStates.push_back(std::unique_ptr<ThreadState>(new ThreadState()));
+		threadStates.back()->randomState = 0x9E3779B9u * (i + 1);
+	}
+
+	threadIndex = 0;
+	running = true;
+
+	for (unsigned int i = 1; i <= workerCount; i++)
+	{
+		workerThreads.emplace_back(WorkerLoop, (int) i);
+	}
+}
+
+void JobSystemShutdown()
+{
+	if (!running)
+	{
+		return;
+	}
+
+	running = false;
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wakeCondition.notify_all();
+
+	for (std::thread& thread : workerThreads)
+	{
+		thread.join();
+	}
+
+	workerThreads.clear();
+	threadStates.clear();
+	queuedJobs = 0;
+	threadIndex = -1;
+}
+
+bool IsJobSystemRunning()
+{
+	return running.load(std::memory_order_relaxed);
+}
+
+unsigned int GetJobThreadCount()
+{
+	return (unsigned int) threadStates.size();
+}
+
+Job* CreateJob(JobFunction function)
+{
+	ThreadState& state = *threadStates[threadIndex];
+
+	Job* job = &state.jobs[state.allocatedJobs++ & DEQUE_MASK];
+	job->function = function;
+	job->parent = nullptr;
+	job->unfinishedJobs.store(1, std::memory_order_relaxed);
+	return job;
+}
+
+Job* CreateChildJob(Job* parent, JobFunction function)
+{
+	parent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+
+	Job* job = CreateJob(function);
+	job->parent = parent;
+	return job;
+}
+
+void RunJob(Job* job)
+{
+	// a full deque runs the job right away instead of dropping it
+	if (!threadStates[threadIndex]->deque.Push(job))
+	{
+		Execute(job);
+		return;
+	}
+
+	queuedJobs.fetch_add(1);
+	if (sleepingWorkers.load() > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+		}
+		wakeCondition.notify_one();
+	}
+}
+
+void WaitForJob(const Job* job)
+{
+	while (job->unfinishedJobs.load(std::memory_order_acquire) > 0)
+	{
+		Job* next = GetJob();
+		if (next)
+		{
+			Execute(next);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void ParallelFor(size_t count, RangeKernel kernel, void* context, size_t minGrain)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// no helpers, or a thread that is not part of the job system
+	if (!IsJobSystemRunning() || threadIndex < 0 || threadStates.size() < 2)
+	{
+		kernel(0, count, context);
+		return;
+	}
+
+	if (minGrain == 0)
+	{
+		minGrain = std::max<size_t>(1, count / (threadStates.size() * SPLITS_PER_THREAD));
+	}
+
+	Job* root = CreateJob(RangeJob, RangeData{ kernel, context, 0, count, minGrain });
+	Execute(root);
+	WaitForJob(root);
+}
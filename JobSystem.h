@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <new>
+
+struct Job;
+typedef void (*JobFunction)(Job* job, const void* data);
+
+// A job is a function with a small inline payload. Children add to their parent's unfinished count,
+// so waiting on a parent waits for everything spawned under it.
+struct Job
+{
+	static constexpr size_t DATA_SIZE = 64 - sizeof(JobFunction) - sizeof(Job*) - sizeof(std::atomic<int32_t>);
+
+	JobFunction function;
+	Job* parent;
+	alignas(sizeof(void*)) unsigned char data[DATA_SIZE]; // right after the pointers so payloads holding pointers are aligned
+	std::atomic<int32_t> unfinishedJobs;
+};
+
+static_assert(sizeof(Job) == 64, "jobs are sized to one cache line");
+
+// Work stealing job system: every thread owns a Chase-Lev deque, pushes and pops its own jobs at the
+// bottom and steals from the top of the others when it runs dry. The thread that calls
+// JobSystemInitialize takes part as worker 0 while it waits; other threads may not create jobs.
+// Jobs come from a per thread ring, so a thread can have at most MAX_JOBS_PER_THREAD jobs alive.
+constexpr size_t MAX_JOBS_PER_THREAD = 4096;
+
+void JobSystemInitialize(unsigned int workerCount); // threads besides the caller, 0 for none
+void JobSystemShutdown();
+bool IsJobSystemRunning();
+unsigned int GetJobThreadCount(); // workers plus the calling thread
+
+Job* CreateJob(JobFunction function);
+Job* CreateChildJob(Job* parent, JobFunction function);
+void RunJob(Job* job);
+void WaitForJob(const Job* job); // runs other jobs until this one and its children are done
+
+template <typename Data>
+Job* CreateJob(JobFunction function, const Data& data)
+{
+	static_assert(sizeof(Data) <= Job::DATA_SIZE, "job data does not fit in the job");
+	Job* job = CreateJob(function);
+	new (job->data) Data(data);
+	return job;
+}
+
+template <typename Data>
+Job* CreateChildJob(Job* parent, JobFunction function, const Data& data)
+{
+	static_assert(sizeof(Data) <= Job::DATA_SIZE, "job data does not fit in the job");
+	Job* job = CreateChildJob(parent, function);
+	new (job->data) Data(data);
+	return job;
+}
+
+// Calls kernel(begin, end, context) over [0, count) in parallel and returns when every range is done.
+// Ranges are split lazily: a job only halves its range while its own deque is empty, which is when an
+// idle thread could steal the other half, so the grain adapts to how busy the other threads are.
+// minGrain 0 picks one from the count and thread count.
+typedef void (*RangeKernel)(size_t begin, size_t end, void* context);
+void ParallelFor(size_t count, RangeKernel kernel, void* context, size_t minGrain = 0);
+
+template <typename Function>
+void ParallelFor(size_t count, const Function& function, size_t minGrain = 0)
+{
+	ParallelFor(count, [](size_t begin, size_t end, void* context) { (*static_cast<const Function*>(context))(begin, end); },
+	            const_cast<Function*>(&function), minGrain);
+}
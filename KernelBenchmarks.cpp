@@ -0,0 +1,415 @@
+#include "KernelBenchmarks.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "MicroBenchmark.h"
+#include "Camera.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "NullRenderBackend.h"
+#include "CommandBuffer.h"
+#include "JobSystem.h"
+#include "Bounds.h"
+#include "RenderBackend.h"
+#include "stb_image.h"
+
+namespace
+{
+	constexpr unsigned int VERTEX_LENGTH = 8; // XYZ UV normal
+	constexpr unsigned int NORMAL_OFFSET = 5;
+
+	// wavy grid of size x size quads, the interleaved layout every mesh uses
+	void CreateGrid(unsigned int size, std::vector<GLfloat>& vertices, std::vector<unsigned int>& indices)
+	{
+		vertices.clear();
+		indices.clear();
+
+		for (unsigned int z = 0; z <= size; z++)
+		{
+			for (unsigned int x = 0; x <= size; x++)
+			{
+				float u = (float) x / size;
+				float v = (float) z / size;
+				const GLfloat vertex[VERTEX_LENGTH] = { u * 2.0f - 1.0f, 0.1f * std::sin(u * 12.0f) * std::cos(v * 9.0f), v * 2.0f - 1.0f,
+				                                        u, v, 0.0f, 0.0f, 0.0f };
+				vertices.insert(vertices.end(), vertex, vertex + VERTEX_LENGTH);
+			}
+		}
+
+		for (unsigned int z = 0; z < size; z++)
+		{
+			for (unsigned int x = 0; x < size; x++)
+			{
+				unsigned int corner = z * (size + 1) + x;
+				const unsigned int quad[] = { corner, corner + size + 1, corner + 1, corner + 1, corner + size + 1, corner + size + 2 };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+	}
+
+	// argument: grid size, items: triangles
+	void BM_CalcAverageNormals(BenchmarkState& state)
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<unsigned int> indices;
+		CreateGrid((unsigned int) state.range(), vertices, indices);
+
+		// normals are summed and renormalized, so later passes do the same work on the previous result
+		while (state.KeepRunning())
+		{
+			calcAverageNormals(indices.data(), (unsigned int) indices.size(), vertices.data(), (unsigned int) vertices.size(), VERTEX_LENGTH, NORMAL_OFFSET);
+			DoNotOptimize(vertices[NORMAL_OFFSET]);
+		}
+
+		state.SetItemsProcessed(state.iterations() * (int64_t) indices.size() / 3);
+	}
+
+	// argument: cameras updated per iteration, the turn recomputes the camera basis
+	void BM_CameraMouseControl(BenchmarkState& state)
+	{
+		std::vector<Camera> cameras((size_t) state.range(), Camera{ glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f), -90.0f, 0.0f, 10.0f, 20.0f });
+
+		while (state.KeepRunning())
+		{
+			for (Camera& camera : cameras)
+			{
+				camera.mouseControl(0.05f, 0.01f);
+			}
+			DoNotOptimize(cameras.back());
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range());
+	}
+
+	void BM_CameraViewMatrix(BenchmarkState& state)
+	{
+		std::vector<Camera> cameras;
+		for (int64_t i = 0; i < state.range(); i++)
+		{
+			cameras.push_back(Camera{ glm::vec3((float) i, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), (float) i, 0.0f, 10.0f, 20.0f });
+		}
+
+		while (state.KeepRunning())
+		{
+			for (Camera& camera : cameras)
+			{
+				glm::mat4 view = camera.calculateViewMatrix();
+				DoNotOptimize(view);
+			}
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range());
+	}
+
+	void BM_Perspective(BenchmarkState& state)
+	{
+		std::vector<glm::mat4> projections((size_t) state.range());
+
+		while (state.KeepRunning())
+		{
+			for (size_t i = 0; i < projections.size(); i++)
+			{
+				projections[i] = glm::perspective(glm::radians(60.0f), 1.0f + i * 0.001f, 0.1f, 100.0f);
+			}
+			DoNotOptimize(projections.back());
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range());
+	}
+
+	// projection * view * model for every object, what each draw computes on the CPU side
+	void BM_MatrixChain(BenchmarkState& state)
+	{
+		glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 5.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		std::vector<glm::mat4> models;
+		for (int64_t i = 0; i < state.range(); i++)
+		{
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((float) i, 0.0f, -2.5f));
+			models.push_back(glm::rotate(model, (float) i * 0.1f, glm::vec3(0.0f, 1.0f, 0.0f)));
+		}
+		std::vector<glm::mat4> results(models.size());
+
+		while (state.KeepRunning())
+		{
+			for (size_t i = 0; i < models.size(); i++)
+			{
+				results[i] = projection * view * models[i];
+			}
+			DoNotOptimize(results.back());
+		}
+
+		state.SetItemsProcessed(state.iterations() * state.range());
+	}
+
+	// argument: file size in KiB, made of shader-like lines
+	void BM_ShaderReadFile(BenchmarkState& state)
+	{
+		const std::string fileName = "microbench_shader_" + std::to_string(state.range()) + ".glsl";
+		const char* line = "    vec4 diffuseColor = vec4(directionalLight.color, 1.0f) * directionalLight.diffuseIntensity;\n";
+
+		std::string content;
+		while (content.size() < (size_t) state.range() * 1024)
+		{
+			content += line;
+		}
+
+		FILE* file = fopen(fileName.c_str(), "w");
+		if (!file)
+		{
+			printf("Failed to open %s for writing\n", fileName.c_str());
+			return;
+		}
+		fwrite(content.data(), 1, content.size(), file);
+		fclose(file);
+
+		Shader shader;
+		while (state.KeepRunning())
+		{
+			std::string source = shader.ReadFile(fileName.c_str());
+			DoNotOptimize(source);
+		}
+
+		remove(fileName.c_str());
+		state.SetBytesProcessed(state.iterations() * (int64_t) content.size());
+	}
+
+	// argument: index of the bundled texture, items: decoded pixels
+	void BM_StbiLoad(BenchmarkState& state)
+	{
+		const char* textures[] = { "textures/brick.png", "textures/dirt.png" };
+		const char* fileName = textures[state.range()];
+
+		int width = 0;
+		int height = 0;
+		int bitDepth = 0;
+		while (state.KeepRunning())
+		{
+			unsigned char* data = stbi_load(fileName, &width, &height, &bitDepth, 0);
+			DoNotOptimize(data);
+			stbi_image_free(data);
+		}
+
+		if (width == 0)
+		{
+			printf("Failed to find: %s\n", fileName);
+		}
+		state.SetItemsProcessed(state.iterations() * width * height);
+		state.SetBytesProcessed(state.iterations() * width * height * bitDepth);
+	}
+
+	// argument: grid size, items: vertices. Bounds, CPU copies and the vertex array creation, with the
+	// null backend so nothing reaches a driver
+	void BM_CreateMesh(BenchmarkState& state)
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<unsigned int> indices;
+		CreateGrid((unsigned int) state.range(), vertices, indices);
+
+		NullRenderBackend nullBackend;
+		SetRenderBackend(&nullBackend);
+
+		while (state.KeepRunning())
+		{
+			Mesh mesh;
+			mesh.CreateMesh(vertices.data(), indices.data(), (unsigned int) vertices.size(), (unsigned int) indices.size());
+			DoNotOptimize(mesh.GetBoundingSphere());
+		}
+
+		SetRenderBackend(nullptr);
+		state.SetItemsProcessed(state.iterations() * (int64_t) vertices.size() / VERTEX_LENGTH);
+	}
+
+	// argument: grid size, items: triangles
+	void BM_BuildMeshlets(BenchmarkState& state)
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<unsigned int> indices;
+		CreateGrid((unsigned int) state.range(), vertices, indices);
+
+		NullRenderBackend nullBackend;
+		SetRenderBackend(&nullBackend);
+
+		while (state.KeepRunning())
+		{
+			// meshlets reorder the index buffer, so every pass starts from a fresh mesh
+			state.PauseTiming();
+			Mesh mesh;
+			mesh.CreateMesh(vertices.data(), indices.data(), (unsigned int) vertices.size(), (unsigned int) indices.size());
+			state.ResumeTiming();
+
+			mesh.BuildMeshlets();
+			DoNotOptimize(mesh.GetIndices());
+		}
+
+		SetRenderBackend(nullptr);
+		state.SetItemsProcessed(state.iterations() * (int64_t) indices.size() / 3);
+	}
+
+	unsigned int GetHardwareWorkers()
+	{
+		return std::max(1u, std::thread::hardware_concurrency()) - 1;
+	}
+
+	// what one frame's draws ask of the backend: a program, and per object a model matrix, a material, a texture and a draw
+	struct DrawSetup
+	{
+		GLuint program;
+		GLuint vertexArray;
+		GLuint texture;
+		GLuint modelLocation;
+		GLuint shininessLocation;
+		GLsizei indexCount;
+	};
+
+	DrawSetup CreateDrawSetup(RenderBackend& backend)
+	{
+		std::vector<GLfloat> vertices;
+		std::vector<unsigned int> indices;
+		CreateGrid(8, vertices, indices);
+
+		const unsigned int attributeSizes[] = { 3, 2, 3 };
+		const unsigned char texel[] = { 255, 255, 255, 255 };
+
+		DrawSetup setup{};
+		setup.vertexArray = backend.CreateVertexArray(vertices.data(), vertices.size(), indices.data(), indices.size(), attributeSizes, 3);
+		setup.texture = backend.CreateTexture(1, 1, texel);
+		setup.program = backend.CreateProgram("uniform mat4 model;", "uniform float shininess;");
+		setup.modelLocation = backend.GetUniformLocation(setup.program, "model");
+		setup.shininessLocation = backend.GetUniformLocation(setup.program, "shininess");
+		setup.indexCount = (GLsizei) indices.size();
+		return setup;
+	}
+
+	void IssueDraws(RenderBackend& backend, const DrawSetup& setup, int64_t drawCount)
+	{
+		backend.UseProgram(setup.program);
+		for (int64_t i = 0; i < drawCount; i++)
+		{
+			backend.SetUniform(setup.modelLocation, glm::translate(glm::mat4(1.0f), glm::vec3((float) i, 0.0f, 0.0f)));
+			backend.SetUniform(setup.shininessLocation, 32.0f);
+			backend.BindTexture(setup.texture, 0);
+			backend.DrawIndexed(setup.vertexArray, 0, setup.indexCount);
+		}
+		backend.UseProgram(0);
+	}
+
+	// argument: draws, items: draws issued straight to the null backend, the baseline for the one below
+	void BM_DrawDirect(BenchmarkState& state)
+	{
+		NullRenderBackend nullBackend;
+		DrawSetup setup = CreateDrawSetup(nullBackend);
+
+		while (state.KeepRunning())
+		{
+			IssueDraws(nullBackend, setup, state.range());
+		}
+
+		DoNotOptimize(nullBackend.GetDrawCount());
+		state.SetItemsProcessed(state.iterations() * state.range());
+	}
+
+	// argument: draws, items: draws recorded into a command buffer and replayed, the overhead deferral adds
+	void BM_CommandBufferRecordReplay(BenchmarkState& state)
+	{
+		NullRenderBackend nullBackend;
+		DrawSetup setup = CreateDrawSetup(nullBackend);
+		CommandBuffer commands;
+
+		while (state.KeepRunning())
+		{
+			commands.Reset();
+			IssueDraws(commands, setup, state.range());
+			commands.Replay(nullBackend);
+		}
+
+		DoNotOptimize(nullBackend.GetDrawCount());
+		state.SetItemsProcessed(state.iterations() * state.range());
+	}
+
+	void EmptyJob(Job*, const void*)
+	{
+	}
+
+	// argument: empty jobs spawned under one root and waited for, the pure scheduling cost
+	void BM_JobSpawn(BenchmarkState& state)
+	{
+		JobSystemInitialize(GetHardwareWorkers());
+
+		while (state.KeepRunning())
+		{
+			Job* root = CreateJob(EmptyJob);
+			for (int64_t i = 0; i < state.range(); i++)
+			{
+				RunJob(CreateChildJob(root, EmptyJob));
+			}
+			RunJob(root);
+			WaitForJob(root);
+		}
+
+		JobSystemShutdown();
+		state.SetItemsProcessed(state.iterations() * state.range());
+	}
+
+	// argument: worker threads besides the caller, items: spheres moved to world space, like the
+	// per object transforms a frame needs
+	void BM_ParallelForScaling(BenchmarkState& state)
+	{
+		constexpr size_t SPHERE_COUNT = 1 << 18;
+
+		std::vector<BoundingSphere> spheres(SPHERE_COUNT);
+		std::vector<glm::mat4> models(SPHERE_COUNT);
+		for (size_t i = 0; i < SPHERE_COUNT; i++)
+		{
+			spheres[i] = BoundingSphere{ glm::vec3(0.0f, 0.5f, 0.0f), 1.0f + (i % 7) * 0.1f };
+			models[i] = glm::translate(glm::mat4(1.0f), glm::vec3((float) (i % 512), 0.0f, (float) (i / 512)));
+		}
+		std::vector<BoundingSphere> worldSpheres(SPHERE_COUNT);
+
+		JobSystemInitialize((unsigned int) state.range());
+
+		while (state.KeepRunning())
+		{
+			ParallelFor(SPHERE_COUNT, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++)
+				{
+					worldSpheres[i] = TransformSphere(spheres[i], models[i]);
+				}
+			});
+			DoNotOptimize(worldSpheres.back());
+		}
+
+		JobSystemShutdown();
+		state.SetItemsProcessed(state.iterations() * (int64_t) SPHERE_COUNT);
+	}
+}
+
+int RunKernelBenchmarks(const char* filter, const char* outputFile, int repetitions)
+{
+	const std::vector<MicroBenchmark> benchmarks = {
+		{ "BM_CalcAverageNormals", BM_CalcAverageNormals, { 8, 64, 256 } },
+		{ "BM_CameraMouseControl", BM_CameraMouseControl, { 1, 64, 4096 } },
+		{ "BM_CameraViewMatrix", BM_CameraViewMatrix, { 1, 64, 4096 } },
+		{ "BM_Perspective", BM_Perspective, { 1, 64, 4096 } },
+		{ "BM_MatrixChain", BM_MatrixChain, { 1, 64, 4096 } },
+		{ "BM_ShaderReadFile", BM_ShaderReadFile, { 1, 16, 256 } },
+		{ "BM_StbiLoad", BM_StbiLoad, { 0, 1 } },
+		{ "BM_CreateMesh", BM_CreateMesh, { 8, 64, 256 } },
+		{ "BM_BuildMeshlets", BM_BuildMeshlets, { 8, 64, 256 } },
+		{ "BM_DrawDirect", BM_DrawDirect, { 64, 1024 } },
+		{ "BM_CommandBufferRecordReplay", BM_CommandBufferRecordReplay, { 64, 1024 } },
+		{ "BM_JobSpawn", BM_JobSpawn, { 1, 64, 1024 } },
+		{ "BM_ParallelForScaling", BM_ParallelForScaling, { 0, 1, 3, 7 } },
+	};
+
+	return RunMicroBenchmarks(benchmarks, filter, outputFile, repetitions);
+}
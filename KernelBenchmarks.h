@@ -0,0 +1,5 @@
+#pragma once
+
+// Microbenchmarks of the CPU kernels scene loading and the frame loop rely on, run with --microbench.
+// filter is a regex over name/argument, outputFile (optional) gets the results as JSON.
+int RunKernelBenchmarks(const char* filter, const char* outputFile, int repetitions);
@@ -0,0 +1,210 @@
+#include "LateLatch.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Profiler.h"
+
+LateLatch::LateLatch() :
+	frameIndex(0), buffer(0), slotStride(0), mapped(nullptr), displayDelay(0.0), waitedFrames(0), waitTime(0.0), lastPhotonLatency(0.0)
+{
+}
+
+int LateLatch::Initialize(unsigned int maxFramesInFlight, GLuint program, double displayDelay)
+{
+	GLuint blockIndex = glGetUniformBlockIndex(program, "LatchedView");
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		printf("Low latency mode: the shader has no LatchedView block\n");
+		return 1;
+	}
+	glUniformBlockBinding(program, blockIndex, BLOCK_BINDING);
+
+	slots.assign(std::min(std::max(maxFramesInFlight, 1u), MAX_FRAMES_IN_FLIGHT), FrameSlot{ nullptr, Clock::now() });
+	this->displayDelay = displayDelay;
+
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	alignment = std::max(alignment, 1);
+	slotStride = (sizeof(glm::mat4) + alignment - 1) / alignment * alignment;
+	GLsizeiptr size = slotStride * slots.size();
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+
+	if (GLEW_ARB_buffer_storage)
+	{
+		// coherent, so a write is visible to every command submitted after it without a flush
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_UNIFORM_BUFFER, size, nullptr, flags);
+		mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, size, flags));
+
+		if (!mapped)
+		{
+			// storage is immutable, the fallback needs a buffer of its own
+			printf("Low latency mode: mapping the view buffer failed, updating it with glBufferSubData\n");
+			glDeleteBuffers(1, &buffer);
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		}
+	}
+
+	if (!mapped)
+	{
+		glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	printf("Low latency mode: %zu frame%s in flight, view latched through a %s uniform buffer\n", slots.size(),
+	       slots.size() == 1 ? "" : "s", mapped ? "persistently mapped" : "glBufferSubData");
+	return 0;
+}
+
+void LateLatch::BeginFrame()
+{
+	if (!IsActive())
+	{
+		return;
+	}
+
+	PollFinished();
+
+	FrameSlot& slot = CurrentSlot();
+	if (slot.fence)
+	{
+		PROFILE_SCOPE("Wait for GPU");
+
+		// the slot's last frame is maxFramesInFlight frames back, once it is done both the queue and its buffer slot are free
+		Clock::time_point waitStart = Clock::now();
+		GLenum result = GL_TIMEOUT_EXPIRED;
+		while (result == GL_TIMEOUT_EXPIRED)
+		{
+			result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_SLICE);
+		}
+		Clock::time_point finished = Clock::now();
+
+		waitTime += std::chrono::duration<double, std::milli>(finished - waitStart).count();
+		waitedFrames++;
+		Resolve(slot, finished);
+	}
+
+	// replaced by LatchView with when the input was actually sampled
+	slot.inputTime = Clock::now();
+}
+
+void LateLatch::LatchView(const glm::mat4& view, std::chrono::steady_clock::time_point inputTime)
+{
+	if (!IsActive())
+	{
+		return;
+	}
+
+	FrameSlot& slot = CurrentSlot();
+	slot.inputTime = inputTime;
+
+	GLintptr offset = slotStride * (frameIndex % slots.size());
+	if (mapped)
+	{
+		memcpy(mapped + offset, glm::value_ptr(view), sizeof(glm::mat4));
+	}
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(glm::mat4), glm::value_ptr(view));
+	}
+
+	glBindBufferRange(GL_UNIFORM_BUFFER, BLOCK_BINDING, buffer, offset, sizeof(glm::mat4));
+}
+
+void LateLatch::EndFrame()
+{
+	if (!IsActive())
+	{
+		return;
+	}
+
+	CurrentSlot().fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	frameIndex++;
+
+	// a frame that was already finished, like after glFinish, gets its estimate now rather than a few frames late
+	PollFinished();
+}
+
+void LateLatch::Resolve(FrameSlot& slot, Clock::time_point finished)
+{
+	glDeleteSync(slot.fence);
+	slot.fence = nullptr;
+
+	// only when the fence was seen signalled is known, so this is an upper bound on the GPU side
+	lastPhotonLatency = std::chrono::duration<double, std::milli>(finished - slot.inputTime).count() + displayDelay;
+	photonLatencies.RecordValue((uint64_t) (lastPhotonLatency * 1e6 + 0.5));
+}
+
+void LateLatch::PollFinished()
+{
+	Clock::time_point now = Clock::now();
+
+	// oldest first, so the newest finished frame is the one GetLastPhotonLatency reports
+	for (size_t i = 0; i < slots.size(); i++)
+	{
+		FrameSlot& slot = slots[(frameIndex + i) % slots.size()];
+		if (slot.fence)
+		{
+			GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+			{
+				Resolve(slot, now);
+			}
+		}
+	}
+}
+
+void LateLatch::PrintSummary() const
+{
+	if (!IsActive())
+	{
+		return;
+	}
+
+	printf("Low latency mode: %zu frames, waited for the GPU before %zu of them (%.3f ms per frame)\n", frameIndex, waitedFrames,
+	       waitTime / std::max<size_t>(frameIndex, 1));
+
+	if (photonLatencies.getCount() > 0)
+	{
+		printf("  input to photon estimate: mean %.3f p50 %.3f p95 %.3f max %.3f ms (display delay %.3f ms)\n",
+		       photonLatencies.GetMean() / 1e6, photonLatencies.GetValueAtPercentile(50.0) / 1e6,
+		       photonLatencies.GetValueAtPercentile(95.0) / 1e6, photonLatencies.getMax() / 1e6, displayDelay);
+	}
+}
+
+void LateLatch::Shutdown()
+{
+	for (FrameSlot& slot : slots)
+	{
+		if (slot.fence)
+		{
+			glDeleteSync(slot.fence);
+			slot.fence = nullptr;
+		}
+	}
+
+	if (buffer)
+	{
+		if (mapped)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			mapped = nullptr;
+		}
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+	}
+}
+
+LateLatch::~LateLatch()
+{
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <chrono>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include "Histogram.h"
+
+// Low latency mode. A fence after every frame lets BeginFrame hold the CPU back until no more than
+// maxFramesInFlight frames are queued ahead of the GPU, so the input sampled after it is not shown
+// several frames later. The view matrix goes through a uniform buffer that LatchView fills right
+// before the draws are submitted, after culling and recording, with the newest input. Where
+// ARB_buffer_storage exists the buffer stays persistently mapped with one slot per frame in flight,
+// and the fences keep the GPU off a slot while it is rewritten; elsewhere slots go through glBufferSubData.
+class LateLatch
+{
+public:
+	static constexpr GLuint BLOCK_BINDING = 0;
+	static constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 3;
+
+	LateLatch();
+
+	// program needs the LatchedView block, Shader.vert built with LATE_LATCH_VIEW; displayDelay is the
+	// ms from the GPU finishing a frame to the frame being on screen, added to the latency estimates
+	int Initialize(unsigned int maxFramesInFlight, GLuint program, double displayDelay);
+	bool IsActive() const { return buffer != 0; }
+	bool IsPersistent() const { return mapped != nullptr; }
+
+	void BeginFrame(); // waits for the frame maxFramesInFlight frames back, before input is sampled
+	void LatchView(const glm::mat4& view, std::chrono::steady_clock::time_point inputTime);
+	void EndFrame();   // fences everything submitted since BeginFrame, call after the swap
+
+	// estimated ms from the input sample to the photons for the newest frame the GPU finished, 0 before the first
+	double GetLastPhotonLatency() const { return lastPhotonLatency; }
+
+	void PrintSummary() const;
+	void Shutdown();
+
+	~LateLatch();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	static constexpr GLuint64 WAIT_SLICE = 100000000; // ns per glClientWaitSync call, so a lost context cannot hang the wait
+
+	struct FrameSlot
+	{
+		GLsync fence;
+		Clock::time_point inputTime;
+	};
+
+	std::vector<FrameSlot> slots; // one per frame allowed in flight, also indexing the buffer
+	size_t frameIndex;
+	GLuint buffer;
+	GLsizeiptr slotStride; // a view matrix padded to the uniform buffer offset alignment
+	unsigned char* mapped;
+	double displayDelay;
+
+	size_t waitedFrames; // frames BeginFrame actually had to wait for the GPU
+	double waitTime;     // ms, total
+	Histogram photonLatencies; // nanoseconds
+	double lastPhotonLatency;
+
+	FrameSlot& CurrentSlot() { return slots[frameIndex % slots.size()]; }
+
+	void Resolve(FrameSlot& slot, Clock::time_point finished);
+	void PollFinished(); // resolves the frames the GPU finished since the last look, without waiting
+};
@@ -1,5 +1,7 @@
 #include "Light.h"
 
+#include "RenderBackend.h"
+
 Light::Light() : color(glm::vec3(1.0f, 1.0f, 1.0f)), ambientIntensity(1.0f),
                  direction(glm::vec3(0.0f, -1.0f, 0.0f)), diffuseIntensity(0.0f)
 {
@@ -17,11 +19,13 @@ Light::Light(GLfloat red, GLfloat green, GLfloat blue, GLfloat ambIntensity,
 void Light::UseLight(GLuint ambientIntensityLocation, GLuint ambientColorLocation,
                      GLuint diffuseIntensityLocation, GLuint directionLocation)
 {
-    glUniform3f(ambientColorLocation, color.x, color.y, color.z);
-    glUniform1f(ambientIntensityLocation, ambientIntensity);
+    RenderBackend& backend = GetRenderBackend();
+
+    backend.SetUniform(ambientColorLocation, color);
+    backend.SetUniform(ambientIntensityLocation, ambientIntensity);
 
-    glUniform3f(directionLocation, direction.x, direction.y, direction.z);
-    glUniform1f(diffuseIntensityLocation, diffuseIntensity);
+    backend.SetUniform(directionLocation, direction);
+    backend.SetUniform(diffuseIntensityLocation, diffuseIntensity);
 }
 
 Light::~Light()
@@ -13,6 +13,11 @@ public:
 	void UseLight(GLuint ambientIntensityLocation, GLuint ambientColorLocation,
 		          GLuint diffuseIntensityLocation, GLuint directionLocation);
 
+	const glm::vec3& getColor() const { return color; }
+	const glm::vec3& getDirection() const { return direction; }
+	GLfloat getAmbientIntensity() const { return ambientIntensity; }
+	GLfloat getDiffuseIntensity() const { return diffuseIntensity; }
+
 	~Light();
 
 private:
@@ -1,5 +1,7 @@
 #include "Material.h"
 
+#include "RenderBackend.h"
+
 Material::Material() : specularIntensity(0.0f), shininess(0.0f)
 {
 }
@@ -10,8 +12,8 @@ Material::Material(GLfloat sIntensity, GLfloat shine) : specularIntensity(sInten
 
 void Material::UseMaterial(GLuint specularIntensityLocation, GLuint shininessLocation)
 {
-	glUniform1f(specularIntensityLocation, specularIntensity);
-	glUniform1f(shininessLocation, shininess);
+	GetRenderBackend().SetUniform(specularIntensityLocation, specularIntensity);
+	GetRenderBackend().SetUniform(shininessLocation, shininess);
 }
 
 Material::~Material()
@@ -10,6 +10,9 @@ public:
 
 	void UseMaterial(GLuint specularIntensityLocation, GLuint shininess);
 
+	GLfloat getSpecularIntensity() const { return specularIntensity; }
+	GLfloat getShininess() const { return shininess; }
+
 	~Material();
 
 private:
@@ -1,102 +1,277 @@
 #include "Mesh.h"
 
-Mesh::Mesh() : VAO(0), VBO(0), IBO(0), indexCount(0)
+#include <stdio.h>
+
+#include "FrameArena.h"
+#include "MeshSimplifier.h"
+#include "Profiler.h"
+#include "RenderBackend.h"
+
+Mesh::Mesh() : VAO(0), indexCount(0), boundingBox{ glm::vec3(0.0f), glm::vec3(0.0f) }, boundingSphere{ glm::vec3(0.0f), 0.0f }
 {
 }
 
 void Mesh::CreateMesh(const GLfloat* vertices, const unsigned int* indices, unsigned int numOfVertices, unsigned int numOfIndices)
 {
-	constexpr GLsizei NUM_BUFFERS = 1;
-	constexpr GLuint POSITION_ATTRIB_INDEX = 0;
-	constexpr GLuint TEXTURE_COORDINATE_INDEX = 1;
-	constexpr GLint NUM_POSITION_COMPONENTS = 3;
-	constexpr GLint NUM_UV_COMPONENTS = 2;
-	constexpr GLint DIFFUSE_LIGHT_INDEX = 2;
-	constexpr GLint NUM_NORMAL_COMPONENTS = 3;
+	constexpr unsigned int NUM_POSITION_COMPONENTS = 3;
+	constexpr unsigned int NUM_UV_COMPONENTS = 2;
+	constexpr unsigned int NUM_NORMAL_COMPONENTS = 3;
 
 	indexCount = numOfIndices;
 
-	glGenVertexArrays(NUM_BUFFERS, &VAO);
-	glBindVertexArray(VAO);
-
-	glGenBuffers(NUM_BUFFERS, &IBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices[0]) * numOfIndices, indices, GL_STATIC_DRAW);
-
-	glGenBuffers(NUM_BUFFERS, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO); 
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices[0]) * numOfVertices, vertices, GL_STATIC_DRAW);
-
-	GLenum type = GL_FLOAT;
-	GLboolean isNormalized = GL_FALSE;
-	GLsizei stride = sizeof(vertices[0]) * (NUM_POSITION_COMPONENTS + NUM_UV_COMPONENTS + NUM_NORMAL_COMPONENTS);
-	void* offset = (void*) 0;
-	void* offsetTextureCoord = (void*)(sizeof(vertices[0]) * NUM_POSITION_COMPONENTS);
-	void* offsetNormalData = (void*)(sizeof(vertices[0]) * (NUM_POSITION_COMPONENTS + NUM_UV_COMPONENTS));
-	
-	glVertexAttribPointer(POSITION_ATTRIB_INDEX, NUM_POSITION_COMPONENTS, type, isNormalized, stride, offset);
-	glEnableVertexAttribArray(POSITION_ATTRIB_INDEX);
-	glVertexAttribPointer(TEXTURE_COORDINATE_INDEX, NUM_UV_COMPONENTS, type, isNormalized, stride, offsetTextureCoord);
-	glEnableVertexAttribArray(TEXTURE_COORDINATE_INDEX);
-	glVertexAttribPointer(DIFFUSE_LIGHT_INDEX, NUM_NORMAL_COMPONENTS, type, isNormalized, stride, offsetNormalData);
-	glEnableVertexAttribArray(DIFFUSE_LIGHT_INDEX);
-
-	glBindVertexArray(0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	static_assert(VERTEX_LENGTH == NUM_POSITION_COMPONENTS + NUM_UV_COMPONENTS + NUM_NORMAL_COMPONENTS, "vertex layout mismatch");
+	boundingBox = ComputeAABB(vertices, numOfVertices / VERTEX_LENGTH, VERTEX_LENGTH);
+	boundingSphere = ComputeBoundingSphere(vertices, numOfVertices / VERTEX_LENGTH, VERTEX_LENGTH, boundingBox);
+
+	vertexData.assign(vertices, vertices + numOfVertices);
+	indexData.assign(indices, indices + numOfIndices);
+
+	lodIndexData.clear();
+	lods.clear();
+	lods.push_back(LODLevel{ 0, (GLsizei) numOfIndices, 0.0f });
+
+	// attribute locations 0, 1 and 2 in Shader.vert
+	const unsigned int attributeSizes[] = { NUM_POSITION_COMPONENTS, NUM_UV_COMPONENTS, NUM_NORMAL_COMPONENTS };
+	VAO = GetRenderBackend().CreateVertexArray(vertices, numOfVertices, indices, numOfIndices, attributeSizes, sizeof(attributeSizes) / sizeof(attributeSizes[0]));
 }
 
-void Mesh::RenderMesh()
+void Mesh::GenerateLODs(unsigned int maxLevels)
 {
-	// check if object exists
-	if (VAO == 0 || indexCount == 0)
+	constexpr unsigned int TRIANGLE_VERTEX_COUNT = 3;
+	constexpr float LOD_REDUCTION = 0.5f;        // each level targets half the triangles of the previous one
+	constexpr float MIN_USEFUL_REDUCTION = 0.9f; // stop once a level saves less than 10%
+	constexpr size_t MIN_LOD_TRIANGLES = 2;
+
+	if (VAO == 0 || indexData.empty())
 	{
 		return;
 	}
 
-	glBindVertexArray(VAO);
-	//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+	lods.resize(1);
+	lodIndexData.clear();
+
+	std::vector<unsigned int> allIndices = indexData;
+	std::vector<unsigned int> previous = indexData;
+	unsigned int vertexCount = (unsigned int) (vertexData.size() / VERTEX_LENGTH);
+
+	for (unsigned int level = 1; level <= maxLevels; level++)
+	{
+		size_t targetIndexCount = (size_t) (previous.size() / TRIANGLE_VERTEX_COUNT * LOD_REDUCTION) * TRIANGLE_VERTEX_COUNT;
+		if (targetIndexCount < MIN_LOD_TRIANGLES * TRIANGLE_VERTEX_COUNT)
+		{
+			break;
+		}
+
+		// simplify from the previous level so each LOD is a refinement of the next
+		float error = 0.0f;
+		std::vector<unsigned int> simplified = SimplifyMesh(vertexData.data(), vertexCount, VERTEX_LENGTH, previous, targetIndexCount, &error);
+
+		if (simplified.empty() || simplified.size() > previous.size() * MIN_USEFUL_REDUCTION)
+		{
+			break;
+		}
+
+		lods.push_back(LODLevel{ (GLsizei) allIndices.size(), (GLsizei) simplified.size(), glm::max(error, lods.back().error) });
+		allIndices.insert(allIndices.end(), simplified.begin(), simplified.end());
+		previous = simplified;
+	}
+
+	if (lods.size() == 1)
+	{
+		return;
+	}
 
-	GLenum mode = GL_TRIANGLES;
-	GLenum type = GL_UNSIGNED_INT;
-	void* indices = (void*) 0;
+	GetRenderBackend().SetIndices(VAO, allIndices.data(), allIndices.size());
+	lodIndexData.assign(allIndices.begin() + indexData.size(), allIndices.end());
 
-	glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices);
-	//glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
+	printf("Generated %zu LODs:", lods.size());
+	for (const LODLevel& lod : lods)
+	{
+		printf(" %d", lod.indexCount / (GLsizei) TRIANGLE_VERTEX_COUNT);
+	}
+	printf(" triangles\n");
 }
 
-void Mesh::ClearMesh()
+const unsigned int* Mesh::GetLODIndices(unsigned int lod) const
+{
+	if (lod == 0 || lod >= lods.size())
+	{
+		return lod == 0 ? indexData.data() : nullptr;
+	}
+
+	return lodIndexData.data() + (lods[lod].firstIndex - lods[1].firstIndex);
+}
+
+unsigned int Mesh::SelectLOD(float distance, float worldScale, float projectionScale, unsigned int currentLOD) const
+{
+	if (lods.size() <= 1)
+	{
+		return 0;
+	}
+
+	unsigned int lod = glm::min(currentLOD, (unsigned int) lods.size() - 1);
+	float pixelsPerUnit = worldScale * projectionScale / glm::max(distance, 1e-4f);
+
+	// refine while the current level is visibly wrong
+	while (lod > 0 && lods[lod].error * pixelsPerUnit > LOD_PIXEL_ERROR)
+	{
+		lod--;
+	}
+
+	// coarsen only with some margin so objects near the threshold do not pop back and forth
+	while (lod + 1 < lods.size() && lods[lod + 1].error * pixelsPerUnit < LOD_PIXEL_ERROR * (1.0f - LOD_HYSTERESIS))
+	{
+		lod++;
+	}
+
+	return lod;
+}
+
+void Mesh::BuildMeshlets()
+{
+	if (VAO == 0 || indexData.empty())
+	{
+		return;
+	}
+
+	unsigned int vertexCount = (unsigned int) (vertexData.size() / VERTEX_LENGTH);
+	meshlets = ::BuildMeshlets(vertexData.data(), vertexCount, VERTEX_LENGTH, indexData);
+	meshletCuller.SetMeshlets(meshlets);
+
+	// LOD 0 is always first in the index buffer and keeps its size, so only that range is replaced
+	GetRenderBackend().UpdateIndices(VAO, 0, indexData.data(), indexData.size());
+}
+
+void Mesh::CullMeshlets(const glm::mat4& model, const Frustum& worldFrustum, const glm::vec3& cameraPosition, std::vector<MeshletRange>& ranges)
+{
+	Frustum objectFrustum = TransformFrustum(worldFrustum, model);
+	glm::vec3 objectCameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(cameraPosition, 1.0f));
+
+	meshletCuller.Cull(objectFrustum, objectCameraPosition, ranges);
+}
+
+size_t Mesh::GetScratchSize() const
+{
+	// the backend gets at most one range per meshlet, as counts and offsets
+	size_t rangeScratch = meshlets.size() * (sizeof(GLsizei) + sizeof(const void*)) + alignof(GLsizei) + alignof(const void*);
+	return meshlets.empty() ? 0 : meshletCuller.GetScratchSize() + rangeScratch;
+}
+
+void Mesh::RenderRanges(const std::vector<MeshletRange>& ranges)
+{
+	RenderRanges(ranges.data(), ranges.size());
+}
+
+void Mesh::RenderRanges(const MeshletRange* ranges, size_t rangeCount)
 {
-	constexpr int NUM_BUFFERS_TO_DELETE = 1;
+	PROFILE_SCOPE("Mesh::RenderRanges");
 
-	if (IBO != 0)
+	if (VAO == 0 || rangeCount == 0)
 	{
-		// delete index buffer object from graphics card memory
-		
-		glDeleteBuffers(NUM_BUFFERS_TO_DELETE, &IBO);
-		IBO = 0;
+		return;
+	}
+
+	// scratch arrays for glMultiDrawElements from the thread's frame arena; grown vectors kept between frames
+	// still allocated whenever more ranges survived culling than ever before
+	FrameArena& arena = GetFrameArena();
+	GLsizei* rangeCounts = arena.AllocateArray<GLsizei>(rangeCount);
+	const void** rangeOffsets = arena.AllocateArray<const void*>(rangeCount);
+	for (size_t i = 0; i < rangeCount; i++)
+	{
+		rangeCounts[i] = (GLsizei) ranges[i].indexCount;
+		rangeOffsets[i] = (const void*) (sizeof(GLuint) * ranges[i].firstIndex);
 	}
 
-	if (VBO != 0)
+	GetRenderBackend().DrawIndexedRanges(VAO, rangeCounts, rangeOffsets, (GLsizei) rangeCount);
+}
+
+void Mesh::RenderMesh(unsigned int lod)
+{
+	PROFILE_SCOPE("Mesh::RenderMesh");
+
+	// check if object exists
+	if (VAO == 0 || indexCount == 0)
 	{
-		// delete vertex buffer object from graphics card memory
-		glDeleteBuffers(NUM_BUFFERS_TO_DELETE, &VBO);
-		VBO = 0;
+		return;
 	}
 
+	if (lod >= lods.size())
+	{
+		lod = (unsigned int) lods.size() - 1;
+	}
+
+	GetRenderBackend().DrawIndexed(VAO, lods[lod].firstIndex, lods[lod].indexCount);
+}
+
+void Mesh::ClearMesh()
+{
 	if (VAO != 0)
 	{
-		// delete vertex array object from graphics card memory
-		glDeleteVertexArrays(NUM_BUFFERS_TO_DELETE, &VAO);
+		// delete vertex array and its buffers from graphics card memory
+		GetRenderBackend().DestroyVertexArray(VAO);
 		VAO = 0;
 	}
 
 	indexCount = 0;
+	boundingBox = AABB{ glm::vec3(0.0f), glm::vec3(0.0f) };
+	boundingSphere = BoundingSphere{ glm::vec3(0.0f), 0.0f };
+
+	vertexData.clear();
+	indexData.clear();
+	lodIndexData.clear();
+	lods.clear();
+	meshlets.clear();
+	meshletCuller.Clear();
 }
 
 Mesh::~Mesh()
 {
 	ClearMesh();
-}
\ No newline at end of file
+}
+
+void calcAverageNormals(unsigned int* indices, unsigned int indiceCount, float* vertices, unsigned int verticeCount, 
+	                    unsigned int vertexLength, unsigned int normalOffset)
+{
+	constexpr unsigned int TRIANGLE_VERTEX_COUNT = 3;
+
+	// obtain normal vectors
+	for (size_t i = 0; i < indiceCount; i += TRIANGLE_VERTEX_COUNT)
+	{
+		unsigned int in0 = indices[i] * vertexLength;
+		unsigned int in1 = indices[i + 1] * vertexLength;
+		unsigned int in2 = indices[i + 2] * vertexLength;
+
+		glm::vec3 v1(vertices[in1] - vertices[in0], vertices[in1 + 1] - vertices[in0 + 1], vertices[in1 + 2] - vertices[in0 + 2]);
+		glm::vec3 v2(vertices[in2] - vertices[in0], vertices[in2 + 1] - vertices[in0 + 1], vertices[in2 + 2] - vertices[in0 + 2]);
+		glm::vec3 normal = glm::cross(v1, v2);
+		normal = glm::normalize(normal);
+
+		in0 += normalOffset;
+		in1 += normalOffset;
+		in2 += normalOffset;
+
+		vertices[in0]     += normal.x;
+		vertices[in0 + 1] += normal.y;
+		vertices[in0 + 2] += normal.z;
+
+		vertices[in1]     += normal.x;
+		vertices[in1 + 1] += normal.y;
+		vertices[in1 + 2] += normal.z;
+
+		vertices[in2]     += normal.x;
+		vertices[in2 + 1] += normal.y;
+		vertices[in2 + 2] += normal.z;
+	}
+
+	// per row normalized normal vectors
+	for (size_t i = 0; i < verticeCount / vertexLength; i++)
+	{
+		unsigned int normalOffsetPerVertex = i * vertexLength + normalOffset;
+		glm::vec3 vec(vertices[normalOffsetPerVertex], vertices[normalOffsetPerVertex + 1], vertices[normalOffsetPerVertex + 2]);
+		vec = glm::normalize(vec);
+
+		vertices[normalOffsetPerVertex]     = vec.x;
+		vertices[normalOffsetPerVertex + 1] = vec.y;
+		vertices[normalOffsetPerVertex + 2] = vec.z;
+	}
+}
@@ -1,21 +1,84 @@
 #pragma once
 
+#include <vector>
+
 #include <GL/glew.h>
 
+#include "Bounds.h"
+#include "Meshlet.h"
+
 class Mesh
 {
 public:
 	Mesh();
 
 	void CreateMesh(const GLfloat *vertices, const unsigned int *indices, unsigned int numOfVertices, unsigned int numOfIndices);  // create the mesh
-	void RenderMesh();  // draw mesh to screen
+	void RenderMesh(unsigned int lod = 0);  // draw mesh to screen
 	void ClearMesh();   // clear the mesh from graphics card memory
 
+	// simplify the mesh into up to maxLevels coarser index lists, stored after LOD 0 in the same index buffer
+	void GenerateLODs(unsigned int maxLevels);
+
+	// pick a LOD from its projected error in pixels, distance and worldScale are in world units,
+	// projectionScale converts world size at distance 1 to pixels (projection[1][1] * viewport height / 2)
+	unsigned int SelectLOD(float distance, float worldScale, float projectionScale, unsigned int currentLOD) const;
+
+	// split LOD 0 into meshlets, reordering its indices so each meshlet is one contiguous range
+	void BuildMeshlets();
+	bool HasMeshlets() const { return !meshlets.empty(); }
+	size_t GetMeshletCount() const { return meshlets.size(); }
+	size_t GetScratchSize() const; // most frame arena bytes CullMeshlets and RenderRanges take together
+
+	// world space frustum and camera, appends the index ranges of LOD 0 that survive cone and frustum culling
+	void CullMeshlets(const glm::mat4& model, const Frustum& worldFrustum, const glm::vec3& cameraPosition, std::vector<MeshletRange>& ranges);
+	void RenderRanges(const std::vector<MeshletRange>& ranges);
+	void RenderRanges(const MeshletRange* ranges, size_t rangeCount);
+	const MeshletCuller& GetMeshletCuller() const { return meshletCuller; }
+
+	unsigned int GetLODCount() const { return (unsigned int) lods.size(); }
+	GLsizei GetIndexCount(unsigned int lod = 0) const { return lod < lods.size() ? lods[lod].indexCount : 0; }
+	const unsigned int* GetLODIndices(unsigned int lod) const; // CPU side indices of one LOD, GetIndexCount(lod) of them
+
+	const AABB& GetAABB() const { return boundingBox; }
+	const BoundingSphere& GetBoundingSphere() const { return boundingSphere; }
+
+	// CPU side copy of what was uploaded, used by culling and other CPU passes
+	const std::vector<GLfloat>& GetVertices() const { return vertexData; }
+	const std::vector<unsigned int>& GetIndices() const { return indexData; }
+	unsigned int GetVertexLength() const { return VERTEX_LENGTH; }
+
 	~Mesh();
 
 private:
-	GLuint VAO;
-	GLuint VBO;
-	GLuint IBO;
+	struct LODLevel
+	{
+		GLsizei firstIndex; // offset into the shared index buffer
+		GLsizei indexCount;
+		float error;        // object space simplification error
+	};
+
+	static constexpr unsigned int VERTEX_LENGTH = 8; // XYZ UV normal
+	static constexpr float LOD_PIXEL_ERROR = 1.0f;   // coarsest LOD whose error projects below this many pixels is used
+	static constexpr float LOD_HYSTERESIS = 0.25f;   // only coarsen once the error is this fraction below the threshold
+
+	GLuint VAO; // render backend handle, owns the vertex and index buffers
 	GLsizei indexCount;
-};
\ No newline at end of file
+
+	// object space bounds, computed from the vertex positions in CreateMesh
+	AABB boundingBox;
+	BoundingSphere boundingSphere;
+
+	std::vector<GLfloat> vertexData;
+	std::vector<unsigned int> indexData;
+	std::vector<unsigned int> lodIndexData; // LODs after the first, back to back as in the index buffer
+
+	std::vector<LODLevel> lods;
+
+	std::vector<Meshlet> meshlets;
+	MeshletCuller meshletCuller;
+};
+
+// sums the face normals around each vertex into its normal components and normalizes them,
+// vertexLength floats per vertex with the normal normalOffset floats in
+void calcAverageNormals(unsigned int* indices, unsigned int indiceCount, float* vertices, unsigned int verticeCount,
+	                    unsigned int vertexLength, unsigned int normalOffset);
@@ -0,0 +1,321 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+namespace
+{
+	constexpr unsigned int TRIANGLE_VERTEX_COUNT = 3;
+	constexpr double BOUNDARY_WEIGHT = 10.0; // keeps open edges from shrinking inwards
+
+	// symmetric 4x4 matrix stored as its upper triangle
+	struct Quadric
+	{
+		double a00, a01, a02, a03;
+		double a11, a12, a13;
+		double a22, a23;
+		double a33;
+		double weight; // total plane weight, dividing by it turns the error into a mean squared distance
+	};
+
+	Quadric MakeQuadric(const glm::dvec3& normal, double distance, double weight)
+	{
+		return Quadric{
+			normal.x * normal.x * weight, normal.x * normal.y * weight, normal.x * normal.z * weight, normal.x * distance * weight,
+			normal.y * normal.y * weight, normal.y * normal.z * weight, normal.y * distance * weight,
+			normal.z * normal.z * weight, normal.z * distance * weight,
+			distance * distance * weight,
+			weight
+		};
+	}
+
+	void AddQuadric(Quadric& target, const Quadric& other)
+	{
+		target.a00 += other.a00; target.a01 += other.a01; target.a02 += other.a02; target.a03 += other.a03;
+		target.a11 += other.a11; target.a12 += other.a12; target.a13 += other.a13;
+		target.a22 += other.a22; target.a23 += other.a23;
+		target.a33 += other.a33;
+		target.weight += other.weight;
+	}
+
+	double EvaluateQuadric(const Quadric& q, const glm::vec3& p)
+	{
+		double x = p.x, y = p.y, z = p.z;
+
+		double error = q.a00 * x * x + 2.0 * q.a01 * x * y + 2.0 * q.a02 * x * z + 2.0 * q.a03 * x
+		             + q.a11 * y * y + 2.0 * q.a12 * y * z + 2.0 * q.a13 * y
+		             + q.a22 * z * z + 2.0 * q.a23 * z
+		             + q.a33;
+
+		return q.weight > 0.0 ? std::max(0.0, error) / q.weight : 0.0;
+	}
+
+	struct Collapse
+	{
+		unsigned int from;
+		unsigned int to;
+		double cost;
+	};
+
+	// moving "from" onto "to" must not turn any surviving triangle around it inside out
+	bool CollapseFlipsTriangle(const std::vector<glm::vec3>& positions, const std::vector<unsigned int>& indices,
+	                           const std::vector<unsigned int>& triangleOffsets, const std::vector<unsigned int>& vertexTriangles,
+	                           unsigned int from, unsigned int to)
+	{
+		for (unsigned int i = triangleOffsets[from]; i < triangleOffsets[from + 1]; i++)
+		{
+			const unsigned int* triangle = &indices[vertexTriangles[i] * TRIANGLE_VERTEX_COUNT];
+
+			if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+			{
+				continue; // this triangle collapses away
+			}
+
+			glm::vec3 before[TRIANGLE_VERTEX_COUNT];
+			glm::vec3 after[TRIANGLE_VERTEX_COUNT];
+			for (unsigned int k = 0; k < TRIANGLE_VERTEX_COUNT; k++)
+			{
+				before[k] = positions[triangle[k]];
+				after[k] = triangle[k] == from ? positions[to] : positions[triangle[k]];
+			}
+
+			glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+			glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+			if (glm::dot(normalBefore, normalAfter) <= 0.0f)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+std::vector<unsigned int> SimplifyMesh(const float* vertices, unsigned int vertexCount, unsigned int vertexLength,
+                                       const std::vector<unsigned int>& indices, size_t targetIndexCount, float* resultError)
+{
+	std::vector<unsigned int> result = indices;
+	double maxError = 0.0;
+
+	std::vector<glm::vec3> positions(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const float* position = vertices + i * vertexLength;
+		positions[i] = glm::vec3(position[0], position[1], position[2]);
+	}
+
+	// every vertex starts with the planes of the triangles around it, weighted by area
+	std::vector<Quadric> quadrics(vertexCount, Quadric{});
+
+	struct TriangleEdge
+	{
+		unsigned int a;
+		unsigned int b;
+		unsigned int triangle;
+	};
+	std::vector<TriangleEdge> triangleEdges;
+
+	for (size_t i = 0; i + 2 < result.size(); i += TRIANGLE_VERTEX_COUNT)
+	{
+		glm::dvec3 p0 = positions[result[i]], p1 = positions[result[i + 1]], p2 = positions[result[i + 2]];
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double area = glm::length(normal);
+
+		if (area > 0.0)
+		{
+			normal /= area;
+			Quadric plane = MakeQuadric(normal, -glm::dot(normal, p0), area * 0.5);
+			for (unsigned int k = 0; k < TRIANGLE_VERTEX_COUNT; k++)
+			{
+				AddQuadric(quadrics[result[i + k]], plane);
+			}
+		}
+
+		for (unsigned int k = 0; k < TRIANGLE_VERTEX_COUNT; k++)
+		{
+			unsigned int a = result[i + k];
+			unsigned int b = result[i + (k + 1) % TRIANGLE_VERTEX_COUNT];
+			triangleEdges.push_back(TriangleEdge{ std::min(a, b), std::max(a, b), (unsigned int) (i / TRIANGLE_VERTEX_COUNT) });
+		}
+	}
+
+	// edges used by a single triangle are on the boundary, add a plane perpendicular to the surface through them
+	std::sort(triangleEdges.begin(), triangleEdges.end(), [](const TriangleEdge& x, const TriangleEdge& y) {
+		return x.a != y.a ? x.a < y.a : x.b < y.b;
+	});
+	for (size_t i = 0; i < triangleEdges.size(); )
+	{
+		size_t j = i + 1;
+		while (j < triangleEdges.size() && triangleEdges[j].a == triangleEdges[i].a && triangleEdges[j].b == triangleEdges[i].b)
+		{
+			j++;
+		}
+
+		if (j - i == 1)
+		{
+			const TriangleEdge& edge = triangleEdges[i];
+			const unsigned int* triangle = &result[edge.triangle * TRIANGLE_VERTEX_COUNT];
+
+			glm::dvec3 p0 = positions[triangle[0]], p1 = positions[triangle[1]], p2 = positions[triangle[2]];
+			glm::dvec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+			glm::dvec3 edgeStart = positions[edge.a];
+			glm::dvec3 edgeVector = glm::dvec3(positions[edge.b]) - edgeStart;
+			glm::dvec3 normal = glm::cross(edgeVector, faceNormal);
+			double length = glm::length(normal);
+
+			if (length > 0.0)
+			{
+				normal /= length;
+				Quadric plane = MakeQuadric(normal, -glm::dot(normal, edgeStart), BOUNDARY_WEIGHT * glm::dot(edgeVector, edgeVector));
+				AddQuadric(quadrics[edge.a], plane);
+				AddQuadric(quadrics[edge.b], plane);
+			}
+		}
+
+		i = j;
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> edges;
+	std::vector<unsigned int> remap(vertexCount);
+	std::vector<unsigned int> triangleOffsets(vertexCount + 1);
+	std::vector<unsigned int> vertexTriangles;
+	std::vector<char> locked(vertexCount);
+	std::vector<Collapse> collapses;
+
+	// each pass collapses an independent set of the cheapest edges, then rebuilds the index list
+	while (result.size() > targetIndexCount)
+	{
+		size_t triangleCount = result.size() / TRIANGLE_VERTEX_COUNT;
+
+		edges.clear();
+		for (size_t i = 0; i < result.size(); i += TRIANGLE_VERTEX_COUNT)
+		{
+			for (unsigned int k = 0; k < TRIANGLE_VERTEX_COUNT; k++)
+			{
+				unsigned int a = result[i + k];
+				unsigned int b = result[i + (k + 1) % TRIANGLE_VERTEX_COUNT];
+				edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		collapses.clear();
+		for (const std::pair<unsigned int, unsigned int>& edge : edges)
+		{
+			Quadric combined = quadrics[edge.first];
+			AddQuadric(combined, quadrics[edge.second]);
+
+			double costToSecond = EvaluateQuadric(combined, positions[edge.second]);
+			double costToFirst = EvaluateQuadric(combined, positions[edge.first]);
+
+			if (costToSecond <= costToFirst)
+			{
+				collapses.push_back(Collapse{ edge.first, edge.second, costToSecond });
+			}
+			else
+			{
+				collapses.push_back(Collapse{ edge.second, edge.first, costToFirst });
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		// vertex -> triangle adjacency as offsets into one flat list
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+		for (unsigned int index : result)
+		{
+			triangleOffsets[index + 1]++;
+		}
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			triangleOffsets[i + 1] += triangleOffsets[i];
+		}
+		vertexTriangles.resize(result.size());
+		std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			vertexTriangles[fill[result[i]]++] = (unsigned int) (i / TRIANGLE_VERTEX_COUNT);
+		}
+
+		for (unsigned int i = 0; i < vertexCount; i++)
+		{
+			remap[i] = i;
+		}
+		std::fill(locked.begin(), locked.end(), 0);
+
+		size_t trianglesToRemove = (result.size() - targetIndexCount + TRIANGLE_VERTEX_COUNT - 1) / TRIANGLE_VERTEX_COUNT;
+		size_t trianglesRemoved = 0;
+		size_t collapsesApplied = 0;
+
+		for (const Collapse& collapse : collapses)
+		{
+			if (trianglesRemoved >= trianglesToRemove)
+			{
+				break;
+			}
+
+			if (locked[collapse.from] || locked[collapse.to])
+			{
+				continue;
+			}
+
+			if (CollapseFlipsTriangle(positions, result, triangleOffsets, vertexTriangles, collapse.from, collapse.to))
+			{
+				continue;
+			}
+
+			remap[collapse.from] = collapse.to;
+			AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+			maxError = std::max(maxError, collapse.cost);
+			collapsesApplied++;
+
+			// lock the whole neighbourhood so adjacency stays valid for the rest of this pass
+			for (unsigned int v : { collapse.from, collapse.to })
+			{
+				for (unsigned int i = triangleOffsets[v]; i < triangleOffsets[v + 1]; i++)
+				{
+					const unsigned int* triangle = &result[vertexTriangles[i] * TRIANGLE_VERTEX_COUNT];
+					locked[triangle[0]] = locked[triangle[1]] = locked[triangle[2]] = 1;
+
+					if (v == collapse.from && (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to))
+					{
+						trianglesRemoved++;
+					}
+				}
+			}
+		}
+
+		if (collapsesApplied == 0)
+		{
+			break; // nothing left that can be collapsed without flipping
+		}
+
+		size_t writeIndex = 0;
+		for (size_t i = 0; i < triangleCount; i++)
+		{
+			unsigned int a = remap[result[i * TRIANGLE_VERTEX_COUNT]];
+			unsigned int b = remap[result[i * TRIANGLE_VERTEX_COUNT + 1]];
+			unsigned int c = remap[result[i * TRIANGLE_VERTEX_COUNT + 2]];
+
+			if (a == b || b == c || c == a)
+			{
+				continue;
+			}
+
+			result[writeIndex++] = a;
+			result[writeIndex++] = b;
+			result[writeIndex++] = c;
+		}
+		result.resize(writeIndex);
+	}
+
+	if (resultError)
+	{
+		*resultError = (float) std::sqrt(maxError);
+	}
+
+	return result;
+}
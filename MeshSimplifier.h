@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// Quadric error metric simplification by edge collapse (Garland-Heckbert).
+// Vertices are only ever collapsed onto other existing vertices, so the result is a new
+// index list that still references the original vertex buffer.
+// Returns the simplified indices and writes the largest collapse error (object space distance) to resultError.
+std::vector<unsigned int> SimplifyMesh(const float* vertices, unsigned int vertexCount, unsigned int vertexLength,
+                                       const std::vector<unsigned int>& indices, size_t targetIndexCount, float* resultError);
@@ -0,0 +1,423 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include <emmintrin.h>
+
+#include "FrameArena.h"
+#include "JobSystem.h"
+
+namespace
+{
+	constexpr unsigned int TRIANGLE_VERTEX_COUNT = 3;
+	constexpr unsigned int NO_MESHLET = 0xffffffffu;
+
+	glm::vec3 GetPosition(const float* vertices, unsigned int vertexLength, unsigned int index)
+	{
+		const float* position = vertices + index * vertexLength;
+		return glm::vec3(position[0], position[1], position[2]);
+	}
+
+	void FinishMeshlet(Meshlet& meshlet, const float* vertices, unsigned int vertexLength, const std::vector<unsigned int>& triangles,
+	                   const std::vector<unsigned int>& meshletVertices)
+	{
+		AABB box{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) };
+		for (unsigned int vertex : meshletVertices)
+		{
+			glm::vec3 p = GetPosition(vertices, vertexLength, vertex);
+			box.min = glm::min(box.min, p);
+			box.max = glm::max(box.max, p);
+		}
+
+		meshlet.bounds.center = (box.min + box.max) * 0.5f;
+		meshlet.bounds.radius = 0.0f;
+		for (unsigned int vertex : meshletVertices)
+		{
+			meshlet.bounds.radius = std::max(meshlet.bounds.radius, glm::length(GetPosition(vertices, vertexLength, vertex) - meshlet.bounds.center));
+		}
+
+		// cone axis is the average face normal, the cutoff comes from the widest normal around it
+		std::vector<glm::vec3> normals;
+		glm::vec3 axis{ 0.0f };
+		for (size_t i = 0; i < triangles.size(); i += TRIANGLE_VERTEX_COUNT)
+		{
+			glm::vec3 p0 = GetPosition(vertices, vertexLength, triangles[i]);
+			glm::vec3 p1 = GetPosition(vertices, vertexLength, triangles[i + 1]);
+			glm::vec3 p2 = GetPosition(vertices, vertexLength, triangles[i + 2]);
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float length = glm::length(normal);
+
+			if (length > 0.0f)
+			{
+				normals.push_back(normal / length);
+				axis += normals.back();
+			}
+		}
+
+		float axisLength = glm::length(axis);
+		meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+		meshlet.coneCutoff = 1.0f;
+
+		if (axisLength > 0.0f && !normals.empty())
+		{
+			float minDot = 1.0f;
+			for (const glm::vec3& normal : normals)
+			{
+				minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+			}
+
+			// a cone wider than 90 degrees always has some front facing triangle
+			if (minDot > 0.0f)
+			{
+				meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+		}
+	}
+}
+
+std::vector<Meshlet> BuildMeshlets(const float* vertices, unsigned int vertexCount, unsigned int vertexLength, std::vector<unsigned int>& indices)
+{
+	std::vector<Meshlet> meshlets;
+	size_t triangleCount = indices.size() / TRIANGLE_VERTEX_COUNT;
+
+	if (triangleCount == 0)
+	{
+		return meshlets;
+	}
+
+	// vertex -> triangle adjacency, used to grow each meshlet through its own vertices
+	std::vector<unsigned int> triangleOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * TRIANGLE_VERTEX_COUNT; i++)
+	{
+		triangleOffsets[indices[i] + 1]++;
+	}
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		triangleOffsets[i + 1] += triangleOffsets[i];
+	}
+	std::vector<unsigned int> vertexTriangles(triangleCount * TRIANGLE_VERTEX_COUNT);
+	std::vector<unsigned int> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+	for (size_t i = 0; i < triangleCount * TRIANGLE_VERTEX_COUNT; i++)
+	{
+		vertexTriangles[fill[indices[i]]++] = (unsigned int) (i / TRIANGLE_VERTEX_COUNT);
+	}
+
+	std::vector<char> triangleUsed(triangleCount, 0);
+	std::vector<unsigned int> vertexMeshlet(vertexCount, NO_MESHLET); // which meshlet last referenced each vertex
+
+	std::vector<unsigned int> reordered;
+	reordered.reserve(indices.size());
+
+	std::vector<unsigned int> meshletTriangles;
+	std::vector<unsigned int> meshletVertices;
+	size_t nextSeed = 0;
+
+	while (true)
+	{
+		while (nextSeed < triangleCount && triangleUsed[nextSeed])
+		{
+			nextSeed++;
+		}
+		if (nextSeed == triangleCount)
+		{
+			break;
+		}
+
+		unsigned int meshletIndex = (unsigned int) meshlets.size();
+		meshletTriangles.clear();
+		meshletVertices.clear();
+
+		unsigned int candidate = (unsigned int) nextSeed;
+
+		while (candidate != NO_MESHLET)
+		{
+			const unsigned int* triangle = &indices[candidate * TRIANGLE_VERTEX_COUNT];
+			triangleUsed[candidate] = 1;
+
+			for (unsigned int k = 0; k < TRIANGLE_VERTEX_COUNT; k++)
+			{
+				meshletTriangles.push_back(triangle[k]);
+				if (vertexMeshlet[triangle[k]] != meshletIndex)
+				{
+					vertexMeshlet[triangle[k]] = meshletIndex;
+					meshletVertices.push_back(triangle[k]);
+				}
+			}
+
+			if (meshletTriangles.size() / TRIANGLE_VERTEX_COUNT >= MESHLET_MAX_TRIANGLES)
+			{
+				break;
+			}
+
+			// next triangle: the unused neighbour adding the fewest new vertices
+			candidate = NO_MESHLET;
+			unsigned int bestNewVertices = TRIANGLE_VERTEX_COUNT + 1;
+
+			for (unsigned int vertex : meshletVertices)
+			{
+				for (unsigned int i = triangleOffsets[vertex]; i < triangleOffsets[vertex + 1]; i++)
+				{
+					unsigned int neighbour = vertexTriangles[i];
+					if (triangleUsed[neighbour])
+					{
+						continue;
+					}
+
+					const unsigned int* other = &indices[neighbour * TRIANGLE_VERTEX_COUNT];
+					unsigned int newVertices = 0;
+					for (unsigned int k = 0; k < TRIANGLE_VERTEX_COUNT; k++)
+					{
+						newVertices += vertexMeshlet[other[k]] != meshletIndex ? 1 : 0;
+					}
+
+					if (newVertices < bestNewVertices && meshletVertices.size() + newVertices <= MESHLET_MAX_VERTICES)
+					{
+						bestNewVertices = newVertices;
+						candidate = neighbour;
+					}
+				}
+
+				if (bestNewVertices == 0)
+				{
+					break;
+				}
+			}
+		}
+
+		Meshlet meshlet{};
+		meshlet.firstIndex = (unsigned int) reordered.size();
+		meshlet.triangleCount = (unsigned int) (meshletTriangles.size() / TRIANGLE_VERTEX_COUNT);
+		meshlet.vertexCount = (unsigned int) meshletVertices.size();
+		FinishMeshlet(meshlet, vertices, vertexLength, meshletTriangles, meshletVertices);
+
+		reordered.insert(reordered.end(), meshletTriangles.begin(), meshletTriangles.end());
+		meshlets.push_back(meshlet);
+	}
+
+	indices.swap(reordered);
+
+	return meshlets;
+}
+
+MeshletCuller::MeshletCuller() : meshletCount(0), visibleCount(0), backfaceCulledCount(0), frustumCulledCount(0)
+{
+}
+
+void MeshletCuller::SetMeshlets(const std::vector<Meshlet>& meshlets)
+{
+	Clear();
+
+	meshletCount = meshlets.size();
+	size_t padded = (meshletCount + LANES - 1) / LANES * LANES;
+
+	// padding lanes have a negative radius so they fail the frustum test
+	centerX.assign(padded, 0.0f);
+	centerY.assign(padded, 0.0f);
+	centerZ.assign(padded, 0.0f);
+	radius.assign(padded, -FLT_MAX);
+	axisX.assign(padded, 0.0f);
+	axisY.assign(padded, 0.0f);
+	axisZ.assign(padded, 0.0f);
+	cutoff.assign(padded, 1.0f);
+	firstIndex.assign(padded, 0);
+	indexCount.assign(padded, 0);
+
+	for (size_t i = 0; i < meshletCount; i++)
+	{
+		const Meshlet& meshlet = meshlets[i];
+		centerX[i] = meshlet.bounds.center.x;
+		centerY[i] = meshlet.bounds.center.y;
+		centerZ[i] = meshlet.bounds.center.z;
+		radius[i] = meshlet.bounds.radius;
+		axisX[i] = meshlet.coneAxis.x;
+		axisY[i] = meshlet.coneAxis.y;
+		axisZ[i] = meshlet.coneAxis.z;
+		cutoff[i] = meshlet.coneCutoff;
+		firstIndex[i] = meshlet.firstIndex;
+		indexCount[i] = meshlet.triangleCount * TRIANGLE_VERTEX_COUNT;
+	}
+}
+
+void MeshletCuller::Clear()
+{
+	centerX.clear();
+	centerY.clear();
+	centerZ.clear();
+	radius.clear();
+	axisX.clear();
+	axisY.clear();
+	axisZ.clear();
+	cutoff.clear();
+	firstIndex.clear();
+	indexCount.clear();
+
+	meshletCount = 0;
+	visibleCount = 0;
+	backfaceCulledCount = 0;
+	frustumCulledCount = 0;
+}
+
+void MeshletCuller::CullRange(size_t begin, size_t end, const Frustum& objectFrustum, const glm::vec3& objectCameraPosition, ChunkResult& result) const
+{
+	result.rangeCount = 0;
+	result.visible = 0;
+	result.backfaceCulled = 0;
+	result.frustumCulled = 0;
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 cameraX = _mm_set1_ps(objectCameraPosition.x);
+	const __m128 cameraY = _mm_set1_ps(objectCameraPosition.y);
+	const __m128 cameraZ = _mm_set1_ps(objectCameraPosition.z);
+
+	for (size_t i = begin; i < end; i += LANES)
+	{
+		__m128 x = _mm_loadu_ps(&centerX[i]);
+		__m128 y = _mm_loadu_ps(&centerY[i]);
+		__m128 z = _mm_loadu_ps(&centerZ[i]);
+		__m128 r = _mm_loadu_ps(&radius[i]);
+
+		__m128 inFrustum = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < Frustum::NUM_PLANES; p++)
+		{
+			const glm::vec4& plane = objectFrustum.planes[p];
+			__m128 distance = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(plane.z)));
+			distance = _mm_add_ps(distance, _mm_add_ps(_mm_set1_ps(plane.w), r));
+			inFrustum = _mm_and_ps(inFrustum, _mm_cmpge_ps(distance, zero));
+		}
+
+		// back facing when dot(center - camera, axis) >= cutoff * |center - camera| + radius
+		__m128 dx = _mm_sub_ps(x, cameraX);
+		__m128 dy = _mm_sub_ps(y, cameraY);
+		__m128 dz = _mm_sub_ps(z, cameraZ);
+		__m128 distanceToCamera = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+		__m128 alongAxis = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&axisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&axisY[i]))),
+		                              _mm_mul_ps(dz, _mm_loadu_ps(&axisZ[i])));
+		__m128 limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&cutoff[i]), distanceToCamera), r);
+		__m128 backFacing = _mm_cmpge_ps(alongAxis, limit);
+
+		int frustumMask = _mm_movemask_ps(inFrustum);
+		int visibleMask = frustumMask & ~_mm_movemask_ps(backFacing);
+
+		for (size_t lane = 0; lane < LANES && i + lane < end; lane++)
+		{
+			if (i + lane >= meshletCount)
+			{
+				break;
+			}
+
+			if (!(frustumMask & (1 << lane)))
+			{
+				result.frustumCulled++;
+				continue;
+			}
+
+			if (!(visibleMask & (1 << lane)))
+			{
+				result.backfaceCulled++;
+				continue;
+			}
+
+			result.visible++;
+
+			// meshlets are contiguous in the index buffer, so neighbours that both survive merge into one draw
+			unsigned int first = firstIndex[i + lane];
+			unsigned int count = indexCount[i + lane];
+			MeshletRange* last = result.rangeCount > 0 ? &result.ranges[result.rangeCount - 1] : nullptr;
+			if (last && last->firstIndex + last->indexCount == first)
+			{
+				last->indexCount += count;
+			}
+			else
+			{
+				result.ranges[result.rangeCount++] = MeshletRange{ first, count };
+			}
+		}
+	}
+}
+
+size_t MeshletCuller::GetScratchSize() const
+{
+	if (centerX.empty())
+	{
+		return 0;
+	}
+
+	size_t chunkCount = 1;
+	if (meshletCount >= PARALLEL_THRESHOLD)
+	{
+		chunkCount = std::max(1u, GetJobThreadCount()) * CHUNKS_PER_THREAD;
+	}
+
+	// the same arrays Cull allocates, each with room to align it
+	return chunkCount * (sizeof(ChunkResult) + alignof(MeshletRange)) + alignof(ChunkResult) + centerX.size() * sizeof(MeshletRange);
+}
+
+void MeshletCuller::Cull(const Frustum& objectFrustum, const glm::vec3& objectCameraPosition, std::vector<MeshletRange>& ranges)
+{
+	visibleCount = 0;
+	backfaceCulledCount = 0;
+	frustumCulledCount = 0;
+
+	size_t padded = centerX.size();
+	if (padded == 0)
+	{
+		return;
+	}
+
+	// a few chunks per job thread so the ones that finish early can steal the rest
+	size_t chunkCount = 1;
+	if (meshletCount >= PARALLEL_THRESHOLD)
+	{
+		chunkCount = std::max(1u, GetJobThreadCount()) * CHUNKS_PER_THREAD;
+	}
+
+	// chunk boundaries stay on SIMD lane boundaries
+	size_t chunkSize = (padded / LANES + chunkCount - 1) / chunkCount * LANES;
+
+	// scratch for this call comes from the frame arena, sized up front so the chunk jobs never allocate
+	FrameArena& arena = GetFrameArena();
+	ChunkResult* results = arena.AllocateArray<ChunkResult>(chunkCount);
+	for (size_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		size_t begin = std::min(padded, chunk * chunkSize);
+		results[chunk].ranges = arena.AllocateArray<MeshletRange>(std::min(padded, begin + chunkSize) - begin);
+	}
+
+	// runs inline when called from a thread outside the job system, like the pipelined simulation
+	ParallelFor(chunkCount, [&](size_t chunkBegin, size_t chunkEnd) {
+		for (size_t chunk = chunkBegin; chunk < chunkEnd; chunk++)
+		{
+			size_t begin = std::min(padded, chunk * chunkSize);
+			CullRange(begin, std::min(padded, begin + chunkSize), objectFrustum, objectCameraPosition, results[chunk]);
+		}
+	}, 1);
+
+	// chunks are in index buffer order, so appending them keeps the ranges sorted
+	for (size_t chunk = 0; chunk < chunkCount; chunk++)
+	{
+		const ChunkResult& result = results[chunk];
+		for (size_t i = 0; i < result.rangeCount; i++)
+		{
+			const MeshletRange& range = result.ranges[i];
+			if (!ranges.empty() && ranges.back().firstIndex + ranges.back().indexCount == range.firstIndex)
+			{
+				ranges.back().indexCount += range.indexCount;
+			}
+			else
+			{
+				ranges.push_back(range);
+			}
+		}
+
+		visibleCount += result.visible;
+		backfaceCulledCount += result.backfaceCulled;
+		frustumCulledCount += result.frustumCulled;
+	}
+}
+
+MeshletCuller::~MeshletCuller()
+{
+}
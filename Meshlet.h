@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+// A small cluster of triangles that is culled as a unit. Triangles of a meshlet are
+// contiguous in the index buffer, so a visible meshlet is drawn as a plain index range.
+struct Meshlet
+{
+	unsigned int firstIndex;
+	unsigned int triangleCount;
+	unsigned int vertexCount;
+
+	BoundingSphere bounds;
+
+	// every triangle normal is within the cone, coneCutoff is sin(cone half angle), 1 disables cone culling
+	glm::vec3 coneAxis;
+	float coneCutoff;
+};
+
+struct MeshletRange
+{
+	unsigned int firstIndex;
+	unsigned int indexCount;
+};
+
+constexpr unsigned int MESHLET_MAX_VERTICES = 64;
+constexpr unsigned int MESHLET_MAX_TRIANGLES = 124;
+
+// Greedily grows meshlets over shared vertices and reorders indices in place so each meshlet is contiguous.
+std::vector<Meshlet> BuildMeshlets(const float* vertices, unsigned int vertexCount, unsigned int vertexLength, std::vector<unsigned int>& indices);
+
+// SoA copy of meshlet bounds and cones for fast per frame culling of one mesh
+class MeshletCuller
+{
+public:
+	MeshletCuller();
+
+	void SetMeshlets(const std::vector<Meshlet>& meshlets);
+	void Clear();
+
+	// frustum and camera position must be in the mesh's object space; appends merged visible ranges
+	void Cull(const Frustum& objectFrustum, const glm::vec3& objectCameraPosition, std::vector<MeshletRange>& ranges);
+
+	size_t GetMeshletCount() const { return meshletCount; }
+	size_t GetScratchSize() const; // most frame arena bytes one Cull takes, for the job thread count now
+	size_t GetVisibleCount() const { return visibleCount; }
+	size_t GetBackfaceCulledCount() const { return backfaceCulledCount; }
+	size_t GetFrustumCulledCount() const { return frustumCulledCount; }
+
+	~MeshletCuller();
+
+private:
+	static constexpr size_t LANES = 4;
+	static constexpr size_t PARALLEL_THRESHOLD = 16384; // below this splitting the work costs more than it saves
+	static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+	std::vector<float> centerX, centerY, centerZ, radius;
+	std::vector<float> axisX, axisY, axisZ, cutoff;
+	std::vector<unsigned int> firstIndex;
+	std::vector<unsigned int> indexCount;
+
+	size_t meshletCount;
+	size_t visibleCount;
+	size_t backfaceCulledCount;
+	size_t frustumCulledCount;
+
+	// ranges point into the frame arena, room for one per meshlet of the chunk
+	struct ChunkResult
+	{
+		MeshletRange* ranges;
+		size_t rangeCount;
+		size_t visible;
+		size_t backfaceCulled;
+		size_t frustumCulled;
+	};
+
+	void CullRange(size_t begin, size_t end, const Frustum& objectFrustum, const glm::vec3& objectCameraPosition, ChunkResult& result) const;
+};
@@ -0,0 +1,275 @@
+#include "MicroBenchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <regex>
+#include <string>
+#include <thread>
+
+const void* volatile benchmarkSink = nullptr;
+
+namespace
+{
+	constexpr double MIN_RUN_TIME = 0.5;       // seconds a run has to take before its time is trusted
+	constexpr int64_t MAX_ITERATIONS = 1000000000;
+	constexpr double MAX_GROWTH = 10.0;        // iteration count multiplier between attempts
+
+	struct BenchmarkResult
+	{
+		std::string name;
+		std::string runName;  // name without the aggregate suffix
+		bool aggregate;
+		const char* aggregateName;
+		int repetitionIndex;
+		int64_t iterations;
+		double realTime;      // ns per iteration
+		double cpuTime;
+		double itemsPerSecond; // 0 when the benchmark does not count items
+		double bytesPerSecond;
+	};
+
+	BenchmarkResult RunOnce(const MicroBenchmark& benchmark, int64_t argument)
+	{
+		int64_t iterations = 1;
+
+		while (true)
+		{
+			BenchmarkState state(argument, iterations);
+			benchmark.function(state);
+
+			double seconds = state.getRealTime();
+			if (seconds >= MIN_RUN_TIME || iterations >= MAX_ITERATIONS)
+			{
+				BenchmarkResult result{};
+				result.iterations = iterations;
+				result.realTime = seconds * 1e9 / iterations;
+				result.cpuTime = state.getCPUTime() * 1e9 / iterations;
+				result.itemsPerSecond = seconds > 0.0 ? state.getItemsProcessed() / seconds : 0.0;
+				result.bytesPerSecond = seconds > 0.0 ? state.getBytesProcessed() / seconds : 0.0;
+				return result;
+			}
+
+			// aim a bit past the minimum so the next attempt is usually the last
+			double growth = seconds > 0.0 ? MIN_RUN_TIME * 1.4 / seconds : MAX_GROWTH;
+			growth = std::min(std::max(growth, 1.0), MAX_GROWTH);
+			iterations = std::min(std::max(iterations + 1, (int64_t) (iterations * growth)), MAX_ITERATIONS);
+		}
+	}
+
+	BenchmarkResult Aggregate(const std::vector<BenchmarkResult>& repetitions, const char* aggregateName)
+	{
+		auto combine = [&](double BenchmarkResult::*field) {
+			std::vector<double> values;
+			for (const BenchmarkResult& repetition : repetitions)
+			{
+				values.push_back(repetition.*field);
+			}
+
+			double mean = 0.0;
+			for (double value : values)
+			{
+				mean += value / values.size();
+			}
+
+			if (strcmp(aggregateName, "median") == 0)
+			{
+				std::sort(values.begin(), values.end());
+				size_t middle = values.size() / 2;
+				return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) * 0.5;
+			}
+			if (strcmp(aggregateName, "stddev") == 0)
+			{
+				double squareSum = 0.0;
+				for (double value : values)
+				{
+					squareSum += (value - mean) * (value - mean);
+				}
+				return values.size() > 1 ? std::sqrt(squareSum / (values.size() - 1)) : 0.0;
+			}
+			return mean;
+		};
+
+		BenchmarkResult result = repetitions.front();
+		result.name = result.runName + "_" + aggregateName;
+		result.aggregate = true;
+		result.aggregateName = aggregateName;
+		result.realTime = combine(&BenchmarkResult::realTime);
+		result.cpuTime = combine(&BenchmarkResult::cpuTime);
+		result.itemsPerSecond = combine(&BenchmarkResult::itemsPerSecond);
+		result.bytesPerSecond = combine(&BenchmarkResult::bytesPerSecond);
+		return result;
+	}
+
+	void PrintResult(const BenchmarkResult& result)
+	{
+		printf("%-40s %13.1f ns %13.1f ns %12lld", result.name.c_str(), result.realTime, result.cpuTime,
+		       result.aggregate ? (long long) 0 : (long long) result.iterations);
+		if (result.itemsPerSecond > 0.0)
+		{
+			printf(" items_per_second=%.4gM/s", result.itemsPerSecond * 1e-6);
+		}
+		if (result.bytesPerSecond > 0.0)
+		{
+			printf(" bytes_per_second=%.4gMiB/s", result.bytesPerSecond / (1024.0 * 1024.0));
+		}
+		printf("\n");
+	}
+
+	int WriteResults(const char* fileName, const std::vector<BenchmarkResult>& results, int repetitions)
+	{
+		FILE* file = fopen(fileName, "w");
+		if (!file)
+		{
+			printf("Failed to open %s for writing\n", fileName);
+			return 1;
+		}
+
+		char date[64];
+		std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+#ifdef NDEBUG
+		const char* buildType = "release";
+#else
+		const char* buildType = "debug";
+#endif
+
+		fprintf(file, "{\n  \"context\": {\n");
+		fprintf(file, "    \"date\": \"%s\",\n    \"num_cpus\": %u,\n    \"library_build_type\": \"%s\"\n  },\n",
+		        date, std::thread::hardware_concurrency(), buildType);
+		fprintf(file, "  \"benchmarks\": [\n");
+
+		for (size_t i = 0; i < results.size(); i++)
+		{
+			const BenchmarkResult& result = results[i];
+			fprintf(file, "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n      \"run_type\": \"%s\",\n      \"repetitions\": %d,\n",
+			        result.name.c_str(), result.runName.c_str(), result.aggregate ? "aggregate" : "iteration", repetitions);
+			if (result.aggregate)
+			{
+				fprintf(file, "      \"aggregate_name\": \"%s\",\n", result.aggregateName);
+			}
+			else
+			{
+				fprintf(file, "      \"repetition_index\": %d,\n", result.repetitionIndex);
+			}
+			fprintf(file, "      \"iterations\": %lld,\n      \"real_time\": %.6e,\n      \"cpu_time\": %.6e,\n      \"time_unit\": \"ns\"",
+			        (long long) result.iterations, result.realTime, result.cpuTime);
+			if (result.itemsPerSecond > 0.0)
+			{
+				fprintf(file, ",\n      \"items_per_second\": %.6e", result.itemsPerSecond);
+			}
+			if (result.bytesPerSecond > 0.0)
+			{
+				fprintf(file, ",\n      \"bytes_per_second\": %.6e", result.bytesPerSecond);
+			}
+			fprintf(file, i + 1 < results.size() ? "\n    },\n" : "\n    }\n");
+		}
+
+		fprintf(file, "  ]\n}\n");
+		fclose(file);
+
+		printf("Benchmark results written to %s\n", fileName);
+		return 0;
+	}
+}
+
+BenchmarkState::BenchmarkState(int64_t argument, int64_t iterations) :
+	argument(argument), maxIterations(iterations), completedIterations(0), started(false),
+	cpuStart(0), realTime(0.0), cpuTime(0.0), itemsProcessed(0), bytesProcessed(0)
+{
+}
+
+bool BenchmarkState::KeepRunning()
+{
+	if (!started)
+	{
+		started = true;
+		ResumeTiming();
+	}
+
+	if (completedIterations < maxIterations)
+	{
+		completedIterations++;
+		return true;
+	}
+
+	PauseTiming();
+	return false;
+}
+
+void BenchmarkState::PauseTiming()
+{
+	realTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+	cpuTime += (double) (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+}
+
+void BenchmarkState::ResumeTiming()
+{
+	cpuStart = std::clock();
+	realStart = std::chrono::steady_clock::now();
+}
+
+BenchmarkState::~BenchmarkState()
+{
+}
+
+int RunMicroBenchmarks(const std::vector<MicroBenchmark>& benchmarks, const char* filter, const char* outputFile, int repetitions)
+{
+	std::regex filterRegex;
+	try
+	{
+		filterRegex = std::regex(filter ? filter : ".");
+	}
+	catch (const std::regex_error&)
+	{
+		printf("Invalid benchmark filter: %s\n", filter);
+		return 1;
+	}
+
+	repetitions = std::max(repetitions, 1);
+	std::vector<BenchmarkResult> results;
+
+	printf("%-40s %16s %16s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+	for (const MicroBenchmark& benchmark : benchmarks)
+	{
+		for (int64_t argument : benchmark.arguments)
+		{
+			std::string name = std::string(benchmark.name) + "/" + std::to_string(argument);
+			if (!std::regex_search(name, filterRegex))
+			{
+				continue;
+			}
+
+			std::vector<BenchmarkResult> runs;
+			for (int repetition = 0; repetition < repetitions; repetition++)
+			{
+				BenchmarkResult result = RunOnce(benchmark, argument);
+				result.name = name;
+				result.runName = name;
+				result.repetitionIndex = repetition;
+				PrintResult(result);
+				runs.push_back(result);
+			}
+			results.insert(results.end(), runs.begin(), runs.end());
+
+			if (repetitions > 1)
+			{
+				for (const char* aggregateName : { "mean", "median", "stddev" })
+				{
+					results.push_back(Aggregate(runs, aggregateName));
+					PrintResult(results.back());
+				}
+			}
+		}
+	}
+
+	if (results.empty())
+	{
+		printf("No benchmark matches %s\n", filter);
+		return 1;
+	}
+
+	return outputFile ? WriteResults(outputFile, results, repetitions) : 0;
+}
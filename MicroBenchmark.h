@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+#include <ctime>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Loop state of one microbenchmark run, in the style of google benchmark:
+//
+//     while (state.KeepRunning()) { ...kernel... }
+//
+// The runner calls the benchmark with growing iteration counts until a run takes long enough to time.
+class BenchmarkState
+{
+public:
+	BenchmarkState(int64_t argument, int64_t iterations);
+
+	bool KeepRunning();
+
+	// exclude setup inside the loop, like rebuilding an input the kernel consumed
+	void PauseTiming();
+	void ResumeTiming();
+
+	int64_t range() const { return argument; }
+	int64_t iterations() const { return maxIterations; }
+
+	void SetItemsProcessed(int64_t items) { itemsProcessed = items; }
+	void SetBytesProcessed(int64_t bytes) { bytesProcessed = bytes; }
+
+	double getRealTime() const { return realTime; } // seconds
+	double getCPUTime() const { return cpuTime; }
+	int64_t getItemsProcessed() const { return itemsProcessed; }
+	int64_t getBytesProcessed() const { return bytesProcessed; }
+
+	~BenchmarkState();
+
+private:
+	int64_t argument;
+	int64_t maxIterations;
+	int64_t completedIterations;
+	bool started;
+
+	std::chrono::steady_clock::time_point realStart;
+	std::clock_t cpuStart;
+	double realTime;
+	double cpuTime;
+
+	int64_t itemsProcessed;
+	int64_t bytesProcessed;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState& state);
+
+struct MicroBenchmark
+{
+	const char* name;
+	BenchmarkFunction function;
+	std::vector<int64_t> arguments; // one run per argument, reported as name/argument
+};
+
+// Runs every benchmark whose name/argument matches the filter regex, repeated and summarized by mean,
+// median and stddev. outputFile, if set, gets google benchmark's JSON layout, which --compare reads.
+int RunMicroBenchmarks(const std::vector<MicroBenchmark>& benchmarks, const char* filter, const char* outputFile, int repetitions);
+
+// keeps the compiler from dropping a result that is never used
+extern const void* volatile benchmarkSink;
+
+template <class T>
+inline void DoNotOptimize(const T& value)
+{
+#if defined(_MSC_VER)
+	benchmarkSink = &value;
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r"(&value) : "memory");
+#endif
+}
@@ -0,0 +1,360 @@
+#include "NullRenderBackend.h"
+
+#include <stdio.h>
+
+NullRenderBackend::NullRenderBackend()
+{
+	nextHandle = 1;
+	currentProgram = 0;
+	ResetCounters();
+}
+
+void NullRenderBackend::ResetCounters()
+{
+	callCount = 0;
+	drawCount = 0;
+	triangleCount = 0;
+	errorCount = 0;
+}
+
+void NullRenderBackend::ReportError(const char* call, const char* message)
+{
+	if (errorCount < MAX_REPORTED_ERRORS)
+	{
+		printf("Null backend: %s: %s\n", call, message);
+	}
+
+	errorCount++;
+}
+
+GLuint NullRenderBackend::CreateVertexArray(const GLfloat* vertices, size_t vertexFloatCount, const unsigned int* indices, size_t indexCount,
+                                            const unsigned int* attributeSizes, unsigned int attributeCount)
+{
+	callCount++;
+
+	size_t vertexLength = 0;
+	for (unsigned int i = 0; i < attributeCount; i++)
+	{
+		vertexLength += attributeSizes[i];
+	}
+
+	if (vertexLength == 0 || vertexFloatCount % vertexLength != 0)
+	{
+		ReportError("CreateVertexArray", "vertex data is not a whole number of vertices");
+		return 0;
+	}
+
+	if ((vertexFloatCount > 0 && !vertices) || (indexCount > 0 && !indices))
+	{
+		ReportError("CreateVertexArray", "null data pointer");
+		return 0;
+	}
+
+	size_t vertexCount = vertexFloatCount / vertexLength;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			ReportError("CreateVertexArray", "index out of vertex range");
+			return 0;
+		}
+	}
+
+	GLuint handle = nextHandle++;
+	vertexArrays[handle] = VertexArray{ vertexCount, indexCount };
+	return handle;
+}
+
+void NullRenderBackend::SetIndices(GLuint vertexArray, const unsigned int* indices, size_t indexCount)
+{
+	callCount++;
+
+	auto found = vertexArrays.find(vertexArray);
+	if (found == vertexArrays.end())
+	{
+		ReportError("SetIndices", "unknown vertex array");
+		return;
+	}
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= found->second.vertexCount)
+		{
+			ReportError("SetIndices", "index out of vertex range");
+			return;
+		}
+	}
+
+	found->second.indexCount = indexCount;
+}
+
+void NullRenderBackend::UpdateIndices(GLuint vertexArray, size_t firstIndex, const unsigned int* indices, size_t indexCount)
+{
+	callCount++;
+
+	auto found = vertexArrays.find(vertexArray);
+	if (found == vertexArrays.end())
+	{
+		ReportError("UpdateIndices", "unknown vertex array");
+		return;
+	}
+
+	if (firstIndex + indexCount > found->second.indexCount)
+	{
+		ReportError("UpdateIndices", "range past the end of the index buffer");
+		return;
+	}
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= found->second.vertexCount)
+		{
+			ReportError("UpdateIndices", "index out of vertex range");
+			return;
+		}
+	}
+}
+
+bool NullRenderBackend::CheckDraw(const char* call, GLuint vertexArray, size_t firstIndex, size_t indexCount)
+{
+	auto found = vertexArrays.find(vertexArray);
+	if (found == vertexArrays.end())
+	{
+		ReportError(call, "unknown vertex array");
+		return false;
+	}
+
+	if (currentProgram == 0)
+	{
+		ReportError(call, "no program in use");
+		return false;
+	}
+
+	if (firstIndex + indexCount > found->second.indexCount)
+	{
+		ReportError(call, "range past the end of the index buffer");
+		return false;
+	}
+
+	if (indexCount % 3 != 0)
+	{
+		ReportError(call, "index count is not a whole number of triangles");
+		return false;
+	}
+
+	return true;
+}
+
+void NullRenderBackend::DrawIndexed(GLuint vertexArray, size_t firstIndex, size_t indexCount)
+{
+	callCount++;
+
+	if (CheckDraw("DrawIndexed", vertexArray, firstIndex, indexCount))
+	{
+		drawCount++;
+		triangleCount += indexCount / 3;
+	}
+}
+
+void NullRenderBackend::DrawIndexedRanges(GLuint vertexArray, const GLsizei* indexCounts, const void* const* byteOffsets, GLsizei rangeCount)
+{
+	callCount++;
+
+	for (GLsizei i = 0; i < rangeCount; i++)
+	{
+		size_t byteOffset = (size_t) byteOffsets[i];
+		if (byteOffset % sizeof(GLuint) != 0 || indexCounts[i] < 0)
+		{
+			ReportError("DrawIndexedRanges", "misaligned offset or negative count");
+			return;
+		}
+
+		if (!CheckDraw("DrawIndexedRanges", vertexArray, byteOffset / sizeof(GLuint), (size_t) indexCounts[i]))
+		{
+			return;
+		}
+	}
+
+	// one multi draw is still one call into the driver
+	drawCount++;
+	for (GLsizei i = 0; i < rangeCount; i++)
+	{
+		triangleCount += indexCounts[i] / 3;
+	}
+}
+
+void NullRenderBackend::DestroyVertexArray(GLuint vertexArray)
+{
+	callCount++;
+
+	if (vertexArrays.erase(vertexArray) == 0)
+	{
+		ReportError("DestroyVertexArray", "unknown vertex array");
+	}
+}
+
+GLuint NullRenderBackend::CreateTexture(int width, int height, const unsigned char* /*rgba*/)
+{
+	callCount++;
+
+	if (width <= 0 || height <= 0)
+	{
+		ReportError("CreateTexture", "invalid size");
+		return 0;
+	}
+
+	GLuint handle = nextHandle++;
+	textures.insert(handle);
+	return handle;
+}
+
+void NullRenderBackend::BindTexture(GLuint texture, unsigned int unit)
+{
+	constexpr unsigned int MIN_TEXTURE_UNITS = 16; // every GL 3.3 implementation has at least this many
+
+	callCount++;
+
+	if (unit >= MIN_TEXTURE_UNITS)
+	{
+		ReportError("BindTexture", "texture unit out of range");
+	}
+	else if (texture != 0 && textures.count(texture) == 0)
+	{
+		ReportError("BindTexture", "unknown texture");
+	}
+}
+
+void NullRenderBackend::DestroyTexture(GLuint texture)
+{
+	callCount++;
+
+	if (texture != 0 && textures.erase(texture) == 0)
+	{
+		ReportError("DestroyTexture", "unknown texture");
+	}
+}
+
+GLuint NullRenderBackend::CreateProgram(const char* vertexCode, const char* fragmentCode)
+{
+	callCount++;
+
+	if (!vertexCode || !fragmentCode || !*vertexCode || !*fragmentCode)
+	{
+		ReportError("CreateProgram", "empty shader source");
+		return 0;
+	}
+
+	GLuint handle = nextHandle++;
+	Program& program = programs[handle];
+	program.source = std::string(vertexCode) + fragmentCode;
+	return handle;
+}
+
+GLuint NullRenderBackend::GetUniformLocation(GLuint program, const char* name)
+{
+	callCount++;
+
+	auto found = programs.find(program);
+	if (found == programs.end())
+	{
+		ReportError("GetUniformLocation", "unknown program");
+		return (GLuint) -1;
+	}
+
+	// like GL, names that do not appear in the program are inactive and get -1
+	std::string uniform = name;
+	std::string outerName = uniform.substr(0, uniform.find('.'));
+	if (found->second.source.find(outerName) == std::string::npos)
+	{
+		return (GLuint) -1;
+	}
+
+	std::unordered_map<std::string, GLuint>& uniforms = found->second.uniforms;
+	auto location = uniforms.find(uniform);
+	if (location != uniforms.end())
+	{
+		return location->second;
+	}
+
+	GLuint newLocation = (GLuint) uniforms.size();
+	uniforms[uniform] = newLocation;
+	return newLocation;
+}
+
+void NullRenderBackend::UseProgram(GLuint program)
+{
+	callCount++;
+
+	if (program != 0 && programs.count(program) == 0)
+	{
+		ReportError("UseProgram", "unknown program");
+		return;
+	}
+
+	currentProgram = program;
+}
+
+void NullRenderBackend::DestroyProgram(GLuint program)
+{
+	callCount++;
+
+	if (programs.erase(program) == 0)
+	{
+		ReportError("DestroyProgram", "unknown program");
+	}
+
+	if (currentProgram == program)
+	{
+		currentProgram = 0;
+	}
+}
+
+bool NullRenderBackend::CheckUniform(const char* call, GLuint location)
+{
+	if (location == (GLuint) -1)
+	{
+		return false;
+	}
+
+	auto found = programs.find(currentProgram);
+	if (found == programs.end())
+	{
+		ReportError(call, "no program in use");
+		return false;
+	}
+
+	if (location >= found->second.uniforms.size())
+	{
+		ReportError(call, "location does not belong to the program in use");
+		return false;
+	}
+
+	return true;
+}
+
+void NullRenderBackend::SetUniform(GLuint location, GLfloat /*value*/)
+{
+	callCount++;
+	CheckUniform("SetUniform(float)", location);
+}
+
+void NullRenderBackend::SetUniform(GLuint location, const glm::vec3& /*value*/)
+{
+	callCount++;
+	CheckUniform("SetUniform(vec3)", location);
+}
+
+void NullRenderBackend::SetUniform(GLuint location, const glm::mat4& /*value*/)
+{
+	callCount++;
+	CheckUniform("SetUniform(mat4)", location);
+}
+
+void NullRenderBackend::Clear(const glm::vec4& /*color*/)
+{
+	callCount++;
+}
+
+NullRenderBackend::~NullRenderBackend()
+{
+}
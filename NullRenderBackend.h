@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "RenderBackend.h"
+
+// RenderBackend that does no GPU work but checks every call the way the driver would:
+// handles must be live, draws need a program and must stay inside their index buffer,
+// uniforms need a program and a location that program handed out. Lets the CPU side of a
+// frame be measured without a context, and turns API misuse into a countable error.
+class NullRenderBackend : public RenderBackend
+{
+public:
+	NullRenderBackend();
+
+	GLuint CreateVertexArray(const GLfloat* vertices, size_t vertexFloatCount, const unsigned int* indices, size_t indexCount,
+	                         const unsigned int* attributeSizes, unsigned int attributeCount) override;
+	void SetIndices(GLuint vertexArray, const unsigned int* indices, size_t indexCount) override;
+	void UpdateIndices(GLuint vertexArray, size_t firstIndex, const unsigned int* indices, size_t indexCount) override;
+	void DrawIndexed(GLuint vertexArray, size_t firstIndex, size_t indexCount) override;
+	void DrawIndexedRanges(GLuint vertexArray, const GLsizei* indexCounts, const void* const* byteOffsets, GLsizei rangeCount) override;
+	void DestroyVertexArray(GLuint vertexArray) override;
+
+	GLuint CreateTexture(int width, int height, const unsigned char* rgba) override;
+	void BindTexture(GLuint texture, unsigned int unit) override;
+	void DestroyTexture(GLuint texture) override;
+
+	GLuint CreateProgram(const char* vertexCode, const char* fragmentCode) override;
+	GLuint GetUniformLocation(GLuint program, const char* name) override;
+	void UseProgram(GLuint program) override;
+	void DestroyProgram(GLuint program) override;
+
+	void SetUniform(GLuint location, GLfloat value) override;
+	void SetUniform(GLuint location, const glm::vec3& value) override;
+	void SetUniform(GLuint location, const glm::mat4& value) override;
+
+	void Clear(const glm::vec4& color) override;
+
+	size_t GetCallCount() const { return callCount; }
+	size_t GetDrawCount() const { return drawCount; }
+	size_t GetTriangleCount() const { return triangleCount; }
+	size_t GetErrorCount() const { return errorCount; }
+	void ResetCounters();
+
+	~NullRenderBackend();
+
+private:
+	static constexpr size_t MAX_REPORTED_ERRORS = 16; // later errors are only counted
+
+	struct VertexArray
+	{
+		size_t vertexCount;
+		size_t indexCount;
+	};
+
+	struct Program
+	{
+		std::string source; // both stages, to tell active uniforms from unknown ones
+		std::unordered_map<std::string, GLuint> uniforms;
+	};
+
+	GLuint nextHandle;
+	GLuint currentProgram;
+
+	std::unordered_map<GLuint, VertexArray> vertexArrays;
+	std::unordered_set<GLuint> textures;
+	std::unordered_map<GLuint, Program> programs;
+
+	size_t callCount;
+	size_t drawCount;
+	size_t triangleCount;
+	size_t errorCount;
+
+	void ReportError(const char* call, const char* message);
+	bool CheckDraw(const char* call, GLuint vertexArray, size_t firstIndex, size_t indexCount);
+	bool CheckUniform(const char* call, GLuint location);
+};
@@ -0,0 +1,324 @@
+#include "OcclusionCuller.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+#include "Mesh.h"
+
+OcclusionCuller::OcclusionCuller() : OcclusionCuller(256, 128)
+{
+}
+
+OcclusionCuller::OcclusionCuller(int bufferWidth, int bufferHeight)
+{
+	width = std::max(1, bufferWidth);
+	height = std::max(1, bufferHeight);
+	paddedWidth = (width + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT;
+
+	glm::ivec2 size{ paddedWidth, height };
+	levelSizes.push_back(size);
+	depthLevels.push_back(std::vector<float>(size.x * size.y, 1.0f));
+
+	while (size.x > 1 || size.y > 1)
+	{
+		size = glm::ivec2{ (size.x + 1) / 2, (size.y + 1) / 2 };
+		levelSizes.push_back(size);
+		depthLevels.push_back(std::vector<float>(size.x * size.y, 1.0f));
+	}
+
+	viewProjection = glm::mat4(1.0f);
+	testedCount = 0;
+	occludedCount = 0;
+}
+
+void OcclusionCuller::AddOccluder(const Mesh* mesh, const glm::mat4& model, unsigned int lod)
+{
+	const std::vector<GLfloat>& vertices = mesh->GetVertices();
+	lod = std::min(lod, std::max(mesh->GetLODCount(), 1u) - 1);
+
+	const unsigned int* indices = mesh->GetLODIndices(lod);
+	unsigned int indexCount = (unsigned int) mesh->GetIndexCount(lod);
+
+	if (vertices.empty() || !indices || indexCount == 0)
+	{
+		printf("Occluder mesh has no CPU side geometry\n");
+		return;
+	}
+
+	AddOccluder(vertices.data(), mesh->GetVertexLength(), indices, indexCount, model);
+}
+
+void OcclusionCuller::AddOccluder(const float* vertices, unsigned int vertexLength, const unsigned int* indices, unsigned int indexCount, const glm::mat4& model)
+{
+	Occluder occluder;
+	occluder.model = model;
+	occluder.indices.assign(indices, indices + indexCount);
+
+	unsigned int vertexCount = 0;
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		vertexCount = std::max(vertexCount, indices[i] + 1);
+	}
+
+	// only positions are needed to rasterize depth
+	occluder.positions.resize(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const float* position = vertices + i * vertexLength;
+		occluder.positions[i] = glm::vec3(position[0], position[1], position[2]);
+	}
+
+	occluders.push_back(occluder);
+}
+
+void OcclusionCuller::ClearOccluders()
+{
+	occluders.clear();
+}
+
+void OcclusionCuller::RenderOccluders(const glm::mat4& newViewProjection)
+{
+	viewProjection = newViewProjection;
+	testedCount = 0;
+	occludedCount = 0;
+
+	std::fill(depthLevels[0].begin(), depthLevels[0].end(), 1.0f);
+
+	for (const Occluder& occluder : occluders)
+	{
+		glm::mat4 modelViewProjection = viewProjection * occluder.model;
+
+		clipPositions.resize(occluder.positions.size());
+		for (size_t i = 0; i < occluder.positions.size(); i++)
+		{
+			clipPositions[i] = modelViewProjection * glm::vec4(occluder.positions[i], 1.0f);
+		}
+
+		for (size_t i = 0; i + 2 < occluder.indices.size(); i += 3)
+		{
+			RasterizeTriangle(clipPositions[occluder.indices[i]], clipPositions[occluder.indices[i + 1]], clipPositions[occluder.indices[i + 2]]);
+		}
+	}
+
+	BuildHierarchy();
+}
+
+glm::vec3 OcclusionCuller::ToScreen(const glm::vec4& clip) const
+{
+	glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+	return glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+}
+
+void OcclusionCuller::RasterizeTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2)
+{
+	// triangles touching the near plane are dropped: the GPU would clip part of them away,
+	// and an occluder that is missing can only leave more boxes visible
+	if (clip0.z < -clip0.w || clip1.z < -clip1.w || clip2.z < -clip2.w ||
+	    clip0.w <= 0.0f || clip1.w <= 0.0f || clip2.w <= 0.0f)
+	{
+		return;
+	}
+
+	glm::vec3 v0 = ToScreen(clip0);
+	glm::vec3 v1 = ToScreen(clip1);
+	glm::vec3 v2 = ToScreen(clip2);
+
+	float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+	if (area == 0.0f)
+	{
+		return;
+	}
+
+	// occluders are treated as double sided, flip to counter clockwise
+	if (area < 0.0f)
+	{
+		std::swap(v1, v2);
+		area = -area;
+	}
+
+	int minX = std::max(0, (int) std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+	int maxX = std::min(width - 1, (int) std::ceil(std::max(v0.x, std::max(v1.x, v2.x))));
+	int minY = std::max(0, (int) std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+	int maxY = std::min(height - 1, (int) std::ceil(std::max(v0.y, std::max(v1.y, v2.y))));
+
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+
+	// edge functions A * x + B * y + C, positive inside
+	float a0 = v0.y - v1.y, b0 = v1.x - v0.x, c0 = v0.x * v1.y - v0.y * v1.x;
+	float a1 = v1.y - v2.y, b1 = v2.x - v1.x, c1 = v1.x * v2.y - v1.y * v2.x;
+	float a2 = v2.y - v0.y, b2 = v0.x - v2.x, c2 = v2.x * v0.y - v2.y * v0.x;
+
+	// screen space depth is affine: z = z0 + dzdx * (x - x0) + dzdy * (y - y0)
+	float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+	float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+	float zBase = v0.z - dzdx * v0.x - dzdy * v0.y;
+
+	float* depth = depthLevels[0].data();
+
+#if defined(__AVX__)
+	constexpr int LANES = 8;
+	const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+	const __m256 zero = _mm256_setzero_ps();
+#else
+	constexpr int LANES = 4;
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+#endif
+
+	int startX = minX / LANES * LANES;
+
+	for (int y = minY; y <= maxY; y++)
+	{
+		float py = y + 0.5f;
+		float* row = depth + y * paddedWidth;
+
+		for (int x = startX; x <= maxX; x += LANES)
+		{
+#if defined(__AVX__)
+			__m256 px = _mm256_add_ps(_mm256_set1_ps((float) x), laneOffsets);
+
+			__m256 e0 = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(a0)), _mm256_set1_ps(b0 * py + c0));
+			__m256 e1 = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(a1)), _mm256_set1_ps(b1 * py + c1));
+			__m256 e2 = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(a2)), _mm256_set1_ps(b2 * py + c2));
+
+			__m256 inside = _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ),
+			                _mm256_and_ps(_mm256_cmp_ps(e1, zero, _CMP_GE_OQ), _mm256_cmp_ps(e2, zero, _CMP_GE_OQ)));
+
+			if (_mm256_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m256 z = _mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(dzdx)), _mm256_set1_ps(zBase + dzdy * py));
+			__m256 old = _mm256_loadu_ps(row + x);
+			_mm256_storeu_ps(row + x, _mm256_blendv_ps(old, _mm256_min_ps(old, z), inside));
+#else
+			__m128 px = _mm_add_ps(_mm_set1_ps((float) x), laneOffsets);
+
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(a0)), _mm_set1_ps(b0 * py + c0));
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(a1)), _mm_set1_ps(b1 * py + c1));
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(a2)), _mm_set1_ps(b2 * py + c2));
+
+			__m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+
+			if (_mm_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m128 z = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(dzdx)), _mm_set1_ps(zBase + dzdy * py));
+			__m128 old = _mm_loadu_ps(row + x);
+			__m128 closer = _mm_min_ps(old, z);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, old)));
+#endif
+		}
+	}
+}
+
+void OcclusionCuller::BuildHierarchy()
+{
+	for (size_t level = 1; level < depthLevels.size(); level++)
+	{
+		const std::vector<float>& source = depthLevels[level - 1];
+		std::vector<float>& destination = depthLevels[level];
+		glm::ivec2 sourceSize = levelSizes[level - 1];
+		glm::ivec2 size = levelSizes[level];
+
+		for (int y = 0; y < size.y; y++)
+		{
+			int y0 = y * 2;
+			int y1 = std::min(y0 + 1, sourceSize.y - 1);
+
+			for (int x = 0; x < size.x; x++)
+			{
+				int x0 = x * 2;
+				int x1 = std::min(x0 + 1, sourceSize.x - 1);
+
+				// keep the farthest depth so a texel only occludes what is behind everything under it
+				float farthest = std::max(std::max(source[y0 * sourceSize.x + x0], source[y0 * sourceSize.x + x1]),
+				                          std::max(source[y1 * sourceSize.x + x0], source[y1 * sourceSize.x + x1]));
+				destination[y * size.x + x] = farthest;
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::TestAABB(const AABB& worldBox)
+{
+	testedCount++;
+
+	glm::vec3 screenMin{ FLT_MAX };
+	glm::vec3 screenMax{ -FLT_MAX };
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 position{ (corner & 1) ? worldBox.max.x : worldBox.min.x,
+		                    (corner & 2) ? worldBox.max.y : worldBox.min.y,
+		                    (corner & 4) ? worldBox.max.z : worldBox.min.z };
+
+		glm::vec4 clip = viewProjection * glm::vec4(position, 1.0f);
+
+		// box crosses the near plane, assume visible
+		if (clip.w <= 0.0f || clip.z < -clip.w)
+		{
+			return true;
+		}
+
+		glm::vec3 screen = ToScreen(clip);
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+	}
+
+	int x0 = std::max(0, (int) std::floor(screenMin.x));
+	int x1 = std::min(width - 1, (int) std::floor(screenMax.x));
+	int y0 = std::max(0, (int) std::floor(screenMin.y));
+	int y1 = std::min(height - 1, (int) std::floor(screenMax.y));
+
+	// off screen boxes are left to frustum culling
+	if (x0 > x1 || y0 > y1)
+	{
+		return true;
+	}
+
+	// coarsest level where the rectangle still covers only a few texels
+	size_t level = 0;
+	while (level + 1 < depthLevels.size() &&
+	       ((x1 >> level) - (x0 >> level) + 1 > MAX_TEST_TEXELS || (y1 >> level) - (y0 >> level) + 1 > MAX_TEST_TEXELS))
+	{
+		level++;
+	}
+
+	const std::vector<float>& levelDepth = depthLevels[level];
+	int levelWidth = levelSizes[level].x;
+	float boxDepth = screenMin.z;
+
+	for (int ty = y0 >> level; ty <= (y1 >> level); ty++)
+	{
+		for (int tx = x0 >> level; tx <= (x1 >> level); tx++)
+		{
+			if (boxDepth <= levelDepth[ty * levelWidth + tx])
+			{
+				return true;
+			}
+		}
+	}
+
+	occludedCount++;
+	return false;
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
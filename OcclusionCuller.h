@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+class Mesh;
+
+// CPU only occlusion culling: occluder triangles are rasterized into a low resolution
+// depth buffer, reduced into a max depth hierarchy, and object boxes are tested against it.
+// Depth is NDC z remapped to [0, 1], smaller is closer. The test is approximate: occluders
+// are sampled at texel centers, so one that covers a texel's center but not all of it fills
+// the whole texel and can hide a box showing through the rest, while thin occluders that miss
+// every center hide nothing. Boxes are tested over every texel their screen rectangle touches,
+// at their nearest depth, which keeps the error to the occluders' edges.
+class OcclusionCuller
+{
+public:
+	OcclusionCuller();
+	OcclusionCuller(int bufferWidth, int bufferHeight);
+
+	// one LOD of the mesh, clamped to the coarsest it has; occluders are rasterized every frame, a coarse one is cheaper
+	void AddOccluder(const Mesh* mesh, const glm::mat4& model, unsigned int lod = 0);
+	void AddOccluder(const float* vertices, unsigned int vertexLength, const unsigned int* indices, unsigned int indexCount, const glm::mat4& model);
+	void ClearOccluders();
+
+	// clear the depth buffer, rasterize every occluder and rebuild the hierarchy
+	void RenderOccluders(const glm::mat4& viewProjection);
+
+	// true if any part of the box may be visible; false can be wrong along occluder edges, see above
+	bool TestAABB(const AABB& worldBox);
+
+	int GetWidth() const { return width; }
+	int GetHeight() const { return height; }
+	const std::vector<float>& GetDepthBuffer() const { return depthLevels[0]; }
+
+	unsigned int GetTestedCount() const { return testedCount; }
+	unsigned int GetOccludedCount() const { return occludedCount; }
+	float GetCulledPercentage() const { return testedCount ? 100.0f * occludedCount / testedCount : 0.0f; }
+
+	~OcclusionCuller();
+
+private:
+	struct Occluder
+	{
+		std::vector<glm::vec3> positions;
+		std::vector<unsigned int> indices;
+		glm::mat4 model;
+	};
+
+	static constexpr int LANE_COUNT = 8;      // level 0 width is padded to this so SIMD rows never need a tail loop
+	static constexpr int MAX_TEST_TEXELS = 4; // texels per side read when testing one box
+
+	int width;
+	int height;
+	int paddedWidth;
+
+	std::vector<Occluder> occluders;
+	std::vector<glm::vec4> clipPositions;
+
+	std::vector<std::vector<float>> depthLevels; // level 0 is full resolution, each level holds the max of 2x2 texels below
+	std::vector<glm::ivec2> levelSizes;
+
+	glm::mat4 viewProjection;
+
+	unsigned int testedCount;
+	unsigned int occludedCount;
+
+	void RasterizeTriangle(const glm::vec4& clip0, const glm::vec4& clip1, const glm::vec4& clip2);
+	void BuildHierarchy();
+	glm::vec3 ToScreen(const glm::vec4& clip) const;
+};
@@ -0,0 +1,88 @@
+#include "OffscreenTarget.h"
+
+OffscreenTarget::OffscreenTarget()
+{
+	FBO = 0;
+	colorRBO = 0;
+	depthRBO = 0;
+	width = 0;
+	height = 0;
+}
+
+int OffscreenTarget::Create(GLint targetWidth, GLint targetHeight)
+{
+	Clear();
+
+	width = targetWidth;
+	height = targetHeight;
+
+	glGenRenderbuffers(1, &colorRBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &depthRBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		printf("Offscreen framebuffer incomplete: 0x%x\n", status);
+		Clear();
+		return 1;
+	}
+
+	return 0;
+}
+
+void OffscreenTarget::Bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glViewport(0, 0, width, height);
+}
+
+void OffscreenTarget::ReadPixels(std::vector<unsigned char>& pixels)
+{
+	constexpr int CHANNELS = 4;
+
+	pixels.resize((size_t) width * height * CHANNELS);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+void OffscreenTarget::Clear()
+{
+	if (FBO != 0)
+	{
+		glDeleteFramebuffers(1, &FBO);
+		FBO = 0;
+	}
+
+	if (colorRBO != 0)
+	{
+		glDeleteRenderbuffers(1, &colorRBO);
+		colorRBO = 0;
+	}
+
+	if (depthRBO != 0)
+	{
+		glDeleteRenderbuffers(1, &depthRBO);
+		depthRBO = 0;
+	}
+
+	width = 0;
+	height = 0;
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+	Clear();
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+
+#include <GL/glew.h>
+
+// Framebuffer object with RGBA8 color and 24 bit depth renderbuffers for rendering without a window
+class OffscreenTarget
+{
+public:
+	OffscreenTarget();
+
+	int Create(GLint targetWidth, GLint targetHeight);
+	void Bind();
+	void ReadPixels(std::vector<unsigned char>& pixels); // tightly packed RGBA, bottom row first
+	void Clear();
+
+	GLint getWidth() const { return width; }
+	GLint getHeight() const { return height; }
+	GLuint getFramebuffer() const { return FBO; }
+
+	~OffscreenTarget();
+
+private:
+	GLuint FBO, colorRBO, depthRBO;
+	GLint width, height;
+};
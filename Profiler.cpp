@@ -0,0 +1,298 @@
+#include "Profiler.h"
+
+#include <stdio.h>
+
+#ifdef ENABLE_PROFILER
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> profilerCapturing{ false };
+
+namespace
+{
+	constexpr uint64_t RING_CAPACITY = 1 << 16; // events per thread and capture, older ones are overwritten
+	constexpr size_t LATE_FRAMES = 4;          // frames to wait after a capture for late track events such as GPU timings
+
+	struct ProfileEvent
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	// written only by its thread, read by the thread that writes the capture
+	struct ProfileRing
+	{
+		std::atomic<uint64_t> head{ 0 };
+		uint64_t captureStart = 0; // head when the current capture began
+		std::vector<ProfileEvent> events;
+		unsigned int threadId;
+		std::string threadName;
+	};
+
+	std::mutex registryMutex; // only taken the first time a thread records
+	std::vector<std::unique_ptr<ProfileRing>> rings;
+	thread_local ProfileRing* threadRing = nullptr;
+	std::vector<ProfileRing*> tracks;
+
+	// capture state, owned by the thread calling ProfilerEndFrame
+	std::string captureFile;
+	size_t captureFirstFrame = 0;
+	size_t captureFrameCount = 0;
+	size_t completedFrames = 0;
+	bool captureRequested = false;
+	uint64_t captureStartTick = 0;
+	uint64_t captureEndTick = 0; // set once the last frame ended and late events are awaited
+	std::vector<uint64_t> frameBoundaries;
+	std::chrono::steady_clock::time_point captureStartTime;
+
+	ProfileRing* CreateRing(const char* name)
+	{
+		std::unique_ptr<ProfileRing> ring{ new ProfileRing{} };
+		ring->events.resize(RING_CAPACITY);
+		if (name)
+		{
+			ring->threadName = name;
+		}
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+		ring->threadId = (unsigned int) rings.size() + 1;
+		rings.push_back(std::move(ring));
+		return rings.back().get();
+	}
+
+	ProfileRing* GetThreadRing()
+	{
+		if (!threadRing)
+		{
+			threadRing = CreateRing(nullptr);
+		}
+		return threadRing;
+	}
+
+	void Push(ProfileRing* ring, const char* name, uint64_t start, uint64_t end)
+	{
+		uint64_t index = ring->head.load(std::memory_order_relaxed);
+		ring->events[index & (RING_CAPACITY - 1)] = ProfileEvent{ name, start, end };
+		ring->head.store(index + 1, std::memory_order_release);
+	}
+
+	void WriteName(FILE* file, const char* name)
+	{
+		for (const char* c = name; *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+			{
+				fputc('\\', file);
+			}
+			fputc(*c, file);
+		}
+	}
+
+	void BeginCapture()
+	{
+		{
+			// nothing records between captures, so the heads are stable here
+			std::lock_guard<std::mutex> lock(registryMutex);
+			for (const std::unique_ptr<ProfileRing>& ring : rings)
+			{
+				ring->captureStart = ring->head.load(std::memory_order_relaxed);
+			}
+		}
+
+		frameBoundaries.clear();
+		frameBoundaries.push_back(ProfilerNow());
+		captureStartTick = frameBoundaries.front();
+		captureEndTick = 0;
+		captureStartTime = std::chrono::steady_clock::now();
+		profilerCapturing.store(true, std::memory_order_relaxed);
+	}
+
+	void WriteCapture()
+	{
+		profilerCapturing.store(false, std::memory_order_relaxed);
+		captureRequested = false;
+		captureStartTick = 0;
+		captureEndTick = 0;
+
+		// timestamps are converted with the tick rate measured over the capture itself
+		double elapsedMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - captureStartTime).count();
+		uint64_t base = frameBoundaries.front();
+		uint64_t elapsedTicks = ProfilerNow() - base;
+		double ticksPerMicrosecond = elapsedMicroseconds > 0.0 && elapsedTicks > 0 ? elapsedTicks / elapsedMicroseconds : 1000.0;
+		auto toMicroseconds = [=](uint64_t ticks) { return (double) (int64_t) (ticks - base) / ticksPerMicrosecond; };
+
+		FILE* file = fopen(captureFile.c_str(), "w");
+		if (!file)
+		{
+			printf("Failed to open %s for writing\n", captureFile.c_str());
+			return;
+		}
+
+		// frames go on the thread that ends them
+		unsigned int frameThread = GetThreadRing()->threadId;
+
+		std::lock_guard<std::mutex> lock(registryMutex);
+
+		fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"OpenGLCourseApp\"}}");
+
+		size_t eventCount = 0;
+		uint64_t dropped = 0;
+
+		for (const std::unique_ptr<ProfileRing>& ring : rings)
+		{
+			fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", ring->threadId);
+			if (ring->threadName.empty())
+			{
+				fprintf(file, "Thread %u", ring->threadId);
+			}
+			else
+			{
+				WriteName(file, ring->threadName.c_str());
+			}
+			fprintf(file, "\"}}");
+
+			uint64_t head = ring->head.load(std::memory_order_acquire);
+			uint64_t first = head - ring->captureStart > RING_CAPACITY ? head - RING_CAPACITY : ring->captureStart;
+			dropped += first - ring->captureStart;
+
+			for (uint64_t i = first; i < head; i++)
+			{
+				const ProfileEvent& event = ring->events[i & (RING_CAPACITY - 1)];
+				fprintf(file, ",\n{\"name\":\"");
+				WriteName(file, event.name);
+				fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				        ring->threadId, toMicroseconds(event.start), (event.end - event.start) / ticksPerMicrosecond);
+				eventCount++;
+			}
+		}
+
+		for (size_t i = 0; i + 1 < frameBoundaries.size(); i++)
+		{
+			fprintf(file, ",\n{\"name\":\"Frame %zu\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+			        captureFirstFrame + i, frameThread, toMicroseconds(frameBoundaries[i]),
+			        (frameBoundaries[i + 1] - frameBoundaries[i]) / ticksPerMicrosecond);
+		}
+
+		fprintf(file, "\n]}\n");
+		fclose(file);
+
+		printf("Profiler: %zu events over %zu frames written to %s\n", eventCount, frameBoundaries.size() - 1, captureFile.c_str());
+		if (dropped > 0)
+		{
+			printf("Profiler: %llu oldest events were overwritten, capture fewer frames\n", (unsigned long long) dropped);
+		}
+	}
+}
+
+void ProfilerRecord(const char* name, uint64_t start, uint64_t end)
+{
+	Push(GetThreadRing(), name, start, end);
+}
+
+int ProfilerCreateTrack(const char* name)
+{
+	tracks.push_back(CreateRing(name));
+	return (int) tracks.size() - 1;
+}
+
+void ProfilerRecordOnTrack(int track, const char* name, uint64_t start, uint64_t end)
+{
+	// late events are kept only if they started inside the captured frames
+	bool inCapture = captureStartTick != 0 && start >= captureStartTick && (captureEndTick == 0 || start < captureEndTick);
+	if (inCapture && track >= 0 && track < (int) tracks.size())
+	{
+		Push(tracks[track], name, start, end);
+	}
+}
+
+void ProfilerSetThreadName(const char* name)
+{
+	GetThreadRing()->threadName = name;
+}
+
+void ProfilerEndFrame()
+{
+	if (!captureRequested)
+	{
+		return;
+	}
+
+	completedFrames++;
+
+	if (profilerCapturing.load(std::memory_order_relaxed))
+	{
+		frameBoundaries.push_back(ProfilerNow());
+
+		if (completedFrames == captureFirstFrame + captureFrameCount)
+		{
+			profilerCapturing.store(false, std::memory_order_relaxed);
+			captureEndTick = frameBoundaries.back();
+		}
+	}
+	else if (captureEndTick != 0)
+	{
+		if (completedFrames == captureFirstFrame + captureFrameCount + LATE_FRAMES)
+		{
+			WriteCapture();
+		}
+	}
+	else if (completedFrames == captureFirstFrame)
+	{
+		BeginCapture();
+	}
+}
+
+bool ProfilerStartCapture(size_t firstFrame, size_t frameCount, const char* fileName)
+{
+	if (captureRequested || frameCount == 0)
+	{
+		return false;
+	}
+
+	captureFile = fileName;
+	captureFirstFrame = completedFrames + firstFrame;
+	captureFrameCount = frameCount;
+	captureRequested = true;
+
+	if (firstFrame == 0)
+	{
+		BeginCapture();
+	}
+
+	return true;
+}
+
+void ProfilerFinishCapture()
+{
+	if (captureStartTick != 0)
+	{
+		if (profilerCapturing.load(std::memory_order_relaxed))
+		{
+			printf("Profiler: run ended after %zu of %zu captured frames\n", frameBoundaries.size() - 1, captureFrameCount);
+		}
+		WriteCapture();
+	}
+	else if (captureRequested)
+	{
+		printf("Profiler: run ended before frame %zu, nothing was captured\n", captureFirstFrame);
+	}
+}
+
+#else
+
+bool ProfilerStartCapture(size_t firstFrame, size_t frameCount, const char* fileName)
+{
+	printf("Profiler is compiled out, define ENABLE_PROFILER to capture %s\n", fileName);
+	return false;
+}
+
+void ProfilerFinishCapture()
+{
+}
+
+#endif
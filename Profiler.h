@@ -0,0 +1,93 @@
+#pragma once
+
+// Scoped CPU profiler. PROFILE_SCOPE("name") times the rest of the enclosing block and records it
+// into a lock-free ring owned by the calling thread, PROFILE_FRAME_END() marks frame boundaries.
+// Only frames inside the range given to ProfilerStartCapture are recorded, and when that range
+// ends they are written as Chrome trace event JSON (chrome://tracing or ui.perfetto.dev).
+// Without ENABLE_PROFILER the macros expand to nothing.
+// Scope names must be string literals or otherwise outlive the capture.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ENABLE_PROFILER
+
+#include <atomic>
+#include <chrono>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PROFILER_USE_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+extern std::atomic<bool> profilerCapturing;
+
+// raw timestamp, TSC ticks where available and steady_clock nanoseconds otherwise
+inline uint64_t ProfilerNow()
+{
+#ifdef PROFILER_USE_RDTSC
+	return __rdtsc();
+#else
+	return (uint64_t) std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+void ProfilerRecord(const char* name, uint64_t start, uint64_t end);
+
+class ProfileScope
+{
+public:
+	explicit ProfileScope(const char* scopeName)
+	{
+		name = scopeName;
+		start = profilerCapturing.load(std::memory_order_relaxed) ? ProfilerNow() : 0;
+	}
+
+	~ProfileScope()
+	{
+		if (start != 0)
+		{
+			ProfilerRecord(name, start, ProfilerNow());
+		}
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* name;
+	uint64_t start;
+};
+
+void ProfilerSetThreadName(const char* name);
+void ProfilerEndFrame();
+
+// extra timeline for events timed by another clock, such as GPU queries, already converted to
+// ProfilerNow ticks; each track is written by one thread and events may arrive a few frames late
+int ProfilerCreateTrack(const char* name);
+void ProfilerRecordOnTrack(int track, const char* name, uint64_t start, uint64_t end);
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__){ name }
+#define PROFILE_THREAD_NAME(name) ProfilerSetThreadName(name)
+#define PROFILE_FRAME_END() ProfilerEndFrame()
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_FRAME_END()
+
+#endif
+
+// records frames [firstFrame, firstFrame + frameCount) counted by PROFILE_FRAME_END and writes them
+// to fileName once the last one ends; one capture at a time. False if the profiler is compiled out.
+bool ProfilerStartCapture(size_t firstFrame, size_t frameCount, const char* fileName);
+
+// writes a capture the run ended in the middle of, call before exiting
+void ProfilerFinishCapture();
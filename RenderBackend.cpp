@@ -0,0 +1,26 @@
+#include "RenderBackend.h"
+
+#include "GLRenderBackend.h"
+
+static GLRenderBackend glBackend;
+static RenderBackend* currentBackend = &glBackend;
+static thread_local RenderBackend* threadBackend = nullptr;
+
+RenderBackend& GetRenderBackend()
+{
+	return threadBackend ? *threadBackend : *currentBackend;
+}
+
+void SetRenderBackend(RenderBackend* backend)
+{
+	currentBackend = backend ? backend : &glBackend;
+}
+
+void SetThreadRenderBackend(RenderBackend* backend)
+{
+	threadBackend = backend;
+}
+
+RenderBackend::~RenderBackend()
+{
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Thin interface between the engine classes (Mesh, Texture, Shader, Light, Material) and the graphics API.
+// Handles are plain GLuints so the GL backend can pass its object names straight through,
+// 0 is never a valid handle. Uniform locations follow GL, setting location -1 is silently ignored.
+class RenderBackend
+{
+public:
+	// vertex array with one interleaved float vertex buffer and one index buffer,
+	// attributeSizes gives the component count of each attribute in order, locations start at 0
+	virtual GLuint CreateVertexArray(const GLfloat* vertices, size_t vertexFloatCount, const unsigned int* indices, size_t indexCount,
+	                                 const unsigned int* attributeSizes, unsigned int attributeCount) = 0;
+	virtual void SetIndices(GLuint vertexArray, const unsigned int* indices, size_t indexCount) = 0; // replaces the whole index buffer
+	virtual void UpdateIndices(GLuint vertexArray, size_t firstIndex, const unsigned int* indices, size_t indexCount) = 0;
+	virtual void DrawIndexed(GLuint vertexArray, size_t firstIndex, size_t indexCount) = 0;
+	virtual void DrawIndexedRanges(GLuint vertexArray, const GLsizei* indexCounts, const void* const* byteOffsets, GLsizei rangeCount) = 0;
+	virtual void DestroyVertexArray(GLuint vertexArray) = 0;
+
+	virtual GLuint CreateTexture(int width, int height, const unsigned char* rgba) = 0;
+	virtual void BindTexture(GLuint texture, unsigned int unit) = 0;
+	virtual void DestroyTexture(GLuint texture) = 0;
+
+	// compiles and links, printing any errors, returns 0 on failure
+	virtual GLuint CreateProgram(const char* vertexCode, const char* fragmentCode) = 0;
+	virtual GLuint GetUniformLocation(GLuint program, const char* name) = 0;
+	virtual void UseProgram(GLuint program) = 0; // 0 unbinds
+	virtual void DestroyProgram(GLuint program) = 0;
+
+	virtual void SetUniform(GLuint location, GLfloat value) = 0;
+	virtual void SetUniform(GLuint location, const glm::vec3& value) = 0;
+	virtual void SetUniform(GLuint location, const glm::mat4& value) = 0;
+
+	virtual void Clear(const glm::vec4& color) = 0; // color and depth
+
+	virtual ~RenderBackend();
+};
+
+// backend every engine class goes through, GL unless another one was set
+RenderBackend& GetRenderBackend();
+void SetRenderBackend(RenderBackend* backend); // nullptr restores the GL backend
+
+// backend for the calling thread only, taking precedence over the one above, so job threads can record
+// into a CommandBuffer while the context thread keeps drawing; nullptr goes back to the shared backend
+void SetThreadRenderBackend(RenderBackend* backend);
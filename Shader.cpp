@@ -1,5 +1,7 @@
 #include "Shader.h"
 
+#include "RenderBackend.h"
+
 Shader::Shader() : shaderID(0), uniformModel(0), uniformProjection(0), uniformView(0)
 {
 }
@@ -9,10 +11,19 @@ void Shader::CreateFromString(const char* vertexCode, const char* fragmentCode)
 	CompileShader(vertexCode, fragmentCode);
 }
 
-void Shader::CreateFromFiles(const char* vertexLocation, const char* fragmentLocation)
+void Shader::CreateFromFiles(const char* vertexLocation, const char* fragmentLocation, const char* vertexDefines)
 {
 	std::string vertexString = ReadFile(vertexLocation);
 	std::string fragmentString = ReadFile(fragmentLocation);
+
+	if (vertexDefines)
+	{
+		// nothing but comments may come before #version
+		size_t version = vertexString.find("#version");
+		size_t lineEnd = version == std::string::npos ? std::string::npos : vertexString.find('\n', version);
+		size_t insertAt = version == std::string::npos ? 0 : lineEnd == std::string::npos ? vertexString.size() : lineEnd + 1;
+		vertexString.insert(insertAt, vertexDefines);
+	}
 	
 	const char* vertexCode = vertexString.c_str();
 	const char* fragmentCode = fragmentString.c_str();
@@ -45,51 +56,24 @@ std::string Shader::ReadFile(const char* fileLocation)
 
 void Shader::CompileShader(const char* vertexCode, const char* fragmentCode)
 {
-	shaderID = glCreateProgram(); // Create shader program
-
-	if (!shaderID)  // If shader program creation failed
-	{
-		printf("Shader program creation failed!\n");
-		return;
-	}
-
-	AddShader(shaderID, vertexCode, GL_VERTEX_SHADER);    // Add vertex shader
-	AddShader(shaderID, fragmentCode, GL_FRAGMENT_SHADER);  // Add fragment shader
-
-	const int logLength = 1024;
-	GLint result = 0;               // Compilation result
-	GLchar eLog[logLength] = { 0 }; // Error log buffer
-	GLsizei* infoLogLength = NULL;
-
-	glLinkProgram(shaderID); // Link the shader program; create executables on graphics card to link program together
-	glGetProgramiv(shaderID, GL_LINK_STATUS, &result); // Get link status
-
-	if (!result)  // Linking failed
-	{
-		glGetProgramInfoLog(shaderID, logLength, infoLogLength, eLog);
-		printf("Error linking program: '%s'\n", eLog);
-		return;
-	}
-	glValidateProgram(shaderID); // Validate the shader program
-	glGetProgramiv(shaderID, GL_VALIDATE_STATUS, &result); // Get validation status
+	shaderID = GetRenderBackend().CreateProgram(vertexCode, fragmentCode); // Compile, link and validate the shader program
 
-	if (!result)
+	if (!shaderID)  // If compiling or linking failed, the backend already printed why
 	{
-		glGetProgramInfoLog(shaderID, logLength, infoLogLength, eLog);
-		printf("Error validating program: '%s'\n", eLog);
 		return;
 	}
 
-	uniformModel = glGetUniformLocation(shaderID, "model");
-	uniformView = glGetUniformLocation(shaderID, "view");
-	uniformProjection = glGetUniformLocation(shaderID, "projection");
-	uniformEyePosition = glGetUniformLocation(shaderID, "eyePosition");
-	uniformAmbientColor = glGetUniformLocation(shaderID, "directionalLight.color");
-	uniformAmbientIntensity = glGetUniformLocation(shaderID, "directionalLight.ambientIntensity");
-	uniformDirection = glGetUniformLocation(shaderID, "directionalLight.direction");
-	uniformDiffuseIntensity = glGetUniformLocation(shaderID, "directionalLight.diffuseIntensity");
-	uniformShininess = glGetUniformLocation(shaderID, "material.shininess");
-	uniformSpecularIntensity = glGetUniformLocation(shaderID, "material.specularIntensity");
+	RenderBackend& backend = GetRenderBackend();
+	uniformModel = backend.GetUniformLocation(shaderID, "model");
+	uniformView = backend.GetUniformLocation(shaderID, "view");
+	uniformProjection = backend.GetUniformLocation(shaderID, "projection");
+	uniformEyePosition = backend.GetUniformLocation(shaderID, "eyePosition");
+	uniformAmbientColor = backend.GetUniformLocation(shaderID, "directionalLight.color");
+	uniformAmbientIntensity = backend.GetUniformLocation(shaderID, "directionalLight.ambientIntensity");
+	uniformDirection = backend.GetUniformLocation(shaderID, "directionalLight.direction");
+	uniformDiffuseIntensity = backend.GetUniformLocation(shaderID, "directionalLight.diffuseIntensity");
+	uniformShininess = backend.GetUniformLocation(shaderID, "material.shininess");
+	uniformSpecularIntensity = backend.GetUniformLocation(shaderID, "material.specularIntensity");
 }
 
 // Getters
@@ -147,14 +131,14 @@ GLuint Shader::GetSpecularIntensityLocation()
 // Shader Usage
 void Shader::UseShader()
 {
-	glUseProgram(shaderID); // Set the current active shader program to this program
+	GetRenderBackend().UseProgram(shaderID); // Set the current active shader program to this program
 }
 
 void Shader::ClearShader()
 {
 	if (shaderID != 0)
 	{
-		glDeleteProgram(shaderID); // Delete the shader program from graphics card memory
+		GetRenderBackend().DestroyProgram(shaderID); // Delete the shader program from graphics card memory
 		shaderID = 0;
 	}
 		
@@ -163,40 +147,6 @@ void Shader::ClearShader()
 	// uniformView = 0;
 }
 
-void Shader::AddShader(GLuint theProgram, const char* shaderCode, GLenum shaderType)
-{
-	GLuint theShader = glCreateShader(shaderType); // Create shader object
-
-	if (!theShader)  // If shader object creation failed
-	{
-		printf("Error creating shader type %d\n", shaderType);
-		return;
-	}
-
-	const GLchar* theCode[1];
-	theCode[0] = shaderCode;
-	GLint codeLength[1];
-	codeLength[0] = (GLint) strlen(shaderCode);
-
-	glShaderSource(theShader, 1, theCode, codeLength); // Set the source code in the shader object
-	glCompileShader(theShader); // Compile the shader
-
-	const int logLength = 1024;
-	GLint result = 0;               // Compilation result
-	GLchar eLog[logLength] = { 0 };      // Error log buffer
-	GLsizei* infoLogLength = NULL;
-	glGetShaderiv(theShader, GL_COMPILE_STATUS, &result); // Get compilation status
-
-	if (!result)  // Compilation failed
-	{
-		glGetShaderInfoLog(theShader, sizeof(eLog), infoLogLength, eLog);
-		printf("Error compiling the %d shader: '%s'\n", shaderType, eLog);
-		return;
-	}
-
-	glAttachShader(theProgram, theShader); // Attach the compiled shader to the program
-}
-
 Shader::~Shader()
 {
 	ClearShader();
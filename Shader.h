@@ -13,10 +13,13 @@ public:
 	Shader();
 
 	void CreateFromString(const char* vertexCode, const char* fragmentCode);
-	void CreateFromFiles(const char* vertexLocation, const char* fragmentLocation);
+	// defines, like "#define NAME\n", go into the vertex shader right after its #version line
+	void CreateFromFiles(const char* vertexLocation, const char* fragmentLocation, const char* vertexDefines = nullptr);
 
 	 std::string ReadFile(const char* fileLocation);
 
+	GLuint GetProgramID() { return shaderID; }
+
 	GLuint GetModelLocation();
 	GLuint GetViewLocation();
 	GLuint GetProjectionLocation();
@@ -49,5 +52,4 @@ private:
 	GLuint uniformSpecularIntensity;
 
 	void CompileShader(const char* vertexCode, const char* fragmentCode);
-	void AddShader(GLuint theProgram, const char* shaderCode, GLenum shaderType);
 };
\ No newline at end of file
@@ -11,7 +11,15 @@ out vec3 Normal;
 out vec3 FragPos;
 
 uniform mat4 model;
+#ifdef LATE_LATCH_VIEW
+// low latency mode writes the view into a buffer just before the draws are submitted
+layout (std140) uniform LatchedView
+{
+    mat4 view;
+};
+#else
 uniform mat4 view;
+#endif
 uniform mat4 projection;
 
 void main()
@@ -0,0 +1,571 @@
+#include "SoftwareRasterizer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <thread>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+#include "stb_image.h"
+
+#include "Mesh.h"
+#include "Light.h"
+#include "Material.h"
+#include "Profiler.h"
+#include "JobSystem.h"
+
+namespace
+{
+	// one lane group of pixels, so the shading code is written once for both instruction sets
+#if defined(__AVX__)
+	typedef __m256 Lanes;
+	constexpr int LANE_COUNT = 8;
+
+	inline Lanes Splat(float value) { return _mm256_set1_ps(value); }
+	inline Lanes PixelCenters() { return _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f); }
+	inline Lanes Add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+	inline Lanes Sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+	inline Lanes Mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+	inline Lanes Div(Lanes a, Lanes b) { return _mm256_div_ps(a, b); }
+	inline Lanes Max(Lanes a, Lanes b) { return _mm256_max_ps(a, b); }
+	inline Lanes Sqrt(Lanes a) { return _mm256_sqrt_ps(a); }
+	inline Lanes GreaterEqual(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	inline Lanes Less(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	inline Lanes And(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+	inline Lanes Select(Lanes mask, Lanes a, Lanes b) { return _mm256_blendv_ps(b, a, mask); }
+	inline int MoveMask(Lanes a) { return _mm256_movemask_ps(a); }
+	inline Lanes Load(const float* source) { return _mm256_loadu_ps(source); }
+	inline void Store(float* destination, Lanes a) { _mm256_storeu_ps(destination, a); }
+#else
+	typedef __m128 Lanes;
+	constexpr int LANE_COUNT = 4;
+
+	inline Lanes Splat(float value) { return _mm_set1_ps(value); }
+	inline Lanes PixelCenters() { return _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f); }
+	inline Lanes Add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+	inline Lanes Sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+	inline Lanes Mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+	inline Lanes Div(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+	inline Lanes Max(Lanes a, Lanes b) { return _mm_max_ps(a, b); }
+	inline Lanes Sqrt(Lanes a) { return _mm_sqrt_ps(a); }
+	inline Lanes GreaterEqual(Lanes a, Lanes b) { return _mm_cmpge_ps(a, b); }
+	inline Lanes Less(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+	inline Lanes And(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+	inline Lanes Select(Lanes mask, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	inline int MoveMask(Lanes a) { return _mm_movemask_ps(a); }
+	inline Lanes Load(const float* source) { return _mm_loadu_ps(source); }
+	inline void Store(float* destination, Lanes a) { _mm_storeu_ps(destination, a); }
+#endif
+
+	inline Lanes Plane(const float* plane, Lanes x, Lanes rowOffset)
+	{
+		return Add(Mul(x, Splat(plane[0])), rowOffset);
+	}
+
+	inline unsigned int PackColor(float r, float g, float b, float a)
+	{
+		auto toByte = [](float value) { return (unsigned int) (std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f); };
+		return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (toByte(a) << 24);
+	}
+
+	// GL_MIRRORED_REPEAT with nearest filtering, matching Texture::LoadTexture
+	inline int MirrorTexel(float coordinate, int size)
+	{
+		int texel = (int) std::floor(coordinate * size);
+		int period = size * 2;
+		texel %= period;
+		if (texel < 0)
+		{
+			texel += period;
+		}
+		return texel < size ? texel : period - 1 - texel;
+	}
+}
+
+SoftwareRasterizer::SoftwareRasterizer()
+{
+	width = 0;
+	height = 0;
+	paddedWidth = 0;
+	tilesX = 0;
+	tilesY = 0;
+	workers = 1;
+
+	viewProjection = glm::mat4(1.0f);
+	eye = glm::vec3(0.0f);
+	lightColor = glm::vec3(1.0f);
+	lightDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+	ambientIntensity = 1.0f;
+	diffuseIntensity = 0.0f;
+	clearValue = 0;
+}
+
+int SoftwareRasterizer::Initialize(int targetWidth, int targetHeight, unsigned int workerCount)
+{
+	if (targetWidth <= 0 || targetHeight <= 0)
+	{
+		printf("Software rasterizer size must be positive\n");
+		return 1;
+	}
+
+	width = targetWidth;
+	height = targetHeight;
+
+	// whole tiles in both directions, so lane groups never need a tail loop
+	tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	paddedWidth = tilesX * TILE_SIZE;
+
+	colorBuffer.assign((size_t) paddedWidth * tilesY * TILE_SIZE, 0);
+	depthBuffer.assign((size_t) paddedWidth * tilesY * TILE_SIZE, 1.0f);
+	tileBins.assign((size_t) tilesX * tilesY, std::vector<unsigned int>());
+
+	workers = workerCount > 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency());
+
+	return 0;
+}
+
+int SoftwareRasterizer::LoadTexture(const char* fileLocation)
+{
+	constexpr int CHANNELS = 4;
+
+	TextureData texture;
+	int channels = 0;
+	unsigned char* texData = stbi_load(fileLocation, &texture.width, &texture.height, &channels, CHANNELS);
+
+	if (!texData)
+	{
+		printf("Failed to find: %s\n", fileLocation);
+		return -1;
+	}
+
+	texture.texels.assign(texData, texData + (size_t) texture.width * texture.height * CHANNELS);
+	stbi_image_free(texData);
+
+	textures.push_back(texture);
+	return (int) textures.size() - 1;
+}
+
+void SoftwareRasterizer::BeginFrame(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eyePosition,
+                                    const Light& light, const glm::vec4& clearColor)
+{
+	viewProjection = projection * view;
+	eye = eyePosition;
+
+	lightColor = light.getColor();
+	lightDirection = glm::normalize(light.getDirection());
+	ambientIntensity = light.getAmbientIntensity();
+	diffuseIntensity = light.getDiffuseIntensity();
+	clearValue = PackColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+
+	triangles.clear();
+	frameMaterials.clear();
+	for (std::vector<unsigned int>& bin : tileBins)
+	{
+		bin.clear();
+	}
+}
+
+void SoftwareRasterizer::DrawMesh(const Mesh& mesh, const glm::mat4& model, int texture, const Material& material)
+{
+	const std::vector<float>& vertices = mesh.GetVertices();
+	const std::vector<unsigned int>& indices = mesh.GetIndices();
+
+	if (vertices.empty() || indices.empty())
+	{
+		printf("Mesh has no CPU side geometry to rasterize\n");
+		return;
+	}
+
+	DrawTriangles(vertices.data(), mesh.GetVertexLength(), indices.data(), (unsigned int) indices.size(), model, texture, material);
+}
+
+void SoftwareRasterizer::DrawTriangles(const float* vertices, unsigned int vertexLength, const unsigned int* indices, unsigned int indexCount,
+                                       const glm::mat4& model, int texture, const Material& material)
+{
+	PROFILE_SCOPE("Transform and bin");
+
+	frameMaterials.push_back(ShadingMaterial{ material.getSpecularIntensity(), material.getShininess() });
+	int materialIndex = (int) frameMaterials.size() - 1;
+
+	unsigned int vertexCount = 0;
+	for (unsigned int i = 0; i < indexCount; i++)
+	{
+		vertexCount = std::max(vertexCount, indices[i] + 1);
+	}
+
+	// vertex stage, the same transforms as Shader.vert
+	glm::mat4 modelViewProjection = viewProjection * model;
+	glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(model)));
+
+	transformed.resize(vertexCount);
+	for (unsigned int i = 0; i < vertexCount; i++)
+	{
+		const float* vertex = vertices + i * vertexLength;
+		glm::vec4 position{ vertex[0], vertex[1], vertex[2], 1.0f };
+		glm::vec3 normal = normalMatrix * glm::vec3(vertex[5], vertex[6], vertex[7]);
+		glm::vec3 worldPosition = glm::vec3(model * position);
+
+		ClipVertex& out = transformed[i];
+		out.clip = modelViewProjection * position;
+		out.attributes[0] = vertex[3];
+		out.attributes[1] = vertex[4];
+		out.attributes[2] = normal.x;
+		out.attributes[3] = normal.y;
+		out.attributes[4] = normal.z;
+		out.attributes[5] = worldPosition.x;
+		out.attributes[6] = worldPosition.y;
+		out.attributes[7] = worldPosition.z;
+	}
+
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+	{
+		ClipAndBin(transformed[indices[i]], transformed[indices[i + 1]], transformed[indices[i + 2]], texture, materialIndex);
+	}
+}
+
+void SoftwareRasterizer::ClipAndBin(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, int texture, int material)
+{
+	// Sutherland-Hodgman against the near plane z >= -w, the other planes are handled by clamping to the screen
+	const ClipVertex* input[3] = { &v0, &v1, &v2 };
+	ClipVertex clipped[4];
+	int clippedCount = 0;
+
+	for (int i = 0; i < 3; i++)
+	{
+		const ClipVertex& current = *input[i];
+		const ClipVertex& next = *input[(i + 1) % 3];
+		float currentDistance = current.clip.z + current.clip.w;
+		float nextDistance = next.clip.z + next.clip.w;
+
+		if (currentDistance >= 0.0f)
+		{
+			clipped[clippedCount++] = current;
+		}
+
+		if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+		{
+			float t = currentDistance / (currentDistance - nextDistance);
+			ClipVertex& intersection = clipped[clippedCount++];
+			intersection.clip = current.clip + (next.clip - current.clip) * t;
+			for (int k = 0; k < ATTRIBUTE_COUNT; k++)
+			{
+				intersection.attributes[k] = current.attributes[k] + (next.attributes[k] - current.attributes[k]) * t;
+			}
+		}
+	}
+
+	for (int i = 1; i + 1 < clippedCount; i++)
+	{
+		SetupTriangle(clipped[0], clipped[i], clipped[i + 1], texture, material);
+	}
+}
+
+void SoftwareRasterizer::SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, int texture, int material)
+{
+	const ClipVertex* vertices[3] = { &v0, &v1, &v2 };
+	float x[3], y[3], z[3], inverseW[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& clip = vertices[i]->clip;
+		if (clip.w <= 0.0f)
+		{
+			return;
+		}
+
+		inverseW[i] = 1.0f / clip.w;
+		x[i] = (clip.x * inverseW[i] * 0.5f + 0.5f) * width;
+		y[i] = (clip.y * inverseW[i] * 0.5f + 0.5f) * height;
+		z[i] = clip.z * inverseW[i] * 0.5f + 0.5f;
+	}
+
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (area == 0.0f)
+	{
+		return;
+	}
+
+	Triangle triangle;
+	triangle.minX = std::max(0, (int) std::floor(std::min(x[0], std::min(x[1], x[2]))));
+	triangle.maxX = std::min(width - 1, (int) std::ceil(std::max(x[0], std::max(x[1], x[2]))));
+	triangle.minY = std::max(0, (int) std::floor(std::min(y[0], std::min(y[1], y[2]))));
+	triangle.maxY = std::min(height - 1, (int) std::ceil(std::max(y[0], std::max(y[1], y[2]))));
+
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+	{
+		return;
+	}
+
+	// edge functions positive inside, face culling is off in the GL path so both windings are drawn
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		int j = (i + 1) % 3;
+		triangle.edges[i][0] = (y[i] - y[j]) * sign;
+		triangle.edges[i][1] = (x[j] - x[i]) * sign;
+		triangle.edges[i][2] = (x[i] * y[j] - y[i] * x[j]) * sign;
+	}
+
+	auto setupPlane = [&](const float* values, float* plane) {
+		plane[0] = ((values[1] - values[0]) * (y[2] - y[0]) - (values[2] - values[0]) * (y[1] - y[0])) / area;
+		plane[1] = ((values[2] - values[0]) * (x[1] - x[0]) - (values[1] - values[0]) * (x[2] - x[0])) / area;
+		plane[2] = values[0] - plane[0] * x[0] - plane[1] * y[0];
+	};
+
+	setupPlane(z, triangle.depth);
+	setupPlane(inverseW, triangle.inverseW);
+	for (int k = 0; k < ATTRIBUTE_COUNT; k++)
+	{
+		float values[3];
+		for (int i = 0; i < 3; i++)
+		{
+			values[i] = vertices[i]->attributes[k] * inverseW[i];
+		}
+		setupPlane(values, triangle.attributes[k]);
+	}
+
+	triangle.texture = texture;
+	triangle.material = material;
+
+	unsigned int triangleIndex = (unsigned int) triangles.size();
+	triangles.push_back(triangle);
+
+	for (int tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; tileY++)
+	{
+		for (int tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; tileX++)
+		{
+			tileBins[tileY * tilesX + tileX].push_back(triangleIndex);
+		}
+	}
+}
+
+void SoftwareRasterizer::EndFrame()
+{
+	const int tileCount = tilesX * tilesY;
+
+	// with the job system, idle threads steal ranges of tiles, which balances cheap and expensive tiles the same way
+	if (IsJobSystemRunning())
+	{
+		ParallelFor((size_t) tileCount, [this](size_t begin, size_t end) {
+			PROFILE_SCOPE("Rasterize tiles");
+			for (size_t tile = begin; tile < end; tile++)
+			{
+				RasterizeTile((int) tile);
+			}
+		});
+		return;
+	}
+
+	// tiles are handed out one at a time, so threads that finish cheap tiles take over the remaining work
+	std::atomic<int> nextTile{ 0 };
+	auto worker = [this, &nextTile, tileCount]() {
+		PROFILE_SCOPE("Rasterize tiles");
+		for (int tile = nextTile++; tile < tileCount; tile = nextTile++)
+		{
+			RasterizeTile(tile);
+		}
+	};
+
+	std::vector<std::future<void>> helpers;
+	for (unsigned int i = 1; i < std::min<unsigned int>(workers, tileCount); i++)
+	{
+		helpers.push_back(std::async(std::launch::async, worker));
+	}
+
+	worker();
+
+	for (std::future<void>& helper : helpers)
+	{
+		helper.get();
+	}
+}
+
+void SoftwareRasterizer::RasterizeTile(int tile)
+{
+	const int tileMinX = (tile % tilesX) * TILE_SIZE;
+	const int tileMinY = (tile / tilesX) * TILE_SIZE;
+	const int tileMaxX = tileMinX + TILE_SIZE - 1;
+	const int tileMaxY = tileMinY + TILE_SIZE - 1;
+
+	for (int y = tileMinY; y <= tileMaxY; y++)
+	{
+		std::fill_n(colorBuffer.begin() + (size_t) y * paddedWidth + tileMinX, TILE_SIZE, clearValue);
+		std::fill_n(depthBuffer.begin() + (size_t) y * paddedWidth + tileMinX, TILE_SIZE, 1.0f);
+	}
+
+	const Lanes zero = Splat(0.0f);
+	const Lanes one = Splat(1.0f);
+	const Lanes tiny = Splat(1e-20f);
+	const Lanes centers = PixelCenters();
+	const Lanes lightX = Splat(lightDirection.x);
+	const Lanes lightY = Splat(lightDirection.y);
+	const Lanes lightZ = Splat(lightDirection.z);
+
+	alignas(32) float diffuseFactors[LANE_COUNT];
+	alignas(32) float specularFactors[LANE_COUNT];
+	alignas(32) float texU[LANE_COUNT];
+	alignas(32) float texV[LANE_COUNT];
+
+	for (unsigned int triangleIndex : tileBins[tile])
+	{
+		const Triangle& triangle = triangles[triangleIndex];
+		const ShadingMaterial& material = frameMaterials[triangle.material];
+
+		int minX = std::max(triangle.minX, tileMinX) / LANE_COUNT * LANE_COUNT;
+		int maxX = std::min(triangle.maxX, tileMaxX);
+		int minY = std::max(triangle.minY, tileMinY);
+		int maxY = std::min(triangle.maxY, tileMaxY);
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			float py = y + 0.5f;
+			float* depthRow = depthBuffer.data() + (size_t) y * paddedWidth;
+			unsigned int* colorRow = colorBuffer.data() + (size_t) y * paddedWidth;
+
+			// the y part of every plane is constant along the row
+			Lanes edgeRows[3];
+			for (int i = 0; i < 3; i++)
+			{
+				edgeRows[i] = Splat(triangle.edges[i][1] * py + triangle.edges[i][2]);
+			}
+			Lanes depthRow0 = Splat(triangle.depth[1] * py + triangle.depth[2]);
+			Lanes inverseWRow = Splat(triangle.inverseW[1] * py + triangle.inverseW[2]);
+			Lanes attributeRows[ATTRIBUTE_COUNT];
+			for (int k = 0; k < ATTRIBUTE_COUNT; k++)
+			{
+				attributeRows[k] = Splat(triangle.attributes[k][1] * py + triangle.attributes[k][2]);
+			}
+
+			for (int x = minX; x <= maxX; x += LANE_COUNT)
+			{
+				Lanes px = Add(Splat((float) x), centers);
+
+				Lanes inside = And(GreaterEqual(Plane(triangle.edges[0], px, edgeRows[0]), zero),
+				               And(GreaterEqual(Plane(triangle.edges[1], px, edgeRows[1]), zero),
+				                   GreaterEqual(Plane(triangle.edges[2], px, edgeRows[2]), zero)));
+
+				if (MoveMask(inside) == 0)
+				{
+					continue;
+				}
+
+				// early depth test with GL_LESS, same as the GL path
+				Lanes depth = Plane(triangle.depth, px, depthRow0);
+				Lanes oldDepth = Load(depthRow + x);
+				inside = And(inside, Less(depth, oldDepth));
+
+				int coverage = MoveMask(inside);
+				if (coverage == 0)
+				{
+					continue;
+				}
+
+				Store(depthRow + x, Select(inside, depth, oldDepth));
+
+				// perspective correct attributes
+				Lanes w = Div(one, Plane(triangle.inverseW, px, inverseWRow));
+				Lanes attributes[ATTRIBUTE_COUNT];
+				for (int k = 0; k < ATTRIBUTE_COUNT; k++)
+				{
+					attributes[k] = Mul(Plane(triangle.attributes[k], px, attributeRows[k]), w);
+				}
+
+				Lanes normalLength = Max(Sqrt(Add(Add(Mul(attributes[2], attributes[2]), Mul(attributes[3], attributes[3])), Mul(attributes[4], attributes[4]))), tiny);
+				Lanes normalX = Div(attributes[2], normalLength);
+				Lanes normalY = Div(attributes[3], normalLength);
+				Lanes normalZ = Div(attributes[4], normalLength);
+
+				// Shader.frag: diffuse from the light direction as given, specular from its reflection
+				Lanes normalDotLight = Add(Add(Mul(normalX, lightX), Mul(normalY, lightY)), Mul(normalZ, lightZ));
+				Lanes diffuse = Max(normalDotLight, zero);
+
+				Lanes toEyeX = Sub(Splat(eye.x), attributes[5]);
+				Lanes toEyeY = Sub(Splat(eye.y), attributes[6]);
+				Lanes toEyeZ = Sub(Splat(eye.z), attributes[7]);
+				Lanes toEyeLength = Max(Sqrt(Add(Add(Mul(toEyeX, toEyeX), Mul(toEyeY, toEyeY)), Mul(toEyeZ, toEyeZ))), tiny);
+
+				Lanes twoDot = Add(normalDotLight, normalDotLight);
+				Lanes reflectedX = Sub(lightX, Mul(twoDot, normalX));
+				Lanes reflectedY = Sub(lightY, Mul(twoDot, normalY));
+				Lanes reflectedZ = Sub(lightZ, Mul(twoDot, normalZ));
+				Lanes reflectedLength = Max(Sqrt(Add(Add(Mul(reflectedX, reflectedX), Mul(reflectedY, reflectedY)), Mul(reflectedZ, reflectedZ))), tiny);
+
+				Lanes specular = Div(Add(Add(Mul(toEyeX, reflectedX), Mul(toEyeY, reflectedY)), Mul(toEyeZ, reflectedZ)),
+				                     Mul(toEyeLength, reflectedLength));
+
+				Store(diffuseFactors, diffuse);
+				Store(specularFactors, specular);
+				Store(texU, attributes[0]);
+				Store(texV, attributes[1]);
+
+				// pow and the texture fetch are per pixel gathers, finish the covered lanes in scalar
+				for (int lane = 0; lane < LANE_COUNT; lane++)
+				{
+					if (!(coverage & (1 << lane)))
+					{
+						continue;
+					}
+
+					float diffuseFactor = diffuseFactors[lane];
+					float lightScale = ambientIntensity + diffuseIntensity * diffuseFactor;
+					float alphaScale = lightScale;
+
+					if (diffuseFactor > 0.0f && specularFactors[lane] > 0.0f)
+					{
+						lightScale += material.specularIntensity * std::pow(specularFactors[lane], material.shininess);
+						alphaScale += 1.0f;
+					}
+
+					unsigned int texel = SampleTexture(triangle.texture, texU[lane], texV[lane]);
+					float r = (texel & 0xFF) / 255.0f;
+					float g = ((texel >> 8) & 0xFF) / 255.0f;
+					float b = ((texel >> 16) & 0xFF) / 255.0f;
+					float a = (texel >> 24) / 255.0f;
+
+					colorRow[x + lane] = PackColor(r * lightColor.r * lightScale, g * lightColor.g * lightScale,
+					                               b * lightColor.b * lightScale, a * alphaScale);
+				}
+			}
+		}
+	}
+}
+
+unsigned int SoftwareRasterizer::SampleTexture(int texture, float u, float v) const
+{
+	if (texture < 0 || texture >= (int) textures.size())
+	{
+		return 0xFFFFFFFFu;
+	}
+
+	const TextureData& data = textures[texture];
+	int column = MirrorTexel(u, data.width);
+	int row = MirrorTexel(v, data.height);
+
+	unsigned int texel;
+	memcpy(&texel, &data.texels[((size_t) row * data.width + column) * 4], sizeof(texel));
+	return texel;
+}
+
+void SoftwareRasterizer::ReadPixels(std::vector<unsigned char>& pixels) const
+{
+	constexpr int CHANNELS = 4;
+
+	pixels.resize((size_t) width * height * CHANNELS);
+	for (int y = 0; y < height; y++)
+	{
+		memcpy(&pixels[(size_t) y * width * CHANNELS], &colorBuffer[(size_t) y * paddedWidth], (size_t) width * CHANNELS);
+	}
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+}
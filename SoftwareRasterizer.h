@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Mesh;
+class Light;
+class Material;
+
+// CPU renderer for machines without a GPU and for reference images.
+// Runs the same Phong model as Shaders/Shader.vert and Shader.frag on the Mesh vertex layout (XYZ UV normal).
+// Triangles are clipped against the near plane and binned into screen tiles, tiles are then
+// rasterized and shaded on all threads a SIMD lane group (8 pixels with AVX, 4 with SSE2) at a time.
+class SoftwareRasterizer
+{
+public:
+	SoftwareRasterizer();
+
+	int Initialize(int targetWidth, int targetHeight, unsigned int workerCount = 0); // 0 uses every hardware thread, the job system's threads are used instead while it runs
+
+	// loads RGBA texels for sampling, returns the texture index or -1
+	int LoadTexture(const char* fileLocation);
+
+	void BeginFrame(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& eyePosition,
+	                const Light& light, const glm::vec4& clearColor);
+	void DrawMesh(const Mesh& mesh, const glm::mat4& model, int texture, const Material& material);
+	void DrawTriangles(const float* vertices, unsigned int vertexLength, const unsigned int* indices, unsigned int indexCount,
+	                   const glm::mat4& model, int texture, const Material& material);
+	void EndFrame(); // rasterizes and shades every binned triangle
+
+	void ReadPixels(std::vector<unsigned char>& pixels) const; // tightly packed RGBA, bottom row first like glReadPixels
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	size_t GetTriangleCount() const { return triangles.size(); }
+
+	~SoftwareRasterizer();
+
+private:
+	static constexpr int TILE_SIZE = 64;
+	static constexpr int ATTRIBUTE_COUNT = 8; // UV, world normal, world position
+
+	struct ClipVertex
+	{
+		glm::vec4 clip;
+		float attributes[ATTRIBUTE_COUNT];
+	};
+
+	// everything the tile workers need, values are planes a * x + b * y + c in screen space
+	struct Triangle
+	{
+		float edges[3][3];
+		float depth[3];
+		float inverseW[3];
+		float attributes[ATTRIBUTE_COUNT][3]; // attribute / w, so dividing by the interpolated 1 / w is perspective correct
+		int minX, maxX, minY, maxY;
+		int texture;
+		int material;
+	};
+
+	struct TextureData
+	{
+		int width;
+		int height;
+		std::vector<unsigned char> texels;
+	};
+
+	struct ShadingMaterial
+	{
+		float specularIntensity;
+		float shininess;
+	};
+
+	int width, height;
+	int paddedWidth;
+	int tilesX, tilesY;
+	unsigned int workers;
+
+	std::vector<unsigned int> colorBuffer; // packed RGBA8
+	std::vector<float> depthBuffer;
+
+	std::vector<TextureData> textures;
+	std::vector<ShadingMaterial> frameMaterials;
+
+	std::vector<Triangle> triangles;
+	std::vector<std::vector<unsigned int>> tileBins;
+	std::vector<ClipVertex> transformed; // scratch for the vertices of one draw
+
+	glm::mat4 viewProjection;
+	glm::vec3 eye;
+	glm::vec3 lightColor;
+	glm::vec3 lightDirection;
+	float ambientIntensity;
+	float diffuseIntensity;
+	unsigned int clearValue;
+
+	void ClipAndBin(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, int texture, int material);
+	void SetupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, int texture, int material);
+	void RasterizeTile(int tile);
+	unsigned int SampleTexture(int texture, float u, float v) const;
+};
@@ -0,0 +1,340 @@
+#include "StressScene.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Benchmark.h"
+#include "JSONReader.h"
+
+namespace
+{
+	constexpr unsigned int VERTEX_LENGTH = 8; // XYZ UV normal
+	constexpr unsigned int NORMAL_OFFSET = 5;
+	constexpr unsigned int MAX_LOD_LEVELS = 4;
+
+	// sphere tessellation spans this range across the geometries, in slices around the equator
+	constexpr unsigned int MIN_SLICES = 8;
+	constexpr unsigned int MAX_SLICES = 96;
+
+	constexpr int TEXTURE_SIZE = 256;
+
+	// objects sit on a shell around the origin that grows with the object count to keep density bounded
+	constexpr float MIN_OBJECT_DISTANCE = 5.0f;
+	constexpr float OBJECT_SPREAD = 3.0f;
+	constexpr float VERTICAL_SQUASH = 0.3f; // keep most objects near the horizon the headless camera sweeps
+
+	enum RandomStream
+	{
+		GEOMETRY_STREAM,
+		TEXTURE_STREAM,
+		LIGHT_STREAM,
+		OBJECT_STREAM
+	};
+
+	std::mt19937 CreateStream(unsigned int seed, RandomStream stream)
+	{
+		std::seed_seq sequence{ seed, (unsigned int) stream };
+		return std::mt19937(sequence);
+	}
+
+	// mt19937's output is fixed by the standard but the distributions are not, so scenes are only
+	// identical across compilers with hand rolled conversions
+	float RandomFloat(std::mt19937& rng, float min, float max)
+	{
+		return min + (max - min) * (float) (rng() >> 8) * (1.0f / 16777216.0f);
+	}
+
+	unsigned int RandomIndex(std::mt19937& rng, unsigned int count)
+	{
+		return (unsigned int) (rng() % count);
+	}
+
+	// UV sphere with its radius displaced by a product of sines, so every geometry has a distinct silhouette
+	void CreateNoisySphere(std::mt19937& rng, unsigned int slices, std::vector<GLfloat>& vertices, std::vector<unsigned int>& indices)
+	{
+		const unsigned int rings = slices / 2;
+		const float amplitude = RandomFloat(rng, 0.05f, 0.35f);
+		const glm::vec3 frequency{ RandomFloat(rng, 1.0f, 5.0f), RandomFloat(rng, 1.0f, 5.0f), RandomFloat(rng, 1.0f, 5.0f) };
+		const glm::vec3 phase{ RandomFloat(rng, 0.0f, 6.28f), RandomFloat(rng, 0.0f, 6.28f), RandomFloat(rng, 0.0f, 6.28f) };
+		const float uvRepeat = (float) RandomIndex(rng, 4) + 1.0f;
+
+		vertices.clear();
+		indices.clear();
+
+		for (unsigned int ring = 0; ring <= rings; ring++)
+		{
+			float theta = glm::pi<float>() * ring / rings;
+			for (unsigned int slice = 0; slice <= slices; slice++)
+			{
+				float phi = glm::two_pi<float>() * slice / slices;
+				glm::vec3 direction{ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+				glm::vec3 wave = glm::sin(direction * frequency + phase);
+				glm::vec3 position = direction * (1.0f + amplitude * wave.x * wave.y * wave.z);
+
+				const GLfloat vertex[VERTEX_LENGTH] = { position.x, position.y, position.z,
+				                                        uvRepeat * slice / slices, (float) ring / rings,
+				                                        0.0f, 0.0f, 0.0f };
+				vertices.insert(vertices.end(), vertex, vertex + VERTEX_LENGTH);
+			}
+		}
+
+		// counter clockwise seen from outside, the triangles touching a pole would be degenerate on one side
+		for (unsigned int ring = 0; ring < rings; ring++)
+		{
+			for (unsigned int slice = 0; slice < slices; slice++)
+			{
+				unsigned int top = ring * (slices + 1) + slice;
+				unsigned int bottom = top + slices + 1;
+
+				if (ring > 0)
+				{
+					const unsigned int upper[] = { top, top + 1, bottom };
+					indices.insert(indices.end(), upper, upper + 3);
+				}
+				if (ring < rings - 1)
+				{
+					const unsigned int lower[] = { top + 1, bottom + 1, bottom };
+					indices.insert(indices.end(), lower, lower + 3);
+				}
+			}
+		}
+
+		calcAverageNormals(indices.data(), (unsigned int) indices.size(), vertices.data(), (unsigned int) vertices.size(), VERTEX_LENGTH, NORMAL_OFFSET);
+	}
+
+	// checkerboard of two random colors with per pixel grain, so neighbouring texels differ like a real texture
+	void CreateTexturePixels(std::mt19937& rng, std::vector<unsigned char>& pixels)
+	{
+		unsigned char colors[2][3];
+		for (auto& color : colors)
+		{
+			for (unsigned char& channel : color)
+			{
+				channel = (unsigned char) RandomIndex(rng, 192);
+			}
+		}
+		const int cellSize = 4 << RandomIndex(rng, 5);
+
+		pixels.resize(TEXTURE_SIZE * TEXTURE_SIZE * 4);
+		for (int y = 0; y < TEXTURE_SIZE; y++)
+		{
+			for (int x = 0; x < TEXTURE_SIZE; x++)
+			{
+				const unsigned char* color = colors[(x / cellSize + y / cellSize) & 1];
+				unsigned char* pixel = &pixels[(y * TEXTURE_SIZE + x) * 4];
+				for (int channel = 0; channel < 3; channel++)
+				{
+					pixel[channel] = (unsigned char) (color[channel] + RandomIndex(rng, 64));
+				}
+				pixel[3] = 255;
+			}
+		}
+	}
+}
+
+StressScene::StressScene() : config{}
+{
+}
+
+int StressScene::Generate(const StressSceneConfig& sceneConfig)
+{
+	Clear();
+
+	if (sceneConfig.objects > 0 && (sceneConfig.geometries == 0 || sceneConfig.textures == 0 || sceneConfig.lights == 0))
+	{
+		printf("Stress scene needs at least one geometry, texture and light\n");
+		return 1;
+	}
+
+	config = sceneConfig;
+
+	std::mt19937 geometryRng = CreateStream(config.seed, GEOMETRY_STREAM);
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+	for (unsigned int i = 0; i < config.geometries; i++)
+	{
+		// coarse to dense, rounded to even so the rings divide the sphere evenly
+		unsigned int slices = MIN_SLICES + (MAX_SLICES - MIN_SLICES) * i / std::max(config.geometries - 1, 1u);
+		slices &= ~1u;
+
+		CreateNoisySphere(geometryRng, slices, vertices, indices);
+
+		Mesh* mesh = new Mesh{ };
+		mesh->CreateMesh(vertices.data(), indices.data(), (unsigned int) vertices.size(), (unsigned int) indices.size());
+		mesh->BuildMeshlets();
+		mesh->GenerateLODs(MAX_LOD_LEVELS);
+		meshes.push_back(mesh);
+	}
+
+	std::mt19937 textureRng = CreateStream(config.seed, TEXTURE_STREAM);
+	std::vector<unsigned char> pixels;
+	for (unsigned int i = 0; i < config.textures; i++)
+	{
+		CreateTexturePixels(textureRng, pixels);
+
+		Texture* texture = new Texture{ };
+		texture->LoadTexture(TEXTURE_SIZE, TEXTURE_SIZE, pixels.data());
+		textures.push_back(texture);
+
+		materials.push_back(Material{ RandomFloat(textureRng, 0.0f, 1.0f), (float) (2 << RandomIndex(textureRng, 6)) });
+	}
+
+	std::mt19937 lightRng = CreateStream(config.seed, LIGHT_STREAM);
+	for (unsigned int i = 0; i < config.lights; i++)
+	{
+		lights.push_back(Light{ RandomFloat(lightRng, 0.6f, 1.0f), RandomFloat(lightRng, 0.6f, 1.0f), RandomFloat(lightRng, 0.6f, 1.0f),
+		                        RandomFloat(lightRng, 0.1f, 0.3f),
+		                        RandomFloat(lightRng, -1.0f, 1.0f), RandomFloat(lightRng, -1.0f, -0.2f), RandomFloat(lightRng, -1.0f, 1.0f),
+		                        RandomFloat(lightRng, 0.3f, 1.0f) });
+	}
+
+	std::mt19937 objectRng = CreateStream(config.seed, OBJECT_STREAM);
+	const float maxDistance = MIN_OBJECT_DISTANCE + OBJECT_SPREAD * std::cbrt((float) config.objects);
+	std::vector<float> radii;
+	objects.reserve(config.objects);
+	radii.reserve(config.objects);
+	for (unsigned int i = 0; i < config.objects; i++)
+	{
+		StressObject object{};
+		object.geometry = RandomIndex(objectRng, config.geometries);
+		object.texture = RandomIndex(objectRng, config.textures);
+		object.light = RandomIndex(objectRng, config.lights);
+
+		float angle = RandomFloat(objectRng, 0.0f, glm::two_pi<float>());
+		float distance = RandomFloat(objectRng, MIN_OBJECT_DISTANCE, maxDistance);
+		float height = RandomFloat(objectRng, -1.0f, 1.0f) * distance * VERTICAL_SQUASH;
+		glm::vec3 position{ std::cos(angle) * distance, height, std::sin(angle) * distance };
+
+		glm::vec3 rotation{ RandomFloat(objectRng, 0.0f, 6.28f), RandomFloat(objectRng, 0.0f, 6.28f), RandomFloat(objectRng, 0.0f, 6.28f) };
+		float scale = RandomFloat(objectRng, 0.3f, 1.5f);
+
+		object.model = glm::translate(glm::mat4{ 1.0f }, position);
+		object.model = glm::rotate(object.model, rotation.x, glm::vec3{ 1.0f, 0.0f, 0.0f });
+		object.model = glm::rotate(object.model, rotation.y, glm::vec3{ 0.0f, 1.0f, 0.0f });
+		object.model = glm::rotate(object.model, rotation.z, glm::vec3{ 0.0f, 0.0f, 1.0f });
+		object.model = glm::scale(object.model, glm::vec3{ scale });
+		objects.push_back(object);
+		radii.push_back(meshes[object.geometry]->GetBoundingSphere().radius * scale);
+	}
+
+	// the largest objects hide the most, a fixed number of them keeps the occlusion cost bounded as the scene grows
+	std::vector<unsigned int> bySize(objects.size());
+	for (unsigned int i = 0; i < bySize.size(); i++)
+	{
+		bySize[i] = i;
+	}
+	unsigned int occluders = std::min(config.occluders, (unsigned int) objects.size());
+	std::partial_sort(bySize.begin(), bySize.begin() + occluders, bySize.end(), [&radii](unsigned int a, unsigned int b) {
+		return radii[a] > radii[b] || (radii[a] == radii[b] && a < b);
+	});
+	for (unsigned int i = 0; i < occluders; i++)
+	{
+		objects[bySize[i]].occluder = true;
+	}
+
+	return 0;
+}
+
+size_t StressScene::GetUniqueTriangleCount() const
+{
+	size_t triangles = 0;
+	for (const Mesh* mesh : meshes)
+	{
+		triangles += mesh->GetIndexCount(0) / 3;
+	}
+	return triangles;
+}
+
+size_t StressScene::GetInstancedTriangleCount() const
+{
+	size_t triangles = 0;
+	for (const StressObject& object : objects)
+	{
+		triangles += meshes[object.geometry]->GetIndexCount(0) / 3;
+	}
+	return triangles;
+}
+
+void StressScene::Clear()
+{
+	for (Mesh* mesh : meshes)
+	{
+		delete mesh;
+	}
+	for (Texture* texture : textures)
+	{
+		texture->ClearTexture();
+		delete texture;
+	}
+
+	meshes.clear();
+	textures.clear();
+	materials.clear();
+	lights.clear();
+	objects.clear();
+}
+
+StressScene::~StressScene()
+{
+	Clear();
+}
+
+int WriteStressReport(const char* fileName, const StressScene& scene, const StressRunInfo& run,
+                      const std::vector<double>& frameTimes, const FrameTelemetry& telemetry)
+{
+	FILE* file = fopen(fileName, "w");
+	if (!file)
+	{
+		printf("Failed to open %s for writing\n", fileName);
+		return 1;
+	}
+
+	const StressSceneConfig& config = scene.getConfig();
+	fprintf(file, "{\n");
+	fprintf(file, "  \"scene\": { \"objects\": %u, \"geometries\": %u, \"textures\": %u, \"lights\": %u, \"seed\": %u, \"occluders\": %u, "
+	              "\"unique_triangles\": %zu, \"instanced_triangles\": %zu },\n",
+	        config.objects, config.geometries, config.textures, config.lights, config.seed, config.occluders,
+	        scene.GetUniqueTriangleCount(), scene.GetInstancedTriangleCount());
+
+	fprintf(file, "  \"run\": { \"backend\": \"%s\", \"pipelined\": %s, \"camera_path\": ", run.backend, run.pipelined ? "true" : "false");
+	if (run.cameraPath)
+	{
+		WriteJSONString(file, run.cameraPath);
+	}
+	else
+	{
+		fprintf(file, "null");
+	}
+	fprintf(file, ", \"width\": %d, \"height\": %d, \"generate_ms\": %.3f, \"drawn_objects\": %.3f, "
+	              "\"full_detail_triangles\": %.3f, \"rendered_triangles\": %.3f, "
+	              "\"occluders\": %zu, \"occlusion_tested\": %.3f, \"occlusion_occluded\": %.3f, \"occluded_percent\": %.3f },\n",
+	        run.width, run.height, run.generateTime, run.drawnObjects, run.fullDetailTriangles, run.renderedTriangles, run.occluders,
+	        run.occlusionTested, run.occlusionOccluded, run.occlusionTested > 0.0 ? 100.0 * run.occlusionOccluded / run.occlusionTested : 0.0);
+
+	// same nearest rank percentiles PrintFrameTimes reports
+	std::vector<double> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (double frameTime : sorted)
+	{
+		total += frameTime;
+	}
+
+	fprintf(file, "  \"frame_ms\": { \"count\": %zu, \"mean\": %.6f, \"p50\": %.6f, \"p95\": %.6f, \"p99\": %.6f, \"max\": %.6f },\n",
+	        sorted.size(), sorted.empty() ? 0.0 : total / sorted.size(), NearestRankPercentile(sorted, 50.0),
+	        NearestRankPercentile(sorted, 95.0), NearestRankPercentile(sorted, 99.0), sorted.empty() ? 0.0 : sorted.back());
+
+	telemetry.WriteJSON(file);
+	fprintf(file, "}\n");
+
+	fclose(file);
+	printf("Stress report written to %s\n", fileName);
+	return 0;
+}
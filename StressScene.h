@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Mesh.h"
+#include "Texture.h"
+#include "Material.h"
+#include "Light.h"
+#include "Telemetry.h"
+
+struct StressSceneConfig
+{
+	unsigned int objects;
+	unsigned int geometries; // unique meshes the objects instance
+	unsigned int textures;   // each texture comes with its own material
+	unsigned int lights;
+	unsigned int seed;
+	unsigned int occluders;  // largest objects, the only ones rasterized into the occlusion buffer
+};
+
+struct StressObject
+{
+	unsigned int geometry;
+	unsigned int texture;
+	unsigned int light;
+	glm::mat4 model;
+	bool occluder;
+};
+
+// Procedural scene for benchmarking the renderer at scale. Geometries are noisy spheres from coarse
+// to dense, textures are generated in memory and objects are scattered around the origin, where the
+// headless camera turns. Each part of the scene has its own random stream derived from the seed, so
+// raising the object count keeps the geometries, textures and the first objects the same.
+class StressScene
+{
+public:
+	StressScene();
+
+	// builds the CPU data and creates GPU resources through the current render backend
+	int Generate(const StressSceneConfig& sceneConfig);
+	void Clear();
+
+	const StressSceneConfig& getConfig() const { return config; }
+	const std::vector<StressObject>& GetObjects() const { return objects; }
+
+	Mesh* GetMesh(unsigned int geometry) const { return meshes[geometry]; }
+	Texture* GetTexture(unsigned int texture) const { return textures[texture]; }
+	Material* GetMaterial(unsigned int texture) { return &materials[texture]; }
+	Light* GetLight(unsigned int light) { return &lights[light]; }
+
+	// totals over the unique geometries and over every object instancing them
+	size_t GetUniqueTriangleCount() const;
+	size_t GetInstancedTriangleCount() const;
+
+	~StressScene();
+
+private:
+	StressSceneConfig config;
+
+	std::vector<Mesh*> meshes;
+	std::vector<Texture*> textures;
+	std::vector<Material> materials;
+	std::vector<Light> lights;
+	std::vector<StressObject> objects;
+};
+
+// how a stress run was rendered, written into the report next to the scene config
+struct StressRunInfo
+{
+	const char* backend;
+	bool pipelined;         // simulation on its own thread
+	const char* cameraPath; // nullptr for the scripted turn
+	int width;
+	int height;
+	double generateTime;    // ms to build the scene
+	double drawnObjects;    // per frame averages after culling
+	double fullDetailTriangles; // what the drawn objects would have at LOD 0 without meshlet culling
+	double renderedTriangles;
+	size_t occluders;       // objects rasterized into the occlusion buffer, 0 when occlusion culling is off
+	double occlusionTested; // per frame averages of objects tested against the occluders and found hidden
+	double occlusionOccluded;
+};
+
+// JSON report: scene, run, frame time percentiles and the full telemetry with per frame samples
+int WriteStressReport(const char* fileName, const StressScene& scene, const StressRunInfo& run,
+                      const std::vector<double>& frameTimes, const FrameTelemetry& telemetry);
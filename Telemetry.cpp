@@ -0,0 +1,254 @@
+#include "Telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+
+namespace
+{
+	struct MetricSummary
+	{
+		double mean, p50, p95, p99, max;
+	};
+
+	MetricSummary Summarize(const Histogram& histogram, double scale)
+	{
+		return MetricSummary{ histogram.GetMean() / scale,
+		                      histogram.GetValueAtPercentile(50.0) / scale,
+		                      histogram.GetValueAtPercentile(95.0) / scale,
+		                      histogram.GetValueAtPercentile(99.0) / scale,
+		                      histogram.getMax() / scale };
+	}
+
+	void PrintMetric(const char* name, const Histogram& histogram, double scale, const char* unit)
+	{
+		if (histogram.getCount() == 0)
+		{
+			return;
+		}
+
+		MetricSummary summary = Summarize(histogram, scale);
+		printf("  %-14s mean %10.3f p50 %10.3f p95 %10.3f p99 %10.3f max %10.3f %s\n", name,
+		       summary.mean, summary.p50, summary.p95, summary.p99, summary.max, unit);
+	}
+
+	void WriteMetric(FILE* file, const char* name, const Histogram& histogram, double scale)
+	{
+		MetricSummary summary = Summarize(histogram, scale);
+		fprintf(file, "  \"%s\": { \"count\": %llu, \"mean\": %.6f, \"p50\": %.6f, \"p95\": %.6f, \"p99\": %.6f, \"max\": %.6f },\n",
+		        name, (unsigned long long) histogram.getCount(), summary.mean, summary.p50, summary.p95, summary.p99, summary.max);
+	}
+
+	uint64_t ToNanoseconds(double milliseconds)
+	{
+		return milliseconds > 0.0 ? (uint64_t) (milliseconds * 1e6 + 0.5) : 0;
+	}
+}
+
+FrameTelemetry::FrameTelemetry()
+{
+}
+
+void FrameTelemetry::AddFrame(const FrameSample& sample)
+{
+	samples.push_back(sample);
+
+	cpuTimes.RecordValue(ToNanoseconds(sample.cpuTime));
+	draws.RecordValue(sample.draws);
+	uploadBytes.RecordValue(sample.uploadBytes);
+
+	// no GPU timings or no previous frame yet
+	if (sample.gpuTime > 0.0)
+	{
+		gpuTimes.RecordValue(ToNanoseconds(sample.gpuTime));
+	}
+	if (sample.frameInterval > 0.0)
+	{
+		frameIntervals.RecordValue(ToNanoseconds(sample.frameInterval));
+	}
+	if (sample.simTime > 0.0)
+	{
+		simTimes.RecordValue(ToNanoseconds(sample.simTime));
+	}
+	if (sample.occlusionTime > 0.0)
+	{
+		occlusionTimes.RecordValue(ToNanoseconds(sample.occlusionTime));
+	}
+	if (sample.latency > 0.0)
+	{
+		latencies.RecordValue(ToNanoseconds(sample.latency));
+	}
+	if (sample.photonLatency > 0.0)
+	{
+		photonLatencies.RecordValue(ToNanoseconds(sample.photonLatency));
+	}
+}
+
+void FrameTelemetry::Reserve(size_t frames)
+{
+	samples.reserve(frames);
+}
+
+void FrameTelemetry::Reset()
+{
+	samples.clear();
+	cpuTimes.Reset();
+	gpuTimes.Reset();
+	frameIntervals.Reset();
+	simTimes.Reset();
+	occlusionTimes.Reset();
+	latencies.Reset();
+	photonLatencies.Reset();
+	draws.Reset();
+	uploadBytes.Reset();
+}
+
+double FrameTelemetry::GetIntervalDeviation() const
+{
+	if (frameIntervals.getCount() < 2)
+	{
+		return 0.0;
+	}
+
+	double mean = frameIntervals.GetMean() / NANOSECONDS_PER_MILLISECOND;
+	double squareSum = 0.0;
+	for (const FrameSample& sample : samples)
+	{
+		if (sample.frameInterval > 0.0)
+		{
+			squareSum += (sample.frameInterval - mean) * (sample.frameInterval - mean);
+		}
+	}
+
+	return std::sqrt(squareSum / (frameIntervals.getCount() - 1));
+}
+
+double FrameTelemetry::GetJitter() const
+{
+	double changeSum = 0.0;
+	size_t changes = 0;
+
+	for (size_t i = 1; i < samples.size(); i++)
+	{
+		if (samples[i].frameInterval > 0.0 && samples[i - 1].frameInterval > 0.0)
+		{
+			changeSum += std::fabs(samples[i].frameInterval - samples[i - 1].frameInterval);
+			changes++;
+		}
+	}
+
+	return changes > 0 ? changeSum / changes : 0.0;
+}
+
+void FrameTelemetry::PrintSummary() const
+{
+	if (samples.empty())
+	{
+		printf("No telemetry recorded\n");
+		return;
+	}
+
+	printf("Telemetry over %zu frames:\n", samples.size());
+	PrintMetric("CPU time", cpuTimes, NANOSECONDS_PER_MILLISECOND, "ms");
+	PrintMetric("GPU time", gpuTimes, NANOSECONDS_PER_MILLISECOND, "ms");
+	PrintMetric("Frame interval", frameIntervals, NANOSECONDS_PER_MILLISECOND, "ms");
+	PrintMetric("Sim time", simTimes, NANOSECONDS_PER_MILLISECOND, "ms");
+	PrintMetric("Occlusion", occlusionTimes, NANOSECONDS_PER_MILLISECOND, "ms");
+	PrintMetric("Latency", latencies, NANOSECONDS_PER_MILLISECOND, "ms");
+	PrintMetric("Photon latency", photonLatencies, NANOSECONDS_PER_MILLISECOND, "ms");
+	PrintMetric("Draws", draws, 1.0, "");
+	PrintMetric("Upload", uploadBytes, 1.0, "bytes");
+	printf("  Pacing: interval deviation %.3f ms, jitter %.3f ms\n", GetIntervalDeviation(), GetJitter());
+}
+
+int FrameTelemetry::Export(const char* fileName) const
+{
+	size_t length = strlen(fileName);
+	bool csv = length >= 4 && strcmp(fileName + length - 4, ".csv") == 0;
+
+	int result = csv ? ExportCSV(fileName) : ExportJSON(fileName);
+	if (result == 0)
+	{
+		printf("Telemetry for %zu frames written to %s\n", samples.size(), fileName);
+	}
+	return result;
+}
+
+int FrameTelemetry::ExportCSV(const char* fileName) const
+{
+	FILE* file = fopen(fileName, "w");
+	if (!file)
+	{
+		printf("Failed to open %s for writing\n", fileName);
+		return 1;
+	}
+
+	fprintf(file, "frame,cpu_ms,gpu_ms,interval_ms,sim_ms,occlusion_ms,latency_ms,photon_ms,draws,upload_bytes\n");
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		const FrameSample& sample = samples[i];
+		fprintf(file, "%zu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%zu,%zu\n", i, sample.cpuTime, sample.gpuTime, sample.frameInterval,
+		        sample.simTime, sample.occlusionTime, sample.latency, sample.photonLatency, sample.draws, sample.uploadBytes);
+	}
+
+	fclose(file);
+	return 0;
+}
+
+int FrameTelemetry::ExportJSON(const char* fileName) const
+{
+	FILE* file = fopen(fileName, "w");
+	if (!file)
+	{
+		printf("Failed to open %s for writing\n", fileName);
+		return 1;
+	}
+
+	fprintf(file, "{\n");
+	WriteJSON(file);
+	fprintf(file, "}\n");
+
+	fclose(file);
+	return 0;
+}
+
+void FrameTelemetry::WriteJSON(FILE* file) const
+{
+	fprintf(file, "  \"frames\": %zu,\n", samples.size());
+	WriteMetric(file, "cpu_ms", cpuTimes, NANOSECONDS_PER_MILLISECOND);
+	WriteMetric(file, "gpu_ms", gpuTimes, NANOSECONDS_PER_MILLISECOND);
+	WriteMetric(file, "interval_ms", frameIntervals, NANOSECONDS_PER_MILLISECOND);
+	WriteMetric(file, "sim_ms", simTimes, NANOSECONDS_PER_MILLISECOND);
+	WriteMetric(file, "occlusion_ms", occlusionTimes, NANOSECONDS_PER_MILLISECOND);
+	WriteMetric(file, "latency_ms", latencies, NANOSECONDS_PER_MILLISECOND);
+	WriteMetric(file, "photon_ms", photonLatencies, NANOSECONDS_PER_MILLISECOND);
+	WriteMetric(file, "draws", draws, 1.0);
+	WriteMetric(file, "upload_bytes", uploadBytes, 1.0);
+	fprintf(file, "  \"interval_deviation_ms\": %.6f,\n  \"jitter_ms\": %.6f,\n", GetIntervalDeviation(), GetJitter());
+
+	// raw samples, one array per metric
+	auto writeSamples = [&](const char* name, auto value, bool last) {
+		fprintf(file, "    \"%s\": [", name);
+		for (size_t i = 0; i < samples.size(); i++)
+		{
+			fprintf(file, i > 0 ? ", %.6f" : "%.6f", (double) value(samples[i]));
+		}
+		fprintf(file, last ? "]\n" : "],\n");
+	};
+
+	fprintf(file, "  \"samples\": {\n");
+	writeSamples("cpu_ms", [](const FrameSample& sample) { return sample.cpuTime; }, false);
+	writeSamples("gpu_ms", [](const FrameSample& sample) { return sample.gpuTime; }, false);
+	writeSamples("interval_ms", [](const FrameSample& sample) { return sample.frameInterval; }, false);
+	writeSamples("sim_ms", [](const FrameSample& sample) { return sample.simTime; }, false);
+	writeSamples("occlusion_ms", [](const FrameSample& sample) { return sample.occlusionTime; }, false);
+	writeSamples("latency_ms", [](const FrameSample& sample) { return sample.latency; }, false);
+	writeSamples("photon_ms", [](const FrameSample& sample) { return sample.photonLatency; }, false);
+	writeSamples("draws", [](const FrameSample& sample) { return (double) sample.draws; }, false);
+	writeSamples("upload_bytes", [](const FrameSample& sample) { return (double) sample.uploadBytes; }, true);
+	fprintf(file, "  }\n");
+}
+
+FrameTelemetry::~FrameTelemetry()
+{
+}
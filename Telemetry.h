@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+#include "Histogram.h"
+
+struct FrameSample
+{
+	double cpuTime;      // ms of render thread work, excluding the wait for the GPU or the swap; includes the simulation unless pipelined
+	double gpuTime;      // ms, from GPU timer queries, which resolve a few frames late
+	double frameInterval; // ms since the previous frame started, what the player sees
+	double simTime;      // ms of input, camera and culling work, on its own thread when pipelined
+	double occlusionTime; // ms of simTime spent on occlusion culling
+	double latency;      // ms from sampling the input to the frame being finished or swapped
+	double photonLatency; // ms, estimated input to photon of the newest frame the GPU finished, low latency mode only
+	size_t draws;
+	size_t uploadBytes;  // buffer and texture uploads
+};
+
+// Collects per frame samples into histograms for percentiles and keeps the raw samples for export,
+// so runs of different builds can be compared frame by frame.
+class FrameTelemetry
+{
+public:
+	FrameTelemetry();
+
+	void AddFrame(const FrameSample& sample);
+	void Reserve(size_t frames); // room for the samples of a run of known length
+	void Reset();
+
+	void PrintSummary() const;
+
+	// .csv writes one row per frame, anything else a JSON summary followed by the per frame samples
+	int Export(const char* fileName) const;
+
+	// the JSON export's fields without the enclosing braces, for reports that embed the telemetry
+	void WriteJSON(FILE* file) const;
+
+	size_t getFrameCount() const { return samples.size(); }
+
+	~FrameTelemetry();
+
+private:
+	static constexpr double NANOSECONDS_PER_MILLISECOND = 1e6;
+
+	std::vector<FrameSample> samples;
+
+	// times in nanoseconds
+	Histogram cpuTimes;
+	Histogram gpuTimes;
+	Histogram frameIntervals;
+	Histogram simTimes;
+	Histogram occlusionTimes;
+	Histogram latencies;
+	Histogram photonLatencies;
+	Histogram draws;
+	Histogram uploadBytes;
+
+	// frame pacing: spread of the interval and how much it changes from one frame to the next, in ms
+	double GetIntervalDeviation() const;
+	double GetJitter() const;
+
+	int ExportCSV(const char* fileName) const;
+	int ExportJSON(const char* fileName) const;
+};
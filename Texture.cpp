@@ -1,5 +1,7 @@
 #include "Texture.h"
 
+#include "RenderBackend.h"
+
 Texture::Texture() : textureID(0), width(0), height(0), bitDepth(0), fileLocation(nullptr)
 {
 }
@@ -22,53 +24,35 @@ void Texture::LoadTexture()
 		printf("Failed to find: %s\n", fileLocation);
 	}
 
-	// Generate & bind textures
-	const GLint textureIndex = 0;
-	
-	const GLint numTextures = 1;
-	const GLenum textureType = GL_TEXTURE_2D;
-	const GLint mipMapLevel = 0;
-	const GLenum internalFormat = GL_RGBA;
-	const GLint border = 0;
-	const GLenum format = GL_RGBA;
-	const GLenum type = GL_UNSIGNED_BYTE;
-
-	glGenTextures(numTextures, &textureID);
-	glBindTexture(textureType, textureID);
-	
-	GLint edgeHandling = GL_MIRRORED_REPEAT;
-	GLenum filterType = GL_NEAREST;
-
-	// s and t axis wrap behavior
-	glTexParameteri(textureType, GL_TEXTURE_WRAP_S, edgeHandling);
-	glTexParameteri(textureType, GL_TEXTURE_WRAP_T, edgeHandling);
+	// Generate & upload texture
+	textureID = GetRenderBackend().CreateTexture(width, height, texData);
 
-	glTexParameteri(textureType, GL_TEXTURE_MIN_FILTER, filterType);
-	glTexParameteri(textureType, GL_TEXTURE_MAG_FILTER, filterType);
-
-	glTexImage2D(textureType, mipMapLevel, internalFormat, width, height, border, format, type, texData);
-
-	glGenerateMipmap(textureType);
+	stbi_image_free(texData);
+}
 
-	glBindTexture(textureType, textureIndex);
+void Texture::LoadTexture(int texWidth, int texHeight, const unsigned char* rgba)
+{
+	width = texWidth;
+	height = texHeight;
+	bitDepth = 4;
 
-	stbi_image_free(texData);
+	textureID = GetRenderBackend().CreateTexture(width, height, rgba);
 }
 
 void Texture::UseTexture()
 {
-	GLenum textureUnit = GL_TEXTURE0;
-	GLenum textureType = GL_TEXTURE_2D;
+	const unsigned int textureUnit = 0;
 
-	glActiveTexture(textureUnit); // sampler accesses texture through texture unit
-	glBindTexture(textureType, textureID);
+	GetRenderBackend().BindTexture(textureID, textureUnit); // sampler accesses texture through texture unit
 }
 
 void Texture::ClearTexture()
 {
-	const GLint numTextures = 1;
+	if (textureID != 0)
+	{
+		GetRenderBackend().DestroyTexture(textureID);
+	}
 
-	glDeleteTextures(numTextures, &textureID);
 	textureID = 0;
 	width = 0;
 	height = 0;
@@ -12,6 +12,7 @@ public:
 	Texture(const char* fileLoc);
 
 	void LoadTexture();
+	void LoadTexture(int texWidth, int texHeight, const unsigned char* rgba); // pixels generated in memory
 	void UseTexture();
 	void ClearTexture();
 
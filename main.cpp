@@ -2,8 +2,13 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <algorithm>
 #include <cmath>
+#include <chrono>
 #include <vector>
+#include <thread>
+#include <mutex>
 
 #include <cctype>
 
@@ -18,10 +23,6 @@
 #include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <Windows.h>
-#include <Xinput.h>
-#pragma comment(lib, "XInput.lib") 
-
 #include "GLWindow.h"
 #include "Mesh.h"
 #include "Shader.h"
@@ -29,67 +30,98 @@
 #include "Texture.h"
 #include "Light.h"
 #include "Material.h"
+#include "FrustumCuller.h"
+#include "BVH.h"
+#include "OcclusionCuller.h"
+#include "Benchmark.h"
+#include "Gamepad.h"
+#include "HeadlessContext.h"
+#include "OffscreenTarget.h"
+#include "ImageWriter.h"
+#include "SoftwareRasterizer.h"
+#include "RenderBackend.h"
+#include "NullRenderBackend.h"
+#include "GLInterceptor.h"
+#include "GLTraceReplayer.h"
+#include "Profiler.h"
+#include "GPUProfiler.h"
+#include "Telemetry.h"
+#include "CameraPath.h"
+#include "StressScene.h"
+#include "BenchmarkCompare.h"
+#include "KernelBenchmarks.h"
+#include "JobSystem.h"
+#include "FramePacket.h"
+#include "CommandBuffer.h"
+#include "FramePacer.h"
+#include "LateLatch.h"
+#include "FrameArena.h"
+#include "AllocationTracker.h"
 
 std::vector<Mesh*> meshList;
 std::vector<Shader*> shaderList;
 
+struct SceneObject
+{
+	Mesh* mesh;
+	Texture* texture;
+	Material* material;
+	Light* light;
+	glm::mat4 model;
+	unsigned int lod; // kept between frames so LOD selection can apply hysteresis
+	bool occluder;    // rasterized into the occlusion buffer
+};
+
 constexpr int POSITION_COMPONENTS = 4;
 constexpr int TRIANGLE_VERTEX_COUNT = 3;
 constexpr int NUM_UV_COMPONENTS = 2;
 constexpr int NUM_NORMAL_COMPONENTS = 3;
 constexpr bool verbose = false;
+constexpr unsigned int MAX_LOD_LEVELS = 4;
 
-// Vertex Shader
-static const char* vShader = "Shaders/shader.vert";
+// occluders are rasterized on the CPU every frame, at a coarse LOD
+constexpr unsigned int OCCLUDER_LOD = 2;
 
-static const char* fShader = "Shaders/shader.frag";
+// draws are recorded on the job threads in up to this many chunks per thread, none smaller than the minimum
+constexpr size_t RECORD_CHUNKS_PER_THREAD = 4;
+constexpr size_t MIN_DRAWS_PER_CHUNK = 16;
+constexpr size_t MAX_COMMANDS_PER_DRAW = 9; // light, model, texture, material and the draw itself
 
-void calcAverageNormals(unsigned int* indices, unsigned int indiceCount, float* vertices, unsigned int verticeCount, 
-	                    unsigned int vertexLength, unsigned int normalOffset)
-{
-	// obtain normal vectors
-	for (size_t i = 0; i < indiceCount; i += TRIANGLE_VERTEX_COUNT)
-	{
-		unsigned int in0 = indices[i] * vertexLength;
-		unsigned int in1 = indices[i + 1] * vertexLength;
-		unsigned int in2 = indices[i + 2] * vertexLength;
+const float fovY = glm::radians(60.0f);  // FOV in Y direction
+const float zNear = 0.1f;  // Near clipping plane
+const float zFar = 100.0f; // Far clipping plane
 
-		glm::vec3 v1(vertices[in1] - vertices[in0], vertices[in1 + 1] - vertices[in0 + 1], vertices[in1 + 2] - vertices[in0 + 2]);
-		glm::vec3 v2(vertices[in2] - vertices[in0], vertices[in2 + 1] - vertices[in0 + 1], vertices[in2 + 2] - vertices[in0 + 2]);
-		glm::vec3 normal = glm::cross(v1, v2);
-		normal = glm::normalize(normal);
+// headless runs use a fixed step and a scripted camera turn so every run renders the same frames,
+// played back camera paths are sampled at the same step
+const GLfloat HEADLESS_FRAME_TIME = 1.0f / 60.0f;
+const GLfloat HEADLESS_TURN_PER_FRAME = 0.05f;
 
-		in0 += normalOffset;
-		in1 += normalOffset;
-		in2 += normalOffset;
+// gamepad readings per second, independent of the frame rate
+const double GAMEPAD_POLL_RATE = 250.0;
 
-		vertices[in0]     += normal.x;
-		vertices[in0 + 1] += normal.y;
-		vertices[in0 + 2] += normal.z;
+// interactive movement steps per frame at most, a longer stall drops the time instead of catching up
+const GLfloat MAX_STEPS_PER_FRAME = 8.0f;
 
-		vertices[in1]     += normal.x;
-		vertices[in1 + 1] += normal.y;
-		vertices[in1 + 2] += normal.z;
+// scene shared by the GL and software renderers
+// TODO: put in mesh or object holding mesh for proper OOP
+static const char* bricksFilename = "textures/brick.png";
+static const char* dirtFilename = "textures/dirt.png";
 
-		vertices[in2]     += normal.x;
-		vertices[in2 + 1] += normal.y;
-		vertices[in2 + 2] += normal.z;
-	}
+Material shinyMaterial{ 1.0f, 32 };
+Material dullMaterial{ 0.3f, 4 };
 
-	// per row normalized normal vectors
-	for (size_t i = 0; i < verticeCount / vertexLength; i++)
-	{
-		unsigned int normalOffsetPerVertex = i * vertexLength + normalOffset;
-		glm::vec3 vec(vertices[normalOffsetPerVertex], vertices[normalOffsetPerVertex + 1], vertices[normalOffsetPerVertex + 2]);
-		vec = glm::normalize(vec);
+const glm::mat4 objectModels[] = {
+	glm::translate(glm::mat4{ 1.0f }, glm::vec3{ 0.0f, 0.0f, -2.5f }),
+	glm::translate(glm::mat4{ 1.0f }, glm::vec3{ 0.0f, 4.0f, -2.5f })
+};
 
-		vertices[normalOffsetPerVertex]     = vec.x;
-		vertices[normalOffsetPerVertex + 1] = vec.y;
-		vertices[normalOffsetPerVertex + 2] = vec.z;
-	}
-}
+// Vertex Shader
+static const char* vShader = "Shaders/Shader.vert";
 
-void CreateObjects()
+static const char* fShader = "Shaders/Shader.frag";
+
+// interleaved XYZ UV normal vertices and indices of the tetrahedron every scene object uses
+void CreateTetrahedron(std::vector<GLfloat>& vertexData, std::vector<unsigned int>& indexData)
 {
 	const int indiceCount = TRIANGLE_VERTEX_COUNT * POSITION_COMPONENTS;
 	const int verticeCount = POSITION_COMPONENTS * (TRIANGLE_VERTEX_COUNT + NUM_UV_COMPONENTS + NUM_NORMAL_COMPONENTS);
@@ -113,128 +145,486 @@ void CreateObjects()
 	const int normalOffset = TRIANGLE_VERTEX_COUNT + NUM_UV_COMPONENTS;
 	calcAverageNormals(indices, indiceCount, vertices, verticeCount, numVerticeColumns, normalOffset);
 
+	vertexData.assign(vertices, vertices + verticeCount);
+	indexData.assign(indices, indices + indiceCount);
+}
+
+void CreateObjects()
+{
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+	CreateTetrahedron(vertices, indices);
+
 	Mesh* obj1 = new Mesh{ };
-	const int numOfVertices = sizeof(vertices) / sizeof(vertices[0]);
-	const int numOfIndices = sizeof(indices) / sizeof(indices[0]);
-	obj1->CreateMesh(vertices, indices, numOfVertices, numOfIndices);
+	const unsigned int numOfVertices = (unsigned int) vertices.size();
+	const unsigned int numOfIndices = (unsigned int) indices.size();
+	obj1->CreateMesh(vertices.data(), indices.data(), numOfVertices, numOfIndices);
 	meshList.push_back(obj1);
 
 	Mesh* obj2 = new Mesh{ };
-	obj2->CreateMesh(vertices, indices, numOfVertices, numOfIndices);
+	obj2->CreateMesh(vertices.data(), indices.data(), numOfVertices, numOfIndices);
 	meshList.push_back(obj2);
+
+	for (Mesh* mesh : meshList)
+	{
+		mesh->BuildMeshlets();
+		mesh->GenerateLODs(MAX_LOD_LEVELS);
+	}
 }
 
-void CreateShaders()
+void CreateShaders(const char* vertexDefines)
 {
 	Shader* shader1 = new Shader();
-	shader1->CreateFromFiles(vShader, fShader);
+	shader1->CreateFromFiles(vShader, fShader, vertexDefines);
 	shaderList.push_back(shader1);
 }
 
-char getInputDeviceTypeConnected()
+Camera CreateCamera()
 {
-	const int controllerIndex = 0;
-	const int dwFlags = 0;
-	XINPUT_CAPABILITIES pCapabilities;
-
-	// Autodetect if XInput device connected
-	if (XInputGetCapabilities(controllerIndex, dwFlags, &pCapabilities) == ERROR_SUCCESS)
-	{
-		if (verbose)
-		{
-			printf("XInput Device Autodetected");
-		}
-
-		return 'x';
-	}
-
-	return 'k';
+	glm::vec3 startPosition = glm::vec3{ 0.0f, 0.0f, 0.0f };
+	glm::vec3 startUp = glm::vec3{ 0.0f, 1.0f, 0.0f };
+	GLfloat startYaw = -90.0f;
+	GLfloat startPitch = 0.0f;
+	GLfloat movementSpeed = 10.0f;
+	GLfloat cameraSensitivity = 20.0f;
+	return Camera{ startPosition, startUp, startYaw, startPitch, movementSpeed, cameraSensitivity };
 }
 
+Light CreateMainLight()
+{
+	GLfloat redChannel = 1.0f;
+	GLfloat blueChannel = 1.0f;
+	GLfloat greenChannel = 1.0f;
+	GLfloat ambientIntensity = 0.2f;
+	GLfloat xDirection =  2.0f;   // + right
+	GLfloat yDirection = -1.0f;   // + up
+	GLfloat zDirection = -2.0f;   // + to camera/viewer
+	GLfloat diffuseIntensity = 0.1f;
+	return Light{ redChannel, greenChannel, blueChannel, ambientIntensity,
+	              xDirection, yDirection, zDirection, diffuseIntensity };
+}
 
-inline bool isButtonPressed(const XINPUT_STATE& state, WORD button)
+void DumpFrame(const char* directory, int frameIndex, int width, int height, const std::vector<unsigned char>& pixels)
 {
-	return (state.Gamepad.wButtons & button) != 0;
+	char framePath[512];
+	snprintf(framePath, sizeof(framePath), "%s/frame_%04d.png", directory, frameIndex);
+	WritePNG(framePath, width, height, pixels.data(), true);
 }
 
-void ProcessXInput(Camera& camera, float deltaTime)
+// renders the scene with the CPU rasterizer, no GL context or GPU needed
+int RunSoftwareRenderer(int frameCount, int width, int height, const char* dumpDirectory, const CameraPathPlayer* cameraPath)
 {
-	XINPUT_STATE state;
-	ZeroMemory(&state, sizeof(XINPUT_STATE));
+	std::vector<GLfloat> vertices;
+	std::vector<unsigned int> indices;
+	CreateTetrahedron(vertices, indices);
+	const unsigned int vertexLength = TRIANGLE_VERTEX_COUNT + NUM_UV_COMPONENTS + NUM_NORMAL_COMPONENTS;
 
-	if (XInputGetState(0, &state) == ERROR_SUCCESS)
+	SoftwareRasterizer rasterizer;
+	if (rasterizer.Initialize(width, height) != 0)
 	{
-		const float STICK_DEADZONE = 0.2f;
-		const float TRIGGER_DEADZONE = 0.2f;
+		return 1;
+	}
 
-		// Left stick values normalized
-		float LX = state.Gamepad.sThumbLX / 32767.0f;
-		float LY = state.Gamepad.sThumbLY / 32767.0f;
-		// Right stick values normalized
-		float RX = state.Gamepad.sThumbRX / 32767.0f;
-		float RY = state.Gamepad.sThumbRY / 32767.0f;
+	int brickTexture = rasterizer.LoadTexture(bricksFilename);
+	int dirtTexture = rasterizer.LoadTexture(dirtFilename);
 
-		// Deadzone
-		if (fabs(LX) < STICK_DEADZONE) { LX = 0.0f; }
-		if (fabs(LY) < STICK_DEADZONE) { LY = 0.0f; }
-		if (fabs(RX) < STICK_DEADZONE) { RX = 0.0f; }
-		if (fabs(RY) < STICK_DEADZONE) { RY = 0.0f; }
+	Camera camera = CreateCamera();
+	Light mainLight = CreateMainLight();
+	glm::mat4 projection = glm::perspective(fovY, (GLfloat)width / (GLfloat)height, zNear, zFar);
 
-		// Move position (left stick)
-		glm::vec3 move{ 0.0f };
-		move += camera.getFront() * LY;   // Forward/back
-		move += camera.getRight() * LX;   // Left/right
+	std::vector<double> frameTimes;
+	std::vector<unsigned char> framePixels;
+	frameTimes.reserve(frameCount);
 
-		// Up/down using triggers
-		float triggerUp = state.Gamepad.bRightTrigger / 255.0f;
-		float triggerDown = state.Gamepad.bLeftTrigger / 255.0f;
+	for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+	{
+		auto frameStart = std::chrono::steady_clock::now();
 
-		if (triggerUp < TRIGGER_DEADZONE) { triggerUp = 0; }
-		if (triggerDown < TRIGGER_DEADZONE) { triggerDown = 0; }
+		if (cameraPath)
+		{
+			cameraPath->ApplyStep(frameIndex, HEADLESS_FRAME_TIME, camera);
+		}
+		else
+		{
+			camera.mouseControl(HEADLESS_TURN_PER_FRAME, 0.0f);
+		}
 
-		if (triggerUp || triggerDown)
 		{
-			move += camera.getUp() * (triggerUp - triggerDown);
+			PROFILE_SCOPE("Software frame");
+			rasterizer.BeginFrame(camera.calculateViewMatrix(), projection, camera.getCameraPosition(), mainLight, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+			rasterizer.DrawTriangles(vertices.data(), vertexLength, indices.data(), (unsigned int) indices.size(), objectModels[0], brickTexture, shinyMaterial);
+			rasterizer.DrawTriangles(vertices.data(), vertexLength, indices.data(), (unsigned int) indices.size(), objectModels[1], dirtTexture, dullMaterial);
+			rasterizer.EndFrame();
 		}
 
-		bool A = (state.Gamepad.wButtons & XINPUT_GAMEPAD_A);
+		frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
 
-		bool B = (state.Gamepad.wButtons & XINPUT_GAMEPAD_B);
+		if (dumpDirectory)
+		{
+			rasterizer.ReadPixels(framePixels);
+			DumpFrame(dumpDirectory, frameIndex, width, height, framePixels);
+		}
+
+		PROFILE_FRAME_END();
+	}
 
-		// XINPUT_GAMEPAD_A
-		if (isButtonPressed(state, XINPUT_GAMEPAD_A))
+	PrintFrameTimes(frameTimes);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	constexpr size_t CULLING_BENCHMARK_OBJECTS = 1000000;
+	constexpr size_t BVH_BENCHMARK_OBJECTS = 1000000;
+	constexpr size_t OCCLUSION_BENCHMARK_OBJECTS = 100000;
+
+	// headless mode renders a fixed number of frames into an offscreen target and reports frame times
+	bool headless = false;
+	bool software = false;
+	bool nullBackend = false;
+	int headlessFrames = 600;
+	GLint headlessWidth = 1280;
+	GLint headlessHeight = 720;
+	const char* dumpDirectory = nullptr;
+
+	// GL call statistics and trace capture through the interceptor
+	bool glStats = false;
+	const char* traceFile = nullptr;
+	const char* replayFile = nullptr;
+
+	// CPU profile of a frame range as Chrome trace JSON
+	const char* profileFile = nullptr;
+	size_t profileFirstFrame = 60;
+	size_t profileFrameCount = 60;
+	bool gpuTimes = false;
+
+	// per frame CPU/GPU time, draws and uploads, written on exit or with F12
+	const char* telemetryFile = nullptr;
+
+	// camera paths make runs of different builds render the same views
+	const char* recordPathFile = nullptr;
+	const char* playPathFile = nullptr;
+
+	// procedurally generated scene instead of the two tetrahedra, rendered headless into a JSON report
+	bool stress = false;
+	StressSceneConfig stressConfig{ 1000, 16, 8, 4, 1, 32 };
+	const char* stressReportFile = "stress_report.json";
+
+	// statistical comparison of two sets of result files, no rendering
+	const char* compareBaseline = nullptr;
+	const char* compareCandidate = nullptr;
+	double compareThreshold = 2.0;
+
+	// CPU kernel microbenchmarks, no rendering
+	bool microbench = false;
+	const char* microbenchFilter = nullptr;
+	const char* microbenchFile = nullptr;
+	int microbenchRepetitions = 1;
+
+	// worker threads besides the main thread, -1 for one per remaining hardware thread
+	int jobWorkers = -1;
+
+	// simulation on its own thread, one frame ahead of the thread that owns the GL context
+	bool pipelined = false;
+
+	// frame pacing: swap interval (-2 leaves the driver default), frame rate cap and fixed movement rate
+	int swapInterval = -2;
+	double fpsLimit = 0.0;
+	GLfloat simulationRate = 120.0f;
+
+	// low latency mode: frames the GPU may lag behind (0 off), the view is latched right before submission
+	unsigned int lowLatencyFrames = 0;
+
+	// scripted gamepad instead of GLFW's, for the gamepad path without hardware
+	bool mockGamepadInput = false;
+
+	// headless frames after the warm-up must not allocate on any thread (-1 off), optionally with the offenders' stacks
+	int allocationCheckWarmup = -1;
+	bool allocationStacks = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--benchmark") == 0)
 		{
-			if (verbose)
+			RunCullingBenchmark(CULLING_BENCHMARK_OBJECTS);
+			RunBVHBenchmark(BVH_BENCHMARK_OBJECTS);
+			RunOcclusionBenchmark(OCCLUSION_BENCHMARK_OBJECTS);
+			return 0;
+		}
+		else if (strcmp(argv[i], "--headless") == 0)
+		{
+			headless = true;
+		}
+		else if (strcmp(argv[i], "--software") == 0)
+		{
+			// the CPU rasterizer always runs headless
+			headless = true;
+			software = true;
+		}
+		else if (strcmp(argv[i], "--null-backend") == 0)
+		{
+			// measures the engine's CPU cost per frame, nothing reaches a GPU
+			headless = true;
+			nullBackend = true;
+		}
+		else if (strcmp(argv[i], "--gl-stats") == 0)
+		{
+			glStats = true;
+		}
+		else if (strcmp(argv[i], "--gl-trace") == 0 && i + 1 < argc)
+		{
+			traceFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+		{
+			replayFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+		{
+			profileFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc)
+		{
+			telemetryFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--record-path") == 0 && i + 1 < argc)
+		{
+			recordPathFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--play-path") == 0 && i + 1 < argc)
+		{
+			playPathFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--stress") == 0 && i + 1 < argc)
+		{
+			// OBJECTS,GEOMETRIES,TEXTURES,LIGHTS[,SEED[,OCCLUDERS]], 0 occluders turns occlusion culling off
+			int fields = sscanf(argv[++i], "%u,%u,%u,%u,%u,%u", &stressConfig.objects, &stressConfig.geometries,
+			                    &stressConfig.textures, &stressConfig.lights, &stressConfig.seed, &stressConfig.occluders);
+			if (fields < 4)
 			{
-				printf("A is being pressed");
+				printf("--stress expects OBJECTS,GEOMETRIES,TEXTURES,LIGHTS[,SEED[,OCCLUDERS]]\n");
+				return 1;
 			}
-			move += camera.getUp();
+			headless = true;
+			stress = true;
+		}
+		else if (strcmp(argv[i], "--stress-report") == 0 && i + 1 < argc)
+		{
+			stressReportFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--vsync") == 0 && i + 1 < argc)
+		{
+			const char* mode = argv[++i];
+			swapInterval = strcmp(mode, "off") == 0 ? 0 : strcmp(mode, "adaptive") == 0 ? -1 : 1;
+		}
+		else if (strcmp(argv[i], "--fps-limit") == 0 && i + 1 < argc)
+		{
+			fpsLimit = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--sim-rate") == 0 && i + 1 < argc)
+		{
+			simulationRate = std::max(1.0f, (GLfloat) atof(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--low-latency") == 0 && i + 1 < argc)
+		{
+			lowLatencyFrames = (unsigned int) std::max(1, std::min(atoi(argv[++i]), (int) LateLatch::MAX_FRAMES_IN_FLIGHT));
+		}
+		else if (strcmp(argv[i], "--mock-gamepad") == 0)
+		{
+			mockGamepadInput = true;
+		}
+		else if (strcmp(argv[i], "--alloc-check") == 0 && i + 1 < argc)
+		{
+			allocationCheckWarmup = std::max(0, atoi(argv[++i]));
+			headless = true;
+		}
+		else if (strcmp(argv[i], "--alloc-stacks") == 0)
+		{
+			allocationStacks = true;
+		}
+		else if (strcmp(argv[i], "--pipelined") == 0)
+		{
+			pipelined = true;
+		}
+		else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+		{
+			jobWorkers = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--microbench") == 0)
+		{
+			microbench = true;
+		}
+		else if (strcmp(argv[i], "--microbench-filter") == 0 && i + 1 < argc)
+		{
+			microbenchFilter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--microbench-out") == 0 && i + 1 < argc)
+		{
+			microbenchFile = argv[++i];
+		}
+		else if (strcmp(argv[i], "--microbench-repetitions") == 0 && i + 1 < argc)
+		{
+			microbenchRepetitions = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc)
+		{
+			compareBaseline = argv[++i];
+			compareCandidate = argv[++i];
+		}
+		else if (strcmp(argv[i], "--compare-threshold") == 0 && i + 1 < argc)
+		{
+			compareThreshold = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--gpu-times") == 0)
+		{
+			gpuTimes = true;
+		}
+		else if (strcmp(argv[i], "--profile-first") == 0 && i + 1 < argc)
+		{
+			profileFirstFrame = (size_t) atoi(argv[++i]);
 		}
+		else if (strcmp(argv[i], "--profile-frames") == 0 && i + 1 < argc)
+		{
+			profileFrameCount = (size_t) atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			headlessFrames = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc)
+		{
+			headlessWidth = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc)
+		{
+			headlessHeight = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--dump-frames") == 0 && i + 1 < argc)
+		{
+			dumpDirectory = argv[++i];
+		}
+		else
+		{
+			printf("Unknown argument: %s\n", argv[i]);
+			printf("Usage: %s [--benchmark] [--headless | --software | --null-backend [--frames N] [--width W] [--height H] [--dump-frames DIR]] [--gl-stats] [--gl-trace FILE] [--replay FILE]\n", argv[0]);
+			printf("       [--profile FILE [--profile-first N] [--profile-frames N]] [--gpu-times] [--telemetry FILE.csv|FILE.json]\n");
+			printf("       [--record-path FILE | --play-path FILE] [--stress OBJECTS,GEOMETRIES,TEXTURES,LIGHTS[,SEED[,OCCLUDERS]] [--stress-report FILE]]\n");
+			printf("       [--compare BASELINE[,BASELINE...] CANDIDATE[,CANDIDATE...] [--compare-threshold PERCENT]]\n");
+			printf("       [--jobs WORKERS] [--pipelined] [--vsync off|on|adaptive] [--fps-limit FPS] [--sim-rate HZ] [--low-latency FRAMES] [--mock-gamepad]\n");
+			printf("       [--alloc-check WARMUP_FRAMES [--alloc-stacks]]\n");
+			printf("       [--microbench [--microbench-filter REGEX] [--microbench-out FILE.json] [--microbench-repetitions N]]\n");
+			return 1;
+		}
+	}
+
+	if (headless && (headlessFrames <= 0 || headlessWidth <= 0 || headlessHeight <= 0))
+	{
+		printf("Headless frame count and size must be positive\n");
+		return 1;
+	}
 
-		if (isButtonPressed(state, XINPUT_GAMEPAD_B))
+	if (allocationCheckWarmup >= 0)
+	{
+		if (!IsAllocationTrackingEnabled())
 		{
-			if (verbose)
-			{
-				printf("B is being pressed");
-			}
-			move -= camera.getUp();
+			printf("--alloc-check needs a build with ENABLE_ALLOCATION_TRACKING\n");
+			return 1;
 		}
-		
-		// Check magnitude threshold to avoid drift
-		if (glm::length(move) > 0.001f)
+		if (allocationCheckWarmup >= headlessFrames)
 		{
-			camera.addPosition(move * deltaTime * camera.getMovementSpeed());
+			printf("--alloc-check leaves no frames to check after %d warm-up frames\n", allocationCheckWarmup);
+			return 1;
 		}
+	}
 
-		// Change looking direction (right stick)
-		camera.mouseControl(RX * camera.getTurnSpeed() * deltaTime, RY * camera.getTurnSpeed() * deltaTime);
+	if (microbench)
+	{
+		return RunKernelBenchmarks(microbenchFilter, microbenchFile, microbenchRepetitions);
 	}
-}
 
-int main()
-{
-	// Choose input device
-	char inputDevice = getInputDeviceTypeConnected();
+	if (compareBaseline)
+	{
+		return RunBenchmarkComparison(compareBaseline, compareCandidate, compareThreshold);
+	}
+
+	if (jobWorkers < 0)
+	{
+		jobWorkers = (int) std::max(1u, std::thread::hardware_concurrency()) - 1;
+	}
+	JobSystemInitialize((unsigned int) jobWorkers);
+	atexit(JobSystemShutdown); // workers have to be joined on every way out of main
+
+	if (stress && software)
+	{
+		printf("--stress needs the GL or null backend\n");
+		return 1;
+	}
+
+	if (allocationCheckWarmup >= 0 && software)
+	{
+		printf("--alloc-check needs the GL or null backend\n");
+		return 1;
+	}
+
+	if (pipelined && software)
+	{
+		printf("--pipelined needs the GL or null backend\n");
+		return 1;
+	}
+
+	if (lowLatencyFrames > 0 && (software || nullBackend))
+	{
+		printf("--low-latency needs the GL backend\n");
+		return 1;
+	}
+
+	// the report is built from the telemetry samples
+	const bool collectTelemetry = telemetryFile || stress;
+
+	PROFILE_THREAD_NAME("Main");
+	if (profileFile && !ProfilerStartCapture(profileFirstFrame, profileFrameCount, profileFile))
+	{
+		return 1;
+	}
+
+	if (replayFile)
+	{
+		GLTraceReplayer replayer;
+		if (replayer.Load(replayFile) != 0)
+		{
+			return 1;
+		}
+		return replayer.Replay(dumpDirectory);
+	}
+
+	// a played back path decides how many frames are rendered
+	CameraPathPlayer cameraPath;
+	if (playPathFile)
+	{
+		if (cameraPath.Load(playPathFile) != 0)
+		{
+			return 1;
+		}
+		headlessFrames = (int) cameraPath.GetStepCount(HEADLESS_FRAME_TIME);
+	}
+
+	CameraPathRecorder pathRecorder;
+	if (recordPathFile && pathRecorder.Start(recordPathFile) != 0)
+	{
+		return 1;
+	}
+
+	if (software)
+	{
+		int result = RunSoftwareRenderer(headlessFrames, headlessWidth, headlessHeight, dumpDirectory, playPathFile ? &cameraPath : nullptr);
+		ProfilerFinishCapture();
+		return result;
+	}
+
+	// a connected gamepad drives the camera instead of keyboard and mouse, checked every frame
+	GLFWGamepadDevice glfwGamepad;
+	MockGamepadDevice mockGamepad;
+	GamepadPoller gamepadPoller;
 
 	// Window dimensions
 	const GLint WIDTH = 1368;
@@ -245,53 +635,115 @@ int main()
 
 	float currSize = 0.4f;
 
-	GLWindow mainWindow = GLWindow{ WIDTH, HEIGHT };
+	GLWindow mainWindow{ WIDTH, HEIGHT }; // owns the input queue, so it stays where it is made
+	HeadlessContext headlessContext;
+	OffscreenTarget offscreenTarget;
+	NullRenderBackend nullRenderBackend;
+	GLint bufferWidth = 0;
+	GLint bufferHeight = 0;
+
+	if (nullBackend)
+	{
+		// no context at all, every engine call is validated and dropped
+		SetRenderBackend(&nullRenderBackend);
+		bufferWidth = headlessWidth;
+		bufferHeight = headlessHeight;
+		dumpDirectory = nullptr;
+	}
+	else if (headless)
+	{
+		if (headlessContext.Initialize() != 0 || offscreenTarget.Create(headlessWidth, headlessHeight) != 0)
+		{
+			return 1;
+		}
+
+		offscreenTarget.Bind();
+		bufferWidth = offscreenTarget.getWidth();
+		bufferHeight = offscreenTarget.getHeight();
+	}
+	else
+	{
+		mainWindow.Initialize();
+		bufferWidth = mainWindow.getBufferWidth();
+		bufferHeight = mainWindow.getBufferHeight();
+
+		if (swapInterval != -2)
+		{
+			swapInterval = mainWindow.setSwapInterval(swapInterval);
+		}
+	}
+
+	// the mock pad drives headless runs too, GLFW's needs a window
+	if (mockGamepadInput)
+	{
+		// walks forward in a slow left turn
+		GamepadState state{};
+		state.connected = true;
+		state.leftY = 0.5f;
+		state.rightX = -0.3f;
+		mockGamepad.SetState(state);
+	}
+	if (mockGamepadInput || !headless)
+	{
+		gamepadPoller.Start(mockGamepadInput ? static_cast<GamepadDevice*>(&mockGamepad) : &glfwGamepad, GAMEPAD_POLL_RATE);
+	}
 
-	mainWindow.Initialize();
+	FramePacer framePacer;
+	framePacer.SetTargetRate(fpsLimit);
 
-	const float fovY = glm::radians(60.0f);  // FOV in Y direction
-	const GLfloat aspectRatio = (GLfloat)mainWindow.getBufferWidth() / (GLfloat)mainWindow.getBufferHeight();// width / height
-	const float zNear = 0.1f;  // Near clipping plane
-	const float zFar = 100.0f; // Far clipping plane
+	// hooks go in before any resource is created so the trace can rebuild the whole scene
+	if (!nullBackend && (glStats || traceFile || collectTelemetry))
+	{
+		InstallGLInterceptor();
+		if (traceFile && !StartGLTrace(traceFile))
+		{
+			return 1;
+		}
+	}
+
+	// GPU scopes land on the profile's timeline, a driver without timer queries only loses them
+	if (!nullBackend && (gpuTimes || profileFile || collectTelemetry))
+	{
+		GPUProfilerInitialize();
+	}
+
+	const GLfloat aspectRatio = (GLfloat)bufferWidth / (GLfloat)bufferHeight;// width / height
 
 	const float xLoc = 0.0f;
 	const float yLoc = 0.0f;
 	const float zLoc = -2.5f;
 
-	CreateObjects(); // Create triangle
-	CreateShaders(); // Compile and link shaders
+	CreateShaders(lowLatencyFrames > 0 ? "#define LATE_LATCH_VIEW\n" : nullptr); // Compile and link shaders
 
-	glm::vec3 startPosition = glm::vec3{ 0.0f, 0.0f, 0.0f };
-	glm::vec3 startUp = glm::vec3{ 0.0f, 1.0f, 0.0f };
-	GLfloat startYaw = -90.0f;
-	GLfloat startPitch = 0.0f;
-	GLfloat movementSpeed = 10.0f;
-	GLfloat cameraSensitivity = 20.0f;
-	Camera camera = Camera{ startPosition, startUp, startYaw, startPitch, movementSpeed, cameraSensitivity };
+	LateLatch lateLatch;
+	if (lowLatencyFrames > 0)
+	{
+		// after the GPU is done a frame still waits for its refresh (half of one on average without vsync, where it
+		// tears in) and reaches the middle of the screen half a refresh into scanning out; offscreen it is done right away
+		double displayDelay = 0.0;
+		if (!headless)
+		{
+			double refreshPeriod = 1000.0 / std::max(mainWindow.getRefreshRate(), 1);
+			displayDelay = swapInterval == 0 ? refreshPeriod * 0.5 : refreshPeriod;
+		}
 
-	// TODO: put in mesh or object holding mesh for proper OOP
-	std::string bricksFilename = "textures/brick.png";
-	std::string dirtFilename = "textures/dirt.png";
+		if (lateLatch.Initialize(lowLatencyFrames, shaderList[0]->GetProgramID(), displayDelay) != 0)
+		{
+			return 1;
+		}
+	}
+
+	Camera camera = CreateCamera();
+	const glm::vec3 startPosition = camera.getCameraPosition();
+	const GLfloat startYaw = camera.getYaw();
 
-	Texture brickTexture = Texture{ bricksFilename.c_str() };
-	Texture dirtTexture = Texture{ dirtFilename.c_str() };
+	Texture brickTexture = Texture{ bricksFilename };
+	Texture dirtTexture = Texture{ dirtFilename };
 
 	brickTexture.LoadTexture();
 	dirtTexture.LoadTexture();
 
-	Material shinyMaterial{ 1.0f, 32 };
-	Material dullMaterial{ 0.3f, 4 };
-
-	GLfloat redChannel = 1.0f;
-	GLfloat blueChannel = 1.0f;
-	GLfloat greenChannel = 1.0f;
-	GLfloat ambientIntensity = 0.2f;
-	GLfloat xDirection =  2.0f;   // + right
-	GLfloat yDirection = -1.0f;   // + up
-	GLfloat zDirection = -2.0f;   // + to camera/viewer
-	GLfloat diffuseIntensity = 0.1f;
-	Light mainLight = Light{ redChannel, greenChannel, blueChannel, ambientIntensity,
-							xDirection, yDirection, zDirection, diffuseIntensity };
+	Light mainLight = CreateMainLight();
 
 	GLuint uniformModel = 0;
 	GLuint uniformView = 0;
@@ -306,75 +758,807 @@ int main()
 
 	glm::mat4 projection = glm::perspective(fovY, aspectRatio, zNear, zFar); // Create a perspective projection matrix
 
+	std::vector<SceneObject> sceneObjects;
+	StressScene stressScene;
+	double stressGenerateTime = 0.0;
+
+	if (stress)
+	{
+		auto generateStart = std::chrono::steady_clock::now();
+		if (stressScene.Generate(stressConfig) != 0)
+		{
+			return 1;
+		}
+		stressGenerateTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generateStart).count();
+
+		for (const StressObject& object : stressScene.GetObjects())
+		{
+			sceneObjects.push_back(SceneObject{ stressScene.GetMesh(object.geometry), stressScene.GetTexture(object.texture),
+			                                    stressScene.GetMaterial(object.texture), stressScene.GetLight(object.light), object.model, 0,
+			                                    object.occluder });
+		}
+
+		printf("Stress scene: %u objects, %u geometries (%zu triangles, %zu instanced), %u textures, %u lights, seed %u, generated in %.1f ms\n",
+		       stressConfig.objects, stressConfig.geometries, stressScene.GetUniqueTriangleCount(), stressScene.GetInstancedTriangleCount(),
+		       stressConfig.textures, stressConfig.lights, stressConfig.seed, stressGenerateTime);
+	}
+	else
+	{
+		CreateObjects(); // Create triangle
+
+		// the two of them are the whole scene, either may hide the other
+		sceneObjects.push_back(SceneObject{ meshList[0], &brickTexture, &shinyMaterial, &mainLight, objectModels[0], 0, true });
+		sceneObjects.push_back(SceneObject{ meshList[1], &dirtTexture, &dullMaterial, &mainLight, objectModels[1], 0, true });
+	}
+
+	// objects are static, so world space bounds only need to be computed once
+	std::vector<BoundingSphere> sceneSpheres;
+	FrustumCuller culler;
+	culler.Reserve(sceneObjects.size());
+	for (const SceneObject& object : sceneObjects)
+	{
+		sceneSpheres.push_back(TransformSphere(object.mesh->GetBoundingSphere(), object.model));
+		culler.AddObject(sceneSpheres.back());
+	}
+
+	// world size of one unit at distance 1, in pixels
+	const float projectionScale = projection[1][1] * bufferHeight * 0.5f;
+
+	// BVH over the same objects for picking what the camera is looking at
+	std::vector<AABB> sceneBounds;
+	for (const SceneObject& object : sceneObjects)
+	{
+		sceneBounds.push_back(TransformAABB(object.mesh->GetAABB(), object.model));
+	}
+
+	BVH sceneBVH;
+	sceneBVH.Build(sceneBounds);
+
+	// every object is still tested against the designated occluders
+	OcclusionCuller occlusion;
+	size_t occluderCount = 0;
+	for (const SceneObject& object : sceneObjects)
+	{
+		if (object.occluder)
+		{
+			occlusion.AddOccluder(object.mesh, object.model, OCCLUDER_LOD);
+			occluderCount++;
+		}
+	}
+	if (stress)
+	{
+		printf("Occluders: %zu of %zu objects\n", occluderCount, sceneObjects.size());
+	}
+
+	// objects left after frustum and occlusion culling, reused every frame
+	std::vector<unsigned int> unoccluded;
+	unoccluded.reserve(sceneObjects.size());
+
+	// one per chunk of draws recorded on the job threads, as many as a frame can use, reused every frame
+	std::vector<CommandBuffer> drawCommands(GetJobThreadCount() * RECORD_CHUNKS_PER_THREAD);
+
+	const float pickDistance = zFar;
+	int pickedObject = -1;
+
 	const int first = 0;
 	const int count = 3;
 
-	const GLint MATRIX_COUNT = 1;
-	GLboolean TO_TRANSPOSE = GL_FALSE; // Whether to transpose matrix
+	RenderBackend& backend = GetRenderBackend();
+
+	int frameIndex = 0;
+	std::vector<double> frameTimes;
+	std::vector<unsigned char> framePixels;
+	frameTimes.reserve(headless ? headlessFrames : 0);
+
+	size_t statsFrames = 0;
+	GLFrameStats statsTotal{};
+
+	FrameTelemetry telemetry;
+	telemetry.Reserve(headless ? headlessFrames : 0);
+	auto previousFrameStart = std::chrono::steady_clock::now();
+	size_t previousNullDraws = 0;
+	bool exportKeyDown = false;
+
+	// per frame averages for the stress report
+	size_t totalDrawnObjects = 0;
+	size_t totalFullDetailTriangles = 0;
+	size_t totalRenderedTriangles = 0;
+	size_t totalOcclusionTested = 0;
+	size_t totalOcclusionOccluded = 0;
+
+	size_t pathStep = 0;
+	const size_t pathSteps = cameraPath.GetStepCount(HEADLESS_FRAME_TIME);
+	uint64_t simulatedFrames = 0;
+
+	// interactive movement advances at a fixed rate, the view is interpolated between the last two steps
+	const GLfloat simulationStep = 1.0f / simulationRate;
+	GLfloat simulationAccumulator = 0.0f;
+	glm::vec3 previousCameraPosition = camera.getCameraPosition();
+	size_t simulationSteps = 0;
+
+	// built from the window's event queue by whichever thread simulates; motion stays queued until a simulated
+	// frame takes it, so what the latched view turns by early still reaches the camera for good
+	InputState input;
+	const bool lateMouse = lateLatch.IsActive() && !headless && !playPathFile;
+
+	// a played back path or the headless frame count ends the run, a window runs until it is closed
+	auto simulationFinished = [&]() {
+		return playPathFile ? pathStep == pathSteps : headless && simulatedFrames == (uint64_t) headlessFrames;
+	};
 
-	// Loop until window closed
-	while (!mainWindow.getShouldClose())
-	{
-		currentTime = glfwGetTime(); // SDL_GetPerformanceCounter(); in SDL
-		deltaTime = currentTime - lastTime; // (now - lastTime) * 1000 / SDL_GetPerformanceFrequency(); in SDL
-		lastTime = currentTime;
+	// input, camera, culling, LOD and meshlet selection; nothing here touches GL, so it can run on its own thread
+	auto simulateFrame = [&](FramePacket& packet) {
+		auto simulationStart = std::chrono::steady_clock::now();
+		packet.Clear();
+		packet.frame = simulatedFrames++;
+		packet.inputTime = simulationStart;
+
+		// every event since the last frame, even where a played back path ignores them
+		GLfloat mouseX = 0.0f;
+		GLfloat mouseY = 0.0f;
+		if (!headless)
+		{
+			input.Drain(mainWindow.getInputEvents());
+			input.TakeMouseMotion(mouseX, mouseY);
+		}
+		bool* keys = input.GetKeys();
+		packet.takenMouseX = input.GetTakenMouseX();
+		packet.takenMouseY = input.GetTakenMouseY();
+
+		Camera viewCamera = camera;
+
+		if (playPathFile)
+		{
+			deltaTime = HEADLESS_FRAME_TIME;
+			cameraPath.ApplyStep(pathStep++, HEADLESS_FRAME_TIME, camera);
+			viewCamera = camera;
+		}
+		else if (headless)
+		{
+			deltaTime = HEADLESS_FRAME_TIME;
+
+			// a connected pad replaces the scripted turn, one step per frame
+			const GamepadState gamepadState = gamepadPoller.GetState();
+			if (gamepadState.connected)
+			{
+				ProcessGamepad(gamepadState, camera, HEADLESS_FRAME_TIME);
+				pathRecorder.RecordFrame(deltaTime, nullptr, 0.0f, 0.0f, camera);
+			}
+			else
+			{
+				camera.mouseControl(HEADLESS_TURN_PER_FRAME, 0.0f);
+				pathRecorder.RecordFrame(deltaTime, nullptr, HEADLESS_TURN_PER_FRAME, 0.0f, camera);
+			}
+			viewCamera = camera;
+		}
+		else
+		{
+			PROFILE_SCOPE("Input");
+
+			currentTime = glfwGetTime(); // SDL_GetPerformanceCounter(); in SDL
+			deltaTime = currentTime - lastTime; // (now - lastTime) * 1000 / SDL_GetPerformanceFrequency(); in SDL
+			lastTime = currentTime;
+
+			const GamepadState gamepadState = gamepadPoller.GetState();
+			const bool gamepad = gamepadState.connected;
+			packet.mouseLook = !gamepad;
+
+			// mouse look is applied once per frame as it arrives, stepping or interpolating it would only delay it
+			if (!gamepad)
+			{
+				camera.mouseControl(mouseX, mouseY);
+			}
 
-		// Get and handle user input events
-		glfwPollEvents(); // Poll events from user & process them
+			// movement runs in fixed steps so it behaves the same at any frame rate; after a stall the
+			// backlog is dropped rather than simulated all at once
+			simulationAccumulator = std::min(simulationAccumulator + deltaTime, MAX_STEPS_PER_FRAME * simulationStep);
+			while (simulationAccumulator >= simulationStep)
+			{
+				previousCameraPosition = camera.getCameraPosition();
+				if (gamepad)
+				{
+					ProcessGamepad(gamepadState, camera, simulationStep);
+				}
+				else
+				{
+					camera.keyControl(keys, simulationStep);
+				}
+				simulationAccumulator -= simulationStep;
+				simulationSteps++;
+			}
+
+			pathRecorder.RecordFrame(deltaTime, gamepad ? nullptr : keys, gamepad ? 0.0f : mouseX, gamepad ? 0.0f : mouseY, camera);
+
+			// the view sits between the last two steps by the time left over, smooth even when steps and frames do not line up
+			float blend = simulationAccumulator / simulationStep;
+			viewCamera.setState(glm::mix(previousCameraPosition, camera.getCameraPosition(), blend), camera.getYaw(), camera.getPitch());
+		}
+
+		packet.view = viewCamera.calculateViewMatrix();
+		packet.projection = projection;
+		packet.eyePosition = viewCamera.getCameraPosition();
+		packet.viewCamera = viewCamera;
 
-		if (std::tolower(inputDevice) == 'x')
+		Frustum viewFrustum = viewCamera.calculateFrustum(projection);
 		{
-			ProcessXInput(camera, deltaTime);
+			PROFILE_SCOPE("Culling");
+			culler.Cull(viewFrustum);
+		}
+
+		// timed on its own, rasterizing the occluders can cost more than the rest of the simulation
+		unoccluded.clear();
+		if (occluderCount > 0)
+		{
+			PROFILE_SCOPE("Occlusion");
+			auto occlusionStart = std::chrono::steady_clock::now();
+
+			occlusion.RenderOccluders(projection * packet.view);
+			for (unsigned int objectIndex : culler.GetVisible())
+			{
+				if (occlusion.TestAABB(sceneBounds[objectIndex]))
+				{
+					unoccluded.push_back(objectIndex);
+				}
+			}
+
+			packet.occlusionTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - occlusionStart).count();
+			packet.occlusionTested = occlusion.GetTestedCount();
+			packet.occlusionOccluded = occlusion.GetOccludedCount();
 		}
 		else
 		{
-			camera.keyControl(mainWindow.getKeyStates(), deltaTime);
-			camera.mouseControl(mainWindow.getXChange(), mainWindow.getYChange());
+			unoccluded.assign(culler.GetVisible().begin(), culler.GetVisible().end());
+		}
+
+		for (unsigned int objectIndex : unoccluded)
+		{
+			SceneObject& object = sceneObjects[objectIndex];
+			const BoundingSphere& sphere = sceneSpheres[objectIndex];
+
+			float distance = glm::max(glm::length(sphere.center - packet.eyePosition) - sphere.radius, zNear);
+			float worldScale = object.mesh->GetBoundingSphere().radius > 0.0f ? sphere.radius / object.mesh->GetBoundingSphere().radius : 1.0f;
+			object.lod = object.mesh->SelectLOD(distance, worldScale, projectionScale, object.lod);
+
+			packet.fullDetailTriangles += object.mesh->GetIndexCount(0) / TRIANGLE_VERTEX_COUNT;
+
+			PacketDraw draw{ object.mesh, object.texture, object.material, object.light, object.model, object.lod, packet.meshletRanges.size(), 0 };
+
+			// full detail objects are refined further per meshlet, coarser LODs are cheap enough to draw whole
+			if (object.lod == 0 && object.mesh->HasMeshlets())
+			{
+				PROFILE_SCOPE("Meshlet culling");
+
+				object.mesh->CullMeshlets(object.model, viewFrustum, packet.eyePosition, packet.meshletRanges);
+				draw.rangeCount = packet.meshletRanges.size() - draw.firstRange;
+
+				for (size_t range = draw.firstRange; range < packet.meshletRanges.size(); range++)
+				{
+					packet.renderedTriangles += packet.meshletRanges[range].indexCount / TRIANGLE_VERTEX_COUNT;
+				}
+			}
+			else
+			{
+				packet.renderedTriangles += object.mesh->GetIndexCount(object.lod) / TRIANGLE_VERTEX_COUNT;
+			}
+
+			packet.draws.push_back(draw);
+		}
+
+		if (verbose)
+		{
+			printf("Visible: %zu Culled: %zu Occluded: %.1f%%\n", culler.GetVisibleCount(), culler.GetCulledCount(), occlusion.GetCulledPercentage());
+			printf("Triangles: %u full detail, %u after LOD and meshlet culling\n", packet.fullDetailTriangles, packet.renderedTriangles);
+		}
+
+		{
+			PROFILE_SCOPE("Picking");
+			float pickHitDistance = 0.0f;
+			int lookedAtObject = sceneBVH.Raycast(Ray{ packet.eyePosition, viewCamera.getFront() }, pickDistance, &pickHitDistance);
+			if (lookedAtObject != pickedObject)
+			{
+				pickedObject = lookedAtObject;
+				if (verbose && pickedObject >= 0)
+				{
+					printf("Looking at object %d (%.2f units away)\n", pickedObject, pickHitDistance);
+				}
+			}
 		}
 
-		// Clear window
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f); // Set clear color to red
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		packet.simTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - simulationStart).count();
+	};
+
+	// GL submission of one packet plus the per frame bookkeeping; frameStart is where the frame's interval starts,
+	// renderStart where this thread's work on it starts, the same point unless the simulation runs on its own thread
+	auto renderFrame = [&](const FramePacket& packet, std::chrono::steady_clock::time_point frameStart, std::chrono::steady_clock::time_point renderStart) {
+		GPUProfilerBeginFrame();
+
+		{
+			PROFILE_SCOPE("Frame setup");
+			PROFILE_GPU_SCOPE("Frame setup");
+
+			// Clear window
+			backend.Clear(glm::vec4{ 0.0f, 0.0f, 0.0f, 1.0f }); // Set clear color to black
+
+			shaderList[0]->UseShader();
+			uniformModel = shaderList[0]->GetModelLocation();
+			uniformView = shaderList[0]->GetViewLocation();
+			uniformProjection = shaderList[0]->GetProjectionLocation();
+			uniformAmbientColor = shaderList[0]->GetAmbientColorLocation();
+			uniformAmbientIntensity = shaderList[0]->GetAmbientIntensityLocation();
+			uniformDiffuseIntensity = shaderList[0]->GetDiffuseIntensityLocation();
+			uniformDirection = shaderList[0]->GetDirectionLocation();
+			uniformEyePosition = shaderList[0]->GetEyePosition();
+			uniformShininess = shaderList[0]->GetShininessLocation();
+			uniformSpecularIntensity = shaderList[0]->GetSpecularIntensityLocation();
+
+			mainLight.UseLight(uniformAmbientIntensity, uniformAmbientColor, uniformDiffuseIntensity, uniformDirection);
+
+			if (!lateLatch.IsActive())
+			{
+				backend.SetUniform(uniformView, packet.view);
+			}
+			backend.SetUniform(uniformProjection, packet.projection);
+			backend.SetUniform(uniformEyePosition, packet.eyePosition);
+		}
+
+		// low latency mode: input is sampled once more right before the draws go out, turning the packet's
+		// camera by the mouse motion no simulated frame has taken yet; culling keeps the simulated view
+		auto inputTime = packet.inputTime;
+		auto latchView = [&]() {
+			if (!lateLatch.IsActive())
+			{
+				return;
+			}
+
+			PROFILE_SCOPE("Late latch");
+
+			glm::mat4 view = packet.view;
+			if (lateMouse && packet.mouseLook)
+			{
+				glfwPollEvents();
+				inputTime = std::chrono::steady_clock::now();
+
+				Camera latchedCamera = packet.viewCamera;
+				latchedCamera.mouseControl((GLfloat) (mainWindow.getTotalMouseX() - packet.takenMouseX),
+				                           (GLfloat) (mainWindow.getTotalMouseY() - packet.takenMouseY));
+				view = latchedCamera.calculateViewMatrix();
+			}
+			lateLatch.LatchView(view, inputTime);
+		};
+
+		// issues the draws of [begin, end) through the calling thread's backend, starting from the light the draw
+		// before begin leaves bound, so any split of the draws produces the same calls as one pass
+		auto issueDraws = [&](size_t begin, size_t end) {
+			RenderBackend& drawBackend = GetRenderBackend();
+			const Light* boundLight = begin > 0 ? packet.draws[begin - 1].light : &mainLight;
 
-		shaderList[0]->UseShader();
-		uniformModel = shaderList[0]->GetModelLocation();
-		uniformView = shaderList[0]->GetViewLocation();
-		uniformProjection = shaderList[0]->GetProjectionLocation();
-		uniformAmbientColor = shaderList[0]->GetAmbientColorLocation();
-		uniformAmbientIntensity = shaderList[0]->GetAmbientIntensityLocation();
-		uniformDiffuseIntensity = shaderList[0]->GetDiffuseIntensityLocation();
-		uniformDirection = shaderList[0]->GetDirectionLocation();
-		uniformEyePosition = shaderList[0]->GetEyePosition();
-		uniformShininess = shaderList[0]->GetShininessLocation();
-		uniformSpecularIntensity = shaderList[0]->GetSpecularIntensityLocation();
+			for (size_t i = begin; i < end; i++)
+			{
+				PROFILE_SCOPE("Draw object");
+
+				const PacketDraw& draw = packet.draws[i];
+
+				// objects of one light are not grouped, so a scene with many lights switches them often
+				if (draw.light != boundLight)
+				{
+					draw.light->UseLight(uniformAmbientIntensity, uniformAmbientColor, uniformDiffuseIntensity, uniformDirection);
+					boundLight = draw.light;
+				}
+
+				drawBackend.SetUniform(uniformModel, draw.model);
+				draw.texture->UseTexture();
+				draw.material->UseMaterial(uniformSpecularIntensity, uniformShininess); // TODO: implemented object oriented function for this
+
+				if (draw.lod == 0 && draw.mesh->HasMeshlets())
+				{
+					draw.mesh->RenderRanges(packet.meshletRanges.data() + draw.firstRange, draw.rangeCount);
+				}
+				else
+				{
+					draw.mesh->RenderMesh(draw.lod);
+				}
+			}
+		};
+
+		{
+			PROFILE_GPU_SCOPE("Draw objects");
+
+			// with helpers and enough draws, chunks of them are recorded into command buffers on the job threads
+			// and only the in-order replay needs the context
+			size_t chunkCount = std::min<size_t>(GetJobThreadCount() * RECORD_CHUNKS_PER_THREAD, packet.draws.size() / MIN_DRAWS_PER_CHUNK);
+			if (GetJobThreadCount() > 1 && chunkCount > 1)
+			{
+				{
+					PROFILE_SCOPE("Record draws");
+					ParallelFor(chunkCount, [&](size_t chunkBegin, size_t chunkEnd) {
+						for (size_t chunk = chunkBegin; chunk < chunkEnd; chunk++)
+						{
+							drawCommands[chunk].Reset();
+							SetThreadRenderBackend(&drawCommands[chunk]);
+							issueDraws(packet.draws.size() * chunk / chunkCount, packet.draws.size() * (chunk + 1) / chunkCount);
+							SetThreadRenderBackend(nullptr);
+						}
+					}, 1);
+				}
+
+				latchView();
+
+				PROFILE_SCOPE("Replay draws");
+				for (size_t chunk = 0; chunk < chunkCount; chunk++)
+				{
+					drawCommands[chunk].Replay(backend);
+				}
+			}
+			else
+			{
+				latchView();
+				issueDraws(0, packet.draws.size());
+			}
+		}
 
-		printf("" + (int)uniformDiffuseIntensity);
-		printf("" + (int)uniformDirection);
+		totalDrawnObjects += packet.draws.size();
+		totalFullDetailTriangles += packet.fullDetailTriangles;
+		totalRenderedTriangles += packet.renderedTriangles;
+		totalOcclusionTested += packet.occlusionTested;
+		totalOcclusionOccluded += packet.occlusionOccluded;
 
-		mainLight.UseLight(uniformAmbientIntensity, uniformAmbientColor, uniformDiffuseIntensity, uniformDirection);
+		backend.UseProgram(0);
 
-		glUniformMatrix4fv(uniformView, MATRIX_COUNT, TO_TRANSPOSE, glm::value_ptr(camera.calculateViewMatrix()));
-		glUniformMatrix4fv(uniformProjection, MATRIX_COUNT, TO_TRANSPOSE, glm::value_ptr(projection));
-		glUniform3f(uniformEyePosition, camera.getCameraPosition().x, camera.getCameraPosition().y, camera.getCameraPosition().z);
+		GPUProfilerEndFrame();
 
-		glm::mat4 model{ 1.0f }; // Create identity matrix by default
+		if (IsGLInterceptorInstalled())
+		{
+			EndGLFrame();
 
-		model = glm::translate(model, glm::vec3{ 0.0f, 0.0f, -2.5f });
-		glUniformMatrix4fv(uniformModel, MATRIX_COUNT, TO_TRANSPOSE, glm::value_ptr(model));
-		brickTexture.UseTexture();
-		shinyMaterial.UseMaterial(uniformSpecularIntensity, uniformShininess); // TODO: implemented object oriented function for this
-		meshList[0]->RenderMesh(); // Render the triangle
+			const GLFrameStats& stats = GetLastGLFrameStats();
+			statsTotal.calls += stats.calls;
+			statsTotal.draws += stats.draws;
+			statsTotal.triangles += stats.triangles;
+			statsTotal.bufferBytes += stats.bufferBytes;
+			statsTotal.textureBytes += stats.textureBytes;
+			statsTotal.redundantBinds += stats.redundantBinds;
+			statsFrames++;
 
-		model = glm::mat4(1.0f);   // Reset to identity matrix
-		model = glm::translate(model, glm::vec3{ 0.0f, 4.0f, -2.5f });
-		glUniformMatrix4fv(uniformModel, MATRIX_COUNT, TO_TRANSPOSE, glm::value_ptr(model));
-		dirtTexture.UseTexture();
-		dullMaterial.UseMaterial(uniformSpecularIntensity, uniformShininess);
-		meshList[1]->RenderMesh(); // Render the triangle
+			if (verbose)
+			{
+				printf("GL: %zu calls, %zu draws, %zu triangles, %zu redundant binds, %zu buffer bytes, %zu texture bytes\n", stats.calls,
+				       stats.draws, stats.triangles, stats.redundantBinds, stats.bufferBytes, stats.textureBytes);
+			}
+		}
 
-		glUseProgram(0);
+		FrameSample sample{};
+		if (collectTelemetry)
+		{
+			sample.cpuTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderStart).count();
+			sample.gpuTime = GetLastGPUFrameTime();
+			sample.simTime = packet.simTime;
+			sample.occlusionTime = packet.occlusionTime;
+			if (telemetry.getFrameCount() > 0)
+			{
+				sample.frameInterval = std::chrono::duration<double, std::milli>(frameStart - previousFrameStart).count();
+			}
 
-		mainWindow.swapBuffers(); // Swap the front and back buffers
+			if (IsGLInterceptorInstalled())
+			{
+				sample.draws = GetLastGLFrameStats().draws;
+				sample.uploadBytes = GetLastGLFrameStats().bufferBytes + GetLastGLFrameStats().textureBytes;
+			}
+			else if (nullBackend)
+			{
+				sample.draws = nullRenderBackend.GetDrawCount() - previousNullDraws;
+				previousNullDraws = nullRenderBackend.GetDrawCount();
+			}
+		}
+
+		if (headless)
+		{
+			// wait for the GPU so frame times include rendering and not just command submission
+			if (!nullBackend)
+			{
+				PROFILE_SCOPE("glFinish");
+				glFinish();
+			}
+			frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+		}
+		else
+		{
+			PROFILE_SCOPE("Swap buffers");
+			mainWindow.swapBuffers(); // Swap the front and back buffers
+		}
+
+		lateLatch.EndFrame();
+
+		// the frame is as done as this thread can tell, which is where the input it shows stops aging
+		if (collectTelemetry)
+		{
+			sample.latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inputTime).count();
+			sample.photonLatency = lateLatch.GetLastPhotonLatency();
+			telemetry.AddFrame(sample);
+			previousFrameStart = frameStart;
+
+			// F12 writes what has been recorded so far, the file is rewritten on exit
+			bool exportKey = !headless && mainWindow.getKeyStates()[GLFW_KEY_F12];
+			if (exportKey && !exportKeyDown && telemetryFile)
+			{
+				telemetry.Export(telemetryFile);
+			}
+			exportKeyDown = exportKey;
+		}
+
+		if (headless)
+		{
+			if (dumpDirectory)
+			{
+				offscreenTarget.ReadPixels(framePixels);
+				DumpFrame(dumpDirectory, frameIndex, bufferWidth, bufferHeight, framePixels);
+			}
+
+			frameIndex++;
+		}
+
+		PROFILE_FRAME_END();
+	};
+
+	if (!headless)
+	{
+		lastTime = glfwGetTime(); // the first frame's movement starts now, not when GLFW was initialized
+	}
+
+	// room for every object drawn with all of its meshlets, so no packet, frame arena or command buffer grows while frames run
+	FramePacketBuffer packetBuffer;
+	size_t sceneMeshlets = 0;
+	size_t sceneScratch = 0;
+	size_t maxObjectMeshlets = 0;
+	for (const SceneObject& object : sceneObjects)
+	{
+		sceneMeshlets += object.mesh->GetMeshletCount();
+		sceneScratch += object.mesh->GetScratchSize();
+		maxObjectMeshlets = std::max(maxObjectMeshlets, object.mesh->GetMeshletCount());
+	}
+	packetBuffer.Reserve(sceneObjects.size(), sceneMeshlets);
+
+	// a pipelined simulation can start the next frame before the renderer moves the arenas on, so it may fill
+	// one arena with two frames; one block's end can go unused when an allocation does not fit in it
+	FrameArenaReserve((pipelined ? 2 : 1) * sceneScratch + FrameArena::BLOCK_SIZE);
+
+	// a chunk has fewer than twice the minimum draws until every chunk is in use, then an even share of them
+	if (!drawCommands.empty())
+	{
+		size_t chunkDraws = std::max(2 * MIN_DRAWS_PER_CHUNK, (sceneObjects.size() + drawCommands.size() - 1) / drawCommands.size());
+		size_t drawSize = MAX_COMMANDS_PER_DRAW * CommandBuffer::GetMaxCommandSize() + CommandBuffer::GetRangesCommandSize(maxObjectMeshlets);
+		for (CommandBuffer& commands : drawCommands)
+		{
+			commands.Reserve(chunkDraws * drawSize);
+		}
+	}
+
+	// every rendered frame after the warm-up is a zero allocation scope; the totals also cover the gaps between
+	// frames, where the pipelined simulation may already be working on the next one
+	ZeroAllocationScope frameAllocations("Frame");
+	AllocationCounts checkStart{};
+	auto beginAllocationCheck = [&]() {
+		if (allocationCheckWarmup < 0 || frameIndex < allocationCheckWarmup)
+		{
+			return;
+		}
+		if (frameIndex == allocationCheckWarmup)
+		{
+			checkStart = GetTotalAllocationCounts();
+		}
+		frameAllocations.Begin(allocationStacks);
+	};
+	auto endAllocationCheck = [&]() {
+		if (frameAllocations.IsOpen())
+		{
+			frameAllocations.End();
+		}
+	};
+
+	if (pipelined)
+	{
+		// one packet in flight: the next frame is simulated while the renderer draws the current one
+		std::thread simulationThread([&]() {
+			PROFILE_THREAD_NAME("Simulation");
+
+			while (!simulationFinished())
+			{
+				// the limiter holds back the producer, limiting the renderer instead would leave a finished packet aging
+				framePacer.Wait();
+
+				// input events are drained from the queue the window thread fills while polling
+				simulateFrame(packetBuffer.GetWritePacket());
+				packetBuffer.Publish();
+
+				if (!packetBuffer.WaitUntilConsumed())
+				{
+					break;
+				}
+			}
+			packetBuffer.Close();
+		});
+
+		while (headless || !mainWindow.getShouldClose())
+		{
+			FrameArenaNextFrame(); // both threads' scratch follows the rendered frames, the simulation is at most one ahead
+			lateLatch.BeginFrame();
+			auto frameStart = std::chrono::steady_clock::now();
+
+			if (!headless)
+			{
+				glfwPollEvents();
+				gamepadPoller.PollOnMainThread();
+			}
+
+			const FramePacket* packet = nullptr;
+			{
+				PROFILE_SCOPE("Wait for simulation");
+				packet = packetBuffer.WaitForPacket();
+			}
+			if (!packet)
+			{
+				break;
+			}
+
+			beginAllocationCheck();
+			renderFrame(*packet, frameStart, std::chrono::steady_clock::now());
+			endAllocationCheck();
+		}
+
+		packetBuffer.Close();
+		simulationThread.join();
+	}
+	else
+	{
+		FramePacket& packet = packetBuffer.GetWritePacket();
+
+		// Loop until window closed
+		while ((headless || !mainWindow.getShouldClose()) && !simulationFinished())
+		{
+			// before input is sampled, so the wait does not age the input this frame shows
+			framePacer.Wait();
+			FrameArenaNextFrame();
+			lateLatch.BeginFrame(); // likewise, and the GPU queue is short enough for the input not to age in it
+			auto frameStart = std::chrono::steady_clock::now();
+
+			if (!headless)
+			{
+				// Get and handle user input events
+				glfwPollEvents(); // Poll events from user & process them, played back paths ignore them
+				gamepadPoller.PollOnMainThread();
+			}
+
+			beginAllocationCheck();
+			simulateFrame(packet);
+			renderFrame(packet, frameStart, frameStart);
+			endAllocationCheck();
+		}
+	}
+	AllocationCounts checkEnd = GetTotalAllocationCounts(); // before the reports below allocate
+
+	// headless runs have no other way to show the mock pad reached the camera
+	bool gamepadCheckFailed = false;
+	if (headless && mockGamepadInput && !playPathFile)
+	{
+		float moved = glm::length(camera.getCameraPosition() - startPosition);
+		float turned = camera.getYaw() - startYaw;
+		printf("Mock gamepad: camera moved %.2f units and turned %.1f degrees\n", moved, turned);
+		gamepadCheckFailed = moved == 0.0f || turned == 0.0f;
+	}
+
+	if (headless)
+	{
+		PrintFrameTimes(frameTimes);
+		if (!frameTimes.empty())
+		{
+			printf("Triangles: %.0f full detail, %.0f after LOD and meshlet culling per frame\n",
+			       (double) totalFullDetailTriangles / frameTimes.size(), (double) totalRenderedTriangles / frameTimes.size());
+		}
+		if (occluderCount > 0 && !frameTimes.empty())
+		{
+			printf("Occlusion: %.1f%% of tested objects occluded, %.1f of %.1f per frame\n",
+			       totalOcclusionTested > 0 ? 100.0 * totalOcclusionOccluded / totalOcclusionTested : 0.0,
+			       (double) totalOcclusionOccluded / frameTimes.size(), (double) totalOcclusionTested / frameTimes.size());
+		}
+	}
+	else if (simulatedFrames > 0 && !playPathFile)
+	{
+		printf("Movement: %zu steps at %.0f Hz over %llu frames (%.2f per frame)\n", simulationSteps, simulationRate,
+		       (unsigned long long) simulatedFrames, (double) simulationSteps / simulatedFrames);
+		if (mainWindow.getInputEvents().GetDroppedCount() > 0)
+		{
+			printf("Input: %zu of %zu events dropped, the queue was full\n", mainWindow.getInputEvents().GetDroppedCount(),
+			       input.GetEventCount() + mainWindow.getInputEvents().GetDroppedCount());
+		}
+	}
+	bool allocationCheckFailed = false;
+	if (allocationCheckWarmup >= 0)
+	{
+		uint64_t allocations = checkEnd.allocations - checkStart.allocations;
+		int checkedFrames = frameIndex - allocationCheckWarmup;
+		allocationCheckFailed = allocations > 0;
+
+		if (allocationCheckFailed)
+		{
+			printf("Allocation check failed: %llu heap allocations, %.1f KB, in %zu of %d frames after %d warm-up frames\n",
+			       (unsigned long long) allocations, (checkEnd.bytes - checkStart.bytes) / 1024.0, frameAllocations.GetFailedCount(),
+			       checkedFrames, allocationCheckWarmup);
+			PrintCapturedAllocationStacks();
+		}
+		else
+		{
+			printf("Allocation check passed: no heap allocations in %d frames after %d warm-up frames\n", checkedFrames, allocationCheckWarmup);
+		}
+		PrintAllocationCounts();
+	}
+
+	framePacer.PrintSummary();
+	lateLatch.PrintSummary();
+	PrintFrameArenaStats();
+	lateLatch.Shutdown();
+
+	StopGLTrace();
+	pathRecorder.Stop();
+
+	if (telemetryFile)
+	{
+		telemetry.PrintSummary();
+		telemetry.Export(telemetryFile);
+	}
+
+	if (stress)
+	{
+		size_t frames = frameTimes.empty() ? 1 : frameTimes.size();
+		StressRunInfo run{};
+		run.backend = nullBackend ? "null" : "gl";
+		run.pipelined = pipelined;
+		run.cameraPath = playPathFile;
+		run.width = bufferWidth;
+		run.height = bufferHeight;
+		run.generateTime = stressGenerateTime;
+		run.drawnObjects = (double) totalDrawnObjects / frames;
+		run.fullDetailTriangles = (double) totalFullDetailTriangles / frames;
+		run.renderedTriangles = (double) totalRenderedTriangles / frames;
+		run.occluders = occluderCount;
+		run.occlusionTested = (double) totalOcclusionTested / frames;
+		run.occlusionOccluded = (double) totalOcclusionOccluded / frames;
+
+		if (WriteStressReport(stressReportFile, stressScene, run, frameTimes, telemetry) != 0)
+		{
+			return 1;
+		}
+	}
+
+	if (gpuTimes && IsGPUProfilerActive())
+	{
+		PrintGPUTimes();
+	}
+	GPUProfilerShutdown();
+	ProfilerFinishCapture();
+
+	if (glStats && statsFrames > 0)
+	{
+		// the first frame also carries every upload made while loading the scene
+		double frames = (double) statsFrames;
+		PrintGLCallCounts(statsFrames);
+		printf("GL per frame: %.1f calls, %.1f draws, %.1f triangles, %.1f redundant binds, %.1f buffer bytes, %.1f texture bytes\n",
+		       statsTotal.calls / frames, statsTotal.draws / frames, statsTotal.triangles / frames, statsTotal.redundantBinds / frames,
+		       statsTotal.bufferBytes / frames, statsTotal.textureBytes / frames);
+	}
+
+	if (nullBackend)
+	{
+		printf("Null backend: %zu calls, %zu draws, %zu triangles, %zu errors\n", nullRenderBackend.GetCallCount(),
+		       nullRenderBackend.GetDrawCount(), nullRenderBackend.GetTriangleCount(), nullRenderBackend.GetErrorCount());
+
+		if (nullRenderBackend.GetErrorCount() > 0)
+		{
+			return 1;
+		}
+	}
+
+	if (allocationCheckFailed || gamepadCheckFailed)
+	{
+		return 1;
 	}
 
 	// Cleanup